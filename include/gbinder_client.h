@@ -42,6 +42,11 @@ typedef struct gbinder_client_iface_info {
     guint32 last_code;
 } GBinderClientIfaceInfo;
 
+struct gbinder_client_oneway_tx {
+    guint32 code;
+    GBinderLocalRequest* req;
+}; /* since 1.1.43 */
+
 typedef
 void
 (*GBinderClientReplyFunc)(
@@ -105,6 +110,18 @@ gbinder_client_transact_sync_oneway(
     guint32 code,
     GBinderLocalRequest* req);
 
+/*
+ * Sends a number of one-way transactions with as few system calls as
+ * possible. Returns the status of the first failed transaction (the
+ * ones following it are not sent) or GBINDER_STATUS_OK if all of them
+ * have been sent. NULL requests are replaced with empty ones.
+ */
+int
+gbinder_client_transact_oneway_batch(
+    GBinderClient* client,
+    const GBinderClientOnewayTx* txs,
+    guint count); /* since 1.1.43 */
+
 gulong
 gbinder_client_transact(
     GBinderClient* client,
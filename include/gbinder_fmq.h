@@ -45,7 +45,9 @@ typedef enum gbinder_fmq_type {
 
 typedef enum gbinder_fmq_flags {
     GBINDER_FMQ_FLAG_CONFIGURE_EVENT_FLAG = 0x1,
-    GBINDER_FMQ_FLAG_NO_RESET_POINTERS    = 0x2
+    GBINDER_FMQ_FLAG_NO_RESET_POINTERS    = 0x2,
+    GBINDER_FMQ_FLAG_CACHE_LINE_ALIGN     = 0x4, /* Since 1.1.43 */
+    GBINDER_FMQ_FLAG_SPIN_WAIT            = 0x8  /* Since 1.1.43 */
 } GBINDER_FMQ_FLAGS;
 
 GBinderFmq*
@@ -119,6 +121,114 @@ gbinder_fmq_write(
     const void* data,
     gsize items);
 
+/*
+ * Zero copy transactions (since 1.1.43)
+ *
+ * The items being read or written may wrap around the end of the ring
+ * buffer, in which case they are split between two regions. The second
+ * region is empty (NULL data and zero items) if there's no wrap-around.
+ * Transactions are committed with gbinder_fmq_end_read() and
+ * gbinder_fmq_end_write() with the same number of items.
+ */
+typedef struct gbinder_fmq_region {
+    void* data;
+    gsize items;
+} GBinderFmqRegion;
+
+typedef struct gbinder_fmq_tx {
+    GBinderFmqRegion first;
+    GBinderFmqRegion second;
+} GBinderFmqTx;
+
+gboolean
+gbinder_fmq_begin_read_tx(
+    GBinderFmq* fmq,
+    gsize items,
+    GBinderFmqTx* tx); /* Since 1.1.43 */
+
+gboolean
+gbinder_fmq_begin_write_tx(
+    GBinderFmq* fmq,
+    gsize items,
+    GBinderFmqTx* tx); /* Since 1.1.43 */
+
+/*
+ * Vectored read/write. The total size of all buffers must be a multiple
+ * of the item size. All or nothing gets transferred.
+ */
+struct iovec;
+
+gboolean
+gbinder_fmq_readv(
+    GBinderFmq* fmq,
+    const struct iovec* iov,
+    guint count); /* Since 1.1.43 */
+
+gboolean
+gbinder_fmq_writev(
+    GBinderFmq* fmq,
+    const struct iovec* iov,
+    guint count); /* Since 1.1.43 */
+
+/*
+ * Overrun accounting (since 1.1.43)
+ *
+ * Writer of an unsynchronized queue never waits for the reader. If it
+ * laps the reader, the unread data are lost and the reader skips to the
+ * current write position. Such reads (and vectored reads) fail and the
+ * loss gets counted.
+ */
+typedef struct gbinder_fmq_overruns {
+    guint64 lost;       /* Number of items lost */
+    guint resyncs;      /* How many times the reader had to skip ahead */
+} GBinderFmqOverruns;
+
+void
+gbinder_fmq_get_overruns(
+    GBinderFmq* fmq,
+    GBinderFmqOverruns* overruns); /* Since 1.1.43 */
+
+/*
+ * Additional readers of an unsynchronized queue (since 1.1.43)
+ *
+ * Each reader has its own read position and overrun counters, and only
+ * sees the data written after it has been created. The reader keeps
+ * a reference to the queue.
+ */
+GBinderFmqReader*
+gbinder_fmq_reader_new(
+    GBinderFmq* fmq); /* Since 1.1.43 */
+
+void
+gbinder_fmq_reader_free(
+    GBinderFmqReader* reader); /* Since 1.1.43 */
+
+gsize
+gbinder_fmq_reader_available(
+    GBinderFmqReader* reader); /* Since 1.1.43 */
+
+gboolean
+gbinder_fmq_reader_begin_tx(
+    GBinderFmqReader* reader,
+    gsize items,
+    GBinderFmqTx* tx); /* Since 1.1.43 */
+
+gboolean
+gbinder_fmq_reader_end_read(
+    GBinderFmqReader* reader,
+    gsize items); /* Since 1.1.43 */
+
+gboolean
+gbinder_fmq_reader_read(
+    GBinderFmqReader* reader,
+    void* data,
+    gsize items); /* Since 1.1.43 */
+
+void
+gbinder_fmq_reader_get_overruns(
+    GBinderFmqReader* reader,
+    GBinderFmqOverruns* overruns); /* Since 1.1.43 */
+
 /*
  * Functions for waiting and waking message queue.
  * Requires configured event flag in message queue.
@@ -141,6 +251,35 @@ gbinder_fmq_wake(
     GBinderFmq* fmq,
     guint32 bit_mask);
 
+/*
+ * Blocking read/write (since 1.1.43), similar to readBlocking() and
+ * writeBlocking() in Android. Both require a synchronized queue with
+ * the event flag. The reader waits for write_notification and sets
+ * read_notification after reading, the writer does the opposite.
+ * Negative timeout means no timeout. With GBINDER_FMQ_FLAG_SPIN_WAIT
+ * the queue is polled for a short while before going to sleep.
+ */
+#define GBINDER_FMQ_NOT_EMPTY (0x1) /* Default write notification */
+#define GBINDER_FMQ_NOT_FULL  (0x2) /* Default read notification */
+
+gboolean
+gbinder_fmq_read_blocking(
+    GBinderFmq* fmq,
+    void* data,
+    gsize items,
+    guint32 read_notification,
+    guint32 write_notification,
+    int timeout_ms); /* Since 1.1.43 */
+
+gboolean
+gbinder_fmq_write_blocking(
+    GBinderFmq* fmq,
+    const void* data,
+    gsize items,
+    guint32 read_notification,
+    guint32 write_notification,
+    int timeout_ms); /* Since 1.1.43 */
+
 G_END_DECLS
 
 #endif /* GBINDER_FMQ_H */
@@ -45,6 +45,26 @@ gbinder_local_object_new(
     void* user_data) /* Since 1.0.30 */
     G_GNUC_WARN_UNUSED_RESULT;
 
+/*
+ * The handler of a concurrent object is invoked directly on the binder
+ * looper threads, possibly on several of them at once, rather than on
+ * the main thread. It must be thread-safe and must not block for long.
+ * gbinder_local_object_drop() doesn't wait for the calls in progress,
+ * it may even be called by the handler itself. No new calls are made
+ * after it returns, but the ones already in progress on the other
+ * threads may still be running. The destroy callback is invoked when
+ * the last of them has completed (or when the object is finalized, if
+ * it has never been dropped), that's when user_data can be released.
+ */
+GBinderLocalObject*
+gbinder_local_object_new_concurrent(
+    GBinderIpc* ipc,
+    const char* const* ifaces,
+    GBinderLocalTransactFunc handler,
+    void* user_data,
+    GDestroyNotify destroy) /* Since 1.1.43 */
+    G_GNUC_WARN_UNUSED_RESULT;
+
 GBinderLocalObject*
 gbinder_local_object_ref(
     GBinderLocalObject* obj);
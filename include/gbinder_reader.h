@@ -230,6 +230,17 @@ gboolean
 gbinder_reader_skip_string16(
     GBinderReader* reader);
 
+/*
+ * Compares UTF-16 string returned by gbinder_reader_read_string16_utf16()
+ * or gbinder_reader_read_nullable_string16_utf16() with a UTF-8 string,
+ * without converting either of them.
+ */
+gboolean
+gbinder_reader_string16_equal(
+    const gunichar2* str,
+    gsize len,
+    const char* utf8); /* Since 1.1.43 */
+
 const void*
 gbinder_reader_read_byte_array(
     GBinderReader* reader,
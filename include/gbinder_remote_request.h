@@ -37,6 +37,12 @@
 
 G_BEGIN_DECLS
 
+/*
+ * If the incoming AIDL request is addressed to an interface implemented
+ * by a local object of this process, its name is interned, i.e. it can
+ * be compared with the result of g_intern_static_string() by pointer.
+ * Any other interface name must be compared with strcmp().
+ */
 const char*
 gbinder_remote_request_interface(
     GBinderRemoteRequest* req);
@@ -60,6 +60,21 @@ void
     int status,
     void* user_data);
 
+/*
+ * GBinderServiceManagerGetServicesFunc receives the objects in the same
+ * order as the names were passed to gbinder_servicemanager_get_services(),
+ * NULL for the names which couldn't be resolved. The objects are unrefed
+ * after the callback returns.
+ */
+typedef
+void
+(*GBinderServiceManagerGetServicesFunc)(
+    GBinderServiceManager* sm,
+    const char* const* names,
+    GBinderRemoteObject* const* objects,
+    guint count,
+    void* user_data); /* Since 1.1.43 */
+
 typedef
 void
 (*GBinderServiceManagerAddServiceFunc)(
@@ -67,6 +82,13 @@ void
     int status,
     void* user_data);
 
+typedef
+void
+(*GBinderServiceManagerWaitFunc)(
+    GBinderServiceManager* sm,
+    gboolean present,
+    void* user_data); /* Since 1.1.43 */
+
 typedef
 void
 (*GBinderServiceManagerRegistrationFunc)(
@@ -74,6 +96,22 @@ void
     const char* name,
     void* user_data);
 
+/*
+ * Service lookup cache (since 1.1.43)
+ *
+ * When enabled, the objects returned by gbinder_servicemanager_get_service()
+ * and gbinder_servicemanager_get_service_sync() are remembered by name, and
+ * subsequent lookups of the same name don't go to the servicemanager. Only
+ * successful lookups are cached. The entry is dropped when the object dies,
+ * when the name gets (re-)registered and a registration handler is watching
+ * it, or when the servicemanager itself dies. Disabling the cache empties
+ * it. The counters are accumulated while the cache is enabled.
+ */
+typedef struct gbinder_servicemanager_cache_stats {
+    guint hits;
+    guint misses;
+} GBinderServiceManagerCacheStats;
+
 GBinderServiceManager*
 gbinder_servicemanager_new(
     const char* dev)
@@ -112,6 +150,15 @@ gbinder_servicemanager_new_local_object2(
     void* user_data) /* Since 1.0.29 */
     G_GNUC_WARN_UNUSED_RESULT;
 
+GBinderLocalObject*
+gbinder_servicemanager_new_local_object_concurrent(
+    GBinderServiceManager* sm,
+    const char* const* ifaces,
+    GBinderLocalTransactFunc handler,
+    void* user_data,
+    GDestroyNotify destroy) /* Since 1.1.43 */
+    G_GNUC_WARN_UNUSED_RESULT;
+
 GBinderServiceManager*
 gbinder_servicemanager_ref(
     GBinderServiceManager* sm);
@@ -133,6 +180,26 @@ gbinder_servicemanager_wait(
     GBinderServiceManager* sm,
     long max_wait_ms); /* Since 1.0.25 */
 
+/*
+ * Non-blocking version of gbinder_servicemanager_wait(). The callback
+ * is invoked once, from the main loop, unless the wait gets cancelled
+ * with gbinder_servicemanager_remove_handler() or the servicemanager
+ * object is destroyed. Zero timeout just reports the current state,
+ * negative one waits forever.
+ */
+gulong
+gbinder_servicemanager_wait_async(
+    GBinderServiceManager* sm,
+    long max_wait_ms,
+    GBinderServiceManagerWaitFunc func,
+    void* user_data); /* Since 1.1.43 */
+
+gboolean
+gbinder_servicemanager_set_looper_limits(
+    GBinderServiceManager* sm,
+    guint min_loopers,
+    guint max_loopers); /* Since 1.1.43 */
+
 gulong
 gbinder_servicemanager_list(
     GBinderServiceManager* sm,
@@ -152,12 +219,29 @@ gbinder_servicemanager_get_service(
     GBinderServiceManagerGetServiceFunc func,
     void* user_data);
 
+gulong
+gbinder_servicemanager_get_services(
+    GBinderServiceManager* sm,
+    const char* const* names,
+    GBinderServiceManagerGetServicesFunc func,
+    void* user_data); /* Since 1.1.43 */
+
 GBinderRemoteObject* /* autoreleased */
 gbinder_servicemanager_get_service_sync(
     GBinderServiceManager* sm,
     const char* name,
     int* status);
 
+void
+gbinder_servicemanager_set_cache_enabled(
+    GBinderServiceManager* sm,
+    gboolean enabled); /* Since 1.1.43 */
+
+void
+gbinder_servicemanager_get_cache_stats(
+    GBinderServiceManager* sm,
+    GBinderServiceManagerCacheStats* stats); /* Since 1.1.43 */
+
 gulong
 gbinder_servicemanager_add_service(
     GBinderServiceManager* sm,
@@ -62,7 +62,9 @@ G_BEGIN_DECLS
 typedef struct gbinder_bridge GBinderBridge; /* Since 1.1.5 */
 typedef struct gbinder_buffer GBinderBuffer;
 typedef struct gbinder_client GBinderClient;
+typedef struct gbinder_client_oneway_tx GBinderClientOnewayTx;
 typedef struct gbinder_fmq GBinderFmq;  /* Since 1.1.14 */
+typedef struct gbinder_fmq_reader GBinderFmqReader; /* Since 1.1.43 */
 typedef struct gbinder_ipc GBinderIpc;
 typedef struct gbinder_local_object GBinderLocalObject;
 typedef struct gbinder_local_reply GBinderLocalReply;
@@ -310,12 +310,38 @@ gsize
 gbinder_writer_bytes_written(
     GBinderWriter* writer); /* Since 1.0.21 */
 
+/*
+ * Requests built once can be sent over and over again, with the values
+ * patched in place between the calls. The offsets are those returned by
+ * gbinder_writer_bytes_written() right before the value was appended.
+ * Replacement fd is not duplicated and must remain open until the
+ * transaction is completed. Replacement remote object is referenced
+ * by the writer until the request (or reply) is deallocated.
+ */
 void
 gbinder_writer_overwrite_int32(
     GBinderWriter* writer,
     gsize offset,
     gint32 value); /* Since 1.0.21 */
 
+void
+gbinder_writer_overwrite_int64(
+    GBinderWriter* writer,
+    gsize offset,
+    gint64 value); /* Since 1.1.43 */
+
+void
+gbinder_writer_overwrite_fd(
+    GBinderWriter* writer,
+    gsize offset,
+    int fd); /* Since 1.1.43 */
+
+void
+gbinder_writer_overwrite_remote_object(
+    GBinderWriter* writer,
+    gsize offset,
+    GBinderRemoteObject* obj); /* Since 1.1.43 */
+
 /* Note: memory allocated by GBinderWriter is owned by GBinderWriter */
 
 void*
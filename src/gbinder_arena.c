@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gbinder_arena.h"
+
+#include <gutil_macros.h>
+
+/*
+ * Chunks are linked together, the current one (the one being filled
+ * up) is always at the head of the list. Blocks which take more than
+ * a half of the standard chunk get a chunk of their own, which is
+ * linked right after the current one.
+ */
+struct gbinder_arena_chunk {
+    GBinderArenaChunk* next;
+    gsize size;
+};
+
+#define GBINDER_ARENA_ALIGN(x) G_ALIGN8(x)
+#define GBINDER_ARENA_CHUNK_SIZE (1024)
+#define GBINDER_ARENA_CHUNK_HEADER \
+    GBINDER_ARENA_ALIGN(sizeof(GBinderArenaChunk))
+#define GBINDER_ARENA_LARGE_BLOCK (GBINDER_ARENA_CHUNK_SIZE / 2)
+
+GBINDER_INLINE_FUNC guint8* gbinder_arena_chunk_data(GBinderArenaChunk* c)
+    { return ((guint8*)c) + GBINDER_ARENA_CHUNK_HEADER; }
+
+static
+GBinderArenaChunk*
+gbinder_arena_chunk_new(
+    gsize size)
+{
+    GBinderArenaChunk* chunk = g_malloc(GBINDER_ARENA_CHUNK_HEADER + size);
+
+    chunk->next = NULL;
+    chunk->size = size;
+    return chunk;
+}
+
+static
+void
+gbinder_arena_chunks_free(
+    GBinderArenaChunk* chunk)
+{
+    while (chunk) {
+        GBinderArenaChunk* next = chunk->next;
+
+        g_free(chunk);
+        chunk = next;
+    }
+}
+
+void*
+gbinder_arena_alloc(
+    GBinderArena* self,
+    gsize size)
+{
+    /* Same as g_malloc(0) */
+    if (size) {
+        const gsize aligned = GBINDER_ARENA_ALIGN(size);
+        GBinderArenaChunk* chunk = self->chunks;
+
+        if (chunk && (self->used + aligned) <= chunk->size) {
+            guint8* ptr = gbinder_arena_chunk_data(chunk) + self->used;
+
+            self->used += aligned;
+            return ptr;
+        } else if (aligned > GBINDER_ARENA_LARGE_BLOCK) {
+            GBinderArenaChunk* large = gbinder_arena_chunk_new(aligned);
+
+            if (chunk) {
+                /* Keep filling up the current chunk */
+                large->next = chunk->next;
+                chunk->next = large;
+            } else {
+                self->chunks = large;
+                self->used = aligned;
+            }
+            return gbinder_arena_chunk_data(large);
+        } else {
+            chunk = gbinder_arena_chunk_new(GBINDER_ARENA_CHUNK_SIZE);
+            chunk->next = self->chunks;
+            self->chunks = chunk;
+            self->used = aligned;
+            return gbinder_arena_chunk_data(chunk);
+        }
+    }
+    return NULL;
+}
+
+void*
+gbinder_arena_alloc0(
+    GBinderArena* self,
+    gsize size)
+{
+    void* ptr = gbinder_arena_alloc(self, size);
+
+    if (ptr) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+void*
+gbinder_arena_memdup(
+    GBinderArena* self,
+    const void* data,
+    gsize size)
+{
+    /* Same as gutil_memdup() */
+    if (data && size) {
+        void* ptr = gbinder_arena_alloc(self, size);
+
+        memcpy(ptr, data, size);
+        return ptr;
+    }
+    return NULL;
+}
+
+void
+gbinder_arena_reset(
+    GBinderArena* self)
+{
+    GBinderArenaChunk* keep = NULL;
+    GBinderArenaChunk* chunk = self->chunks;
+
+    /* Keep one standard chunk, drop the rest */
+    while (chunk) {
+        GBinderArenaChunk* next = chunk->next;
+
+        if (!keep && chunk->size == GBINDER_ARENA_CHUNK_SIZE) {
+            keep = chunk;
+            keep->next = NULL;
+        } else {
+            g_free(chunk);
+        }
+        chunk = next;
+    }
+    self->chunks = keep;
+    self->used = 0;
+}
+
+void
+gbinder_arena_free(
+    GBinderArena* self)
+{
+    gbinder_arena_chunks_free(self->chunks);
+    self->chunks = NULL;
+    self->used = 0;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
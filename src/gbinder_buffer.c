@@ -33,6 +33,7 @@
 #include "gbinder_buffer_p.h"
 #include "gbinder_driver.h"
 #include "gbinder_log.h"
+#include "gbinder_pool.h"
 
 #include <gutil_macros.h>
 
@@ -41,6 +42,7 @@ struct gbinder_buffer_contents {
     void* buffer;
     gsize size;
     void** objects;
+    gboolean pooled_objects;
     GBinderDriver* driver;
 };
 
@@ -52,6 +54,11 @@ typedef struct gbinder_buffer_priv {
 static inline GBinderBufferPriv* gbinder_buffer_cast(GBinderBuffer* buf)
     { return G_CAST(buf, GBinderBufferPriv, pub); }
 
+/* Object arrays up to this size are recycled */
+#define GBINDER_BUFFER_POOLED_OBJECTS (8)
+#define GBINDER_BUFFER_POOLED_OBJECTS_SIZE \
+    (sizeof(void*) * (GBINDER_BUFFER_POOLED_OBJECTS + 1))
+
 /*==========================================================================*
  * GBinderBufferContents
  *==========================================================================*/
@@ -62,14 +69,17 @@ gbinder_buffer_contents_new(
     GBinderDriver* driver,
     void* buffer,
     gsize size,
-    void** objects)
+    void** objects,
+    gboolean pooled_objects)
 {
-    GBinderBufferContents* self = g_slice_new0(GBinderBufferContents);
+    GBinderBufferContents* self = gbinder_pool_alloc0
+        (GBINDER_POOL_BUFFER_CONTENTS, sizeof(GBinderBufferContents));
 
     g_atomic_int_set(&self->refcount, 1);
     self->buffer = buffer;
     self->size = size;
     self->objects = objects;
+    self->pooled_objects = pooled_objects;
     self->driver = gbinder_driver_ref(driver);
     return self;
 }
@@ -82,11 +92,15 @@ gbinder_buffer_contents_free(
     if (self->objects) {
         gbinder_driver_close_fds(self->driver, self->objects,
             ((guint8*)self->buffer) + self->size);
-        g_free(self->objects);
+        if (self->pooled_objects) {
+            gbinder_buffer_objects_free(self->objects);
+        } else {
+            g_free(self->objects);
+        }
     }
     gbinder_driver_free_buffer(self->driver, self->buffer);
     gbinder_driver_unref(self->driver);
-    g_slice_free(GBinderBufferContents, self);
+    gbinder_pool_free(GBINDER_POOL_BUFFER_CONTENTS, self);
 }
 
 GBinderBufferContents*
@@ -164,7 +178,8 @@ gbinder_buffer_alloc(
     void* data,
     gsize size)
 {
-    GBinderBufferPriv* priv = g_slice_new0(GBinderBufferPriv);
+    GBinderBufferPriv* priv = gbinder_pool_alloc0(GBINDER_POOL_BUFFER,
+        sizeof(GBinderBufferPriv));
     GBinderBuffer* self = &priv->pub;
 
     priv->contents = contents;
@@ -181,7 +196,7 @@ gbinder_buffer_free(
         GBinderBufferPriv* priv = gbinder_buffer_cast(self);
 
         gbinder_buffer_contents_unref(priv->contents);
-        g_slice_free(GBinderBufferPriv, priv);
+        gbinder_pool_free(GBINDER_POOL_BUFFER, priv);
     }
 }
 
@@ -193,8 +208,21 @@ gbinder_buffer_new(
     void** objects)
 {
     return gbinder_buffer_alloc((driver && data) ?
-        gbinder_buffer_contents_new(driver, data, size, objects) : NULL,
-        data, size);
+        gbinder_buffer_contents_new(driver, data, size, objects, FALSE) :
+        NULL, data, size);
+}
+
+GBinderBuffer*
+gbinder_buffer_new_pooled(
+    GBinderDriver* driver,
+    void* data,
+    gsize size,
+    void** objects)
+{
+    /* Objects must have been allocated by gbinder_buffer_objects_new() */
+    return gbinder_buffer_alloc((driver && data) ?
+        gbinder_buffer_contents_new(driver, data, size, objects, TRUE) :
+        NULL, data, size);
 }
 
 GBinderBuffer*
@@ -281,6 +309,33 @@ gbinder_buffer_contents(
     return G_LIKELY(self) ? gbinder_buffer_cast(self)->contents : NULL;
 }
 
+void**
+gbinder_buffer_objects_new(
+    guint count)
+{
+    /* Room for the NULL terminator, which the caller has to store */
+    return (count <= GBINDER_BUFFER_POOLED_OBJECTS) ?
+        gbinder_pool_alloc0(GBINDER_POOL_BUFFER_OBJECTS,
+            GBINDER_BUFFER_POOLED_OBJECTS_SIZE) :
+        g_new(void*, count + 1);
+}
+
+void
+gbinder_buffer_objects_free(
+    void** objects)
+{
+    if (objects) {
+        guint count = 0;
+
+        while (objects[count]) count++;
+        if (count <= GBINDER_BUFFER_POOLED_OBJECTS) {
+            gbinder_pool_free(GBINDER_POOL_BUFFER_OBJECTS, objects);
+        } else {
+            g_free(objects);
+        }
+    }
+}
+
 /*
  * Local Variables:
  * mode: C
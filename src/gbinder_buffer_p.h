@@ -45,6 +45,14 @@ gbinder_buffer_new(
     void** objects)
     GBINDER_INTERNAL;
 
+GBinderBuffer*
+gbinder_buffer_new_pooled(
+    GBinderDriver* driver,
+    void* data,
+    gsize size,
+    void** objects)
+    GBINDER_INTERNAL;
+
 GBinderBuffer*
 gbinder_buffer_new_with_parent(
     GBinderBuffer* parent,
@@ -83,6 +91,17 @@ gbinder_buffer_objects(
     GBinderBuffer* buffer)
     GBINDER_INTERNAL;
 
+/* NULL-terminated array of count objects, the terminator isn't set */
+void**
+gbinder_buffer_objects_new(
+    guint count)
+    GBINDER_INTERNAL;
+
+void
+gbinder_buffer_objects_free(
+    void** objects)
+    GBINDER_INTERNAL;
+
 GBinderBufferContents*
 gbinder_buffer_contents_ref(
     GBinderBufferContents* contents)
@@ -249,6 +249,54 @@ gbinder_client_transact_sync_oneway2(
     return (-EINVAL);
 }
 
+int
+gbinder_client_transact_oneway_batch2(
+    GBinderClient* self,
+    const GBinderClientOnewayTx* txs,
+    guint count,
+    const GBinderIpcSyncApi* api)
+{
+    if (G_LIKELY(self) && (txs || !count)) {
+        GBinderRemoteObject* obj = self->remote;
+
+        if (G_LIKELY(!obj->dead)) {
+            GBinderClientOnewayTx* copy = NULL;
+            int ret;
+            guint i;
+
+            /* Substitute default empty requests for the missing ones */
+            for (i = 0; i < count; i++) {
+                if (!txs[i].req) {
+                    const GBinderClientIfaceRange* r;
+
+                    if (!copy) {
+                        copy = g_new(GBinderClientOnewayTx, count);
+                        memcpy(copy, txs, sizeof(txs[0]) * count);
+                    }
+                    r = gbinder_client_find_range(gbinder_client_cast(self),
+                        txs[i].code);
+                    if (r) {
+                        copy[i].req = r->basic_req;
+                    } else {
+                        GWARN("Unable to build empty request for tx code %u",
+                            txs[i].code);
+                        g_free(copy);
+                        return (-EINVAL);
+                    }
+                }
+            }
+            ret = count ? api->sync_oneway_batch(obj->ipc, obj->handle,
+                copy ? copy : txs, count) : GBINDER_STATUS_OK;
+            g_free(copy);
+            return ret;
+        } else {
+            GDEBUG("Refusing to perform transaction with a dead object");
+            return (-ESTALE);
+        }
+    }
+    return (-EINVAL);
+}
+
 /*==========================================================================*
  * Interface
  *==========================================================================*/
@@ -423,6 +471,16 @@ gbinder_client_transact_sync_oneway(
         &gbinder_ipc_sync_main);
 }
 
+int
+gbinder_client_transact_oneway_batch(
+    GBinderClient* self,
+    const GBinderClientOnewayTx* txs,
+    guint count) /* since 1.1.43 */
+{
+    return gbinder_client_transact_oneway_batch2(self, txs, count,
+        &gbinder_ipc_sync_main);
+}
+
 gulong
 gbinder_client_transact(
     GBinderClient* self,
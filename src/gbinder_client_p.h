@@ -59,6 +59,14 @@ gbinder_client_transact_sync_oneway2(
     const GBinderIpcSyncApi* api)
     GBINDER_INTERNAL;
 
+int
+gbinder_client_transact_oneway_batch2(
+    GBinderClient* self,
+    const GBinderClientOnewayTx* txs,
+    guint count,
+    const GBinderIpcSyncApi* api)
+    GBINDER_INTERNAL;
+
 #define gbinder_client_ipc(client) ((client)->remote->ipc)
 
 #endif /* GBINDER_CLIENT_PRIVATE_H */
@@ -66,7 +66,7 @@ const char* gbinder_config_dir = gbinder_config_default_dir;
  *
  */
 
-static const char CONF_GENERAL[] = "General";
+#define CONF_GENERAL GBINDER_CONFIG_GROUP_GENERAL
 static const char CONG_API_LEVEL[] = "ApiLevel";
 
 typedef struct gbinder_config_preset_entry {
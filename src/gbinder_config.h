@@ -63,6 +63,8 @@ extern const char* gbinder_config_file GBINDER_INTERNAL;
 extern const char* gbinder_config_dir GBINDER_INTERNAL;
 
 /* Configuration groups and special value */
+#define GBINDER_CONFIG_GROUP_GENERAL "General"
+#define GBINDER_CONFIG_GROUP_LOOPERS "Loopers"
 #define GBINDER_CONFIG_GROUP_PROTOCOL "Protocol"
 #define GBINDER_CONFIG_GROUP_SERVICEMANAGER "ServiceManager"
 #define GBINDER_CONFIG_VALUE_DEFAULT "Default"
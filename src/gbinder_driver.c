@@ -33,6 +33,9 @@
 #include "gbinder_driver.h"
 #include "gbinder_buffer_p.h"
 #include "gbinder_cleanup.h"
+#include "gbinder_client_p.h"
+#include "gbinder_config.h"
+#include "gbinder_eventloop_p.h"
 #include "gbinder_handler.h"
 #include "gbinder_io.h"
 #include "gbinder_local_object_p.h"
@@ -40,6 +43,7 @@
 #include "gbinder_local_request_p.h"
 #include "gbinder_object_registry.h"
 #include "gbinder_output_data.h"
+#include "gbinder_pool.h"
 #include "gbinder_remote_object_p.h"
 #include "gbinder_remote_reply_p.h"
 #include "gbinder_remote_request_p.h"
@@ -68,6 +72,9 @@
 
 #define BINDER_MAX_REPLY_SIZE (256)
 
+/* Max number of one-way transactions written at once */
+#define ONEWAY_BATCH_SIZE (32)
+
 /* ioctl code (the only one we really need here) */
 #define BINDER_VERSION _IOWR('b', 9, gint32)
 
@@ -76,15 +83,51 @@
 
 #define DEFAULT_MAX_BINDER_THREADS (0)
 
+/*
+ * Size of the per-thread read buffer can be configured like this:
+ *
+ * [General]
+ * ReadBufferSize=16384
+ *
+ * The larger the buffer, the more BR_* commands the driver can hand
+ * over to us in one BINDER_WRITE_READ call.
+ */
+static const char CONF_READ_BUFFER_SIZE[] = "ReadBufferSize";
+
+#define DEFAULT_READ_BUFFER_SIZE (4096)
+#define MIN_READ_BUFFER_SIZE GBINDER_IO_READ_BUFFER_SIZE
+#define MAX_READ_BUFFER_SIZE (32*1024)
+
+/*
+ * BC_FREE_BUFFER, BC_RELEASE and BC_DECREFS don't need to be submitted
+ * right away. They are queued and written to the driver together with
+ * whatever goes next, or on idle, or when the queue gets full. Delaying
+ * the commands which decrement something is always safe.
+ */
+#define PENDING_BUFFER_SIZE (256)
+#define MERGED_BUFFER_SIZE (PENDING_BUFFER_SIZE + \
+    sizeof(guint32) + GBINDER_MAX_BC_TRANSACTION_SG_SIZE)
+
 struct gbinder_driver {
     gint refcount;
     int fd;
     void* vm;
     gsize vmsize;
+    gsize rbufsize;
     char* dev;
     const char* name;
     const GBinderIo* io;
     const GBinderRpcProtocol* protocol;
+    /* Queued commands */
+    GMutex pending_mutex;
+    gint pending_size;
+    GBinderEventLoopCallback* flush_cb;
+    guint8 pending[PENDING_BUFFER_SIZE];
+    /* Statistics (updated atomically) */
+    gint stat_ioctls;
+    gint stat_reads;
+    gint stat_commands;
+    gint stat_max_commands;
 };
 
 typedef struct gbinder_driver_read_buf {
@@ -94,9 +137,20 @@ typedef struct gbinder_driver_read_buf {
 
 typedef struct gbinder_driver_read_data {
     GBinderDriverReadBuf buf;
-    guint8 data[GBINDER_IO_READ_BUFFER_SIZE];
+    gsize size;
+    /* Followed by the data */
 } GBinderDriverReadData;
 
+typedef struct gbinder_driver_write_buf {
+    GBinderIoBuf io;
+    GBinderIoBuf* write;
+    gsize prefix;
+    guint8 data[MERGED_BUFFER_SIZE];
+} GBinderDriverWriteBuf;
+
+/* Read buffer cached by the current thread */
+static GPrivate gbinder_driver_read_data = G_PRIVATE_INIT(g_free);
+
 typedef struct gbinder_driver_context {
     GBinderDriverReadBuf* rbuf;
     GBinderObjectRegistry* reg;
@@ -222,9 +276,41 @@ gbinder_driver_verbose_transaction_data(
 #  define gbinder_driver_verbose_transaction_data(x,y) GLOG_NOTHING
 #endif /* GUTIL_LOG_VERBOSE */
 
+static
+void
+gbinder_driver_count_commands(
+    GBinderDriver* self,
+    const GBinderIoBuf* read,
+    gsize were_consumed)
+{
+    const guint8* ptr = GSIZE_TO_POINTER(read->ptr + were_consumed);
+    const guint8* end = GSIZE_TO_POINTER(read->ptr + read->consumed);
+    gint n = 0;
+
+    /* Commands are never split between the reads */
+    while (ptr + sizeof(guint32) <= end) {
+        guint32 cmd;
+
+        memcpy(&cmd, ptr, sizeof(cmd));
+        ptr += sizeof(cmd) + _IOC_SIZE(cmd);
+        n++;
+    }
+
+    if (n) {
+        gint max;
+
+        g_atomic_int_inc(&self->stat_reads);
+        g_atomic_int_add(&self->stat_commands, n);
+        do {
+            max = g_atomic_int_get(&self->stat_max_commands);
+        } while (n > max && !g_atomic_int_compare_and_exchange
+            (&self->stat_max_commands, max, n));
+    }
+}
+
 static
 int
-gbinder_driver_write(
+gbinder_driver_write_buf(
     GBinderDriver* self,
     GBinderIoBuf* buf)
 {
@@ -237,12 +323,227 @@ gbinder_driver_write(
         GVERBOSE("gbinder_driver_write(%d) %u/%u", self->fd,
             (guint)buf->consumed, (guint)buf->size);
         err = self->io->write_read(self->fd, buf, NULL);
+        g_atomic_int_inc(&self->stat_ioctls);
         GVERBOSE("gbinder_driver_write(%d) %u/%u err %d", self->fd,
             (guint)buf->consumed, (guint)buf->size, err);
     }
     return err;
 }
 
+static
+gsize
+gbinder_driver_pending_take(
+    GBinderDriver* self,
+    guint8* buf)
+{
+    gsize size = 0;
+
+    if (g_atomic_int_get(&self->pending_size)) {
+        /* Lock */
+        g_mutex_lock(&self->pending_mutex);
+        size = self->pending_size;
+        memcpy(buf, self->pending, size);
+        g_atomic_int_set(&self->pending_size, 0);
+        g_mutex_unlock(&self->pending_mutex);
+        /* Unlock */
+    }
+    return size;
+}
+
+static
+void
+gbinder_driver_flush(
+    GBinderDriver* self)
+{
+    guint8 buf[PENDING_BUFFER_SIZE];
+    GBinderIoBuf write;
+
+    memset(&write, 0, sizeof(write));
+    write.size = gbinder_driver_pending_take(self, buf);
+    if (write.size && self->fd >= 0) {
+        write.ptr = (uintptr_t)buf;
+        GVERBOSE("Flushing %u bytes", (guint)write.size);
+        gbinder_driver_write_buf(self, &write);
+    }
+}
+
+static
+void
+gbinder_driver_flush_cb(
+    gpointer data)
+{
+    GBinderDriver* self = data;
+    GBinderEventLoopCallback* cb;
+
+    /* Lock */
+    g_mutex_lock(&self->pending_mutex);
+    cb = self->flush_cb;
+    self->flush_cb = NULL;
+    g_mutex_unlock(&self->pending_mutex);
+    /* Unlock */
+
+    gbinder_driver_flush(self);
+    gbinder_idle_callback_unref(cb);
+}
+
+static
+void
+gbinder_driver_flush_cb_done(
+    gpointer data)
+{
+    gbinder_driver_unref(data);
+}
+
+static
+void
+gbinder_driver_schedule_flush_locked(
+    GBinderDriver* self)
+{
+    /*
+     * The callback holds a reference to the driver. If it's the last
+     * one left, gbinder_driver_unref() flushes the queue synchronously
+     * and cancels the callback. That way the queue gets flushed and
+     * the fd gets closed even if there's no event loop running.
+     */
+    if (!self->flush_cb) {
+        self->flush_cb = gbinder_idle_callback_schedule_new
+            (gbinder_driver_flush_cb, gbinder_driver_ref(self),
+                gbinder_driver_flush_cb_done);
+    }
+}
+
+static
+void
+gbinder_driver_queue(
+    GBinderDriver* self,
+    const void* cmd,
+    gsize len)
+{
+    guint8 flush[PENDING_BUFFER_SIZE];
+    GBinderIoBuf write;
+
+    memset(&write, 0, sizeof(write));
+
+    /* Lock */
+    g_mutex_lock(&self->pending_mutex);
+    if (self->pending_size + len > sizeof(self->pending)) {
+        /* The queue is full, flush it */
+        write.size = self->pending_size;
+        memcpy(flush, self->pending, write.size);
+        self->pending_size = 0;
+    }
+    memcpy(self->pending + self->pending_size, cmd, len);
+    g_atomic_int_set(&self->pending_size, self->pending_size + len);
+    gbinder_driver_schedule_flush_locked(self);
+    g_mutex_unlock(&self->pending_mutex);
+    /* Unlock */
+
+    if (write.size) {
+        write.ptr = (uintptr_t)flush;
+        gbinder_driver_write_buf(self, &write);
+    }
+}
+
+static
+void
+gbinder_driver_requeue(
+    GBinderDriver* self,
+    const guint8* data,
+    gsize len)
+{
+    gboolean requeued = FALSE;
+
+    /* Lock */
+    g_mutex_lock(&self->pending_mutex);
+    if (self->pending_size + len <= sizeof(self->pending)) {
+        /* Put the unwritten commands back at the head of the queue */
+        memmove(self->pending + len, self->pending, self->pending_size);
+        memcpy(self->pending, data, len);
+        g_atomic_int_set(&self->pending_size, self->pending_size + len);
+        gbinder_driver_schedule_flush_locked(self);
+        requeued = TRUE;
+    }
+    g_mutex_unlock(&self->pending_mutex);
+    /* Unlock */
+
+    if (!requeued) {
+        /* The queue has been refilled in the meantime, write those now */
+        GBinderIoBuf write;
+
+        memset(&write, 0, sizeof(write));
+        write.ptr = (uintptr_t)data;
+        write.size = len;
+        gbinder_driver_write_buf(self, &write);
+    }
+}
+
+static
+GBinderIoBuf*
+gbinder_driver_write_begin(
+    GBinderDriver* self,
+    GBinderDriverWriteBuf* wbuf,
+    GBinderIoBuf* write)
+{
+    /* Prepend the queued commands (if any) to the caller's data */
+    wbuf->write = write;
+    wbuf->prefix = 0;
+    if (g_atomic_int_get(&self->pending_size)) {
+        const gsize tail = write ? (write->size - write->consumed) : 0;
+
+        if (tail <= sizeof(wbuf->data) - PENDING_BUFFER_SIZE) {
+            wbuf->prefix = gbinder_driver_pending_take(self, wbuf->data);
+            if (wbuf->prefix) {
+                if (tail) {
+                    memcpy(wbuf->data + wbuf->prefix,
+                        GSIZE_TO_POINTER(write->ptr + write->consumed), tail);
+                }
+                memset(&wbuf->io, 0, sizeof(wbuf->io));
+                wbuf->io.ptr = (uintptr_t)wbuf->data;
+                wbuf->io.size = wbuf->prefix + tail;
+                return &wbuf->io;
+            }
+        } else {
+            /* Doesn't fit, write those separately */
+            gbinder_driver_flush(self);
+        }
+    }
+    return write;
+}
+
+static
+void
+gbinder_driver_write_end(
+    GBinderDriver* self,
+    GBinderDriverWriteBuf* wbuf)
+{
+    if (wbuf->prefix) {
+        const gsize consumed = wbuf->io.consumed;
+
+        if (consumed > wbuf->prefix) {
+            /* wbuf->write can't be NULL if something beyond prefix */
+            wbuf->write->consumed += consumed - wbuf->prefix;
+        } else if (consumed < wbuf->prefix) {
+            gbinder_driver_requeue(self, wbuf->data + consumed,
+                wbuf->prefix - consumed);
+        }
+    }
+}
+
+static
+int
+gbinder_driver_write(
+    GBinderDriver* self,
+    GBinderIoBuf* buf)
+{
+    GBinderDriverWriteBuf wbuf;
+    int err;
+
+    err = gbinder_driver_write_buf(self,
+        gbinder_driver_write_begin(self, &wbuf, buf));
+    gbinder_driver_write_end(self, &wbuf);
+    return err;
+}
+
 static
 int
 gbinder_driver_write_read(
@@ -251,6 +552,7 @@ gbinder_driver_write_read(
     GBinderDriverReadBuf* rbuf)
 {
     int err = (-EAGAIN);
+    GBinderDriverWriteBuf wbuf;
     GBinderIoBuf rio;
     GBinderIoBuf* read;
 
@@ -264,10 +566,11 @@ gbinder_driver_write_read(
         read = &rbuf->io;
     }
 
+    write = gbinder_driver_write_begin(self, &wbuf, write);
     while (err == (-EAGAIN)) {
+        const gsize were_consumed = read->consumed;
 
 #if GUTIL_LOG_VERBOSE
-        const gsize were_consumed = read ? read->consumed : 0;
         if (GLOG_ENABLED(GLOG_LEVEL_VERBOSE)) {
             if (write) {
                 gbinder_driver_verbose_dump('<',
@@ -283,6 +586,8 @@ gbinder_driver_write_read(
         }
 #endif /* GUTIL_LOG_VERBOSE */
         err = self->io->write_read(self->fd, write, read);
+        g_atomic_int_inc(&self->stat_ioctls);
+        gbinder_driver_count_commands(self, read, were_consumed);
 #if GUTIL_LOG_VERBOSE
         if (GLOG_ENABLED(GLOG_LEVEL_VERBOSE)) {
             GVERBOSE("gbinder_driver_write_read(%d) "
@@ -299,6 +604,7 @@ gbinder_driver_write_read(
         }
 #endif /* GUTIL_LOG_VERBOSE */
     }
+    gbinder_driver_write_end(self, &wbuf);
 
     if (rbuf->offset) {
         rbuf->io.consumed = rio.consumed + rbuf->offset;
@@ -377,18 +683,70 @@ gbinder_driver_handle_cookie(
 }
 
 static
-void
-gbinder_driver_read_init(
-    GBinderDriverReadData* read)
+GBinderDriverReadBuf*
+gbinder_driver_read_buf_acquire(
+    GBinderDriver* self)
 {
     /*
-     * It shouldn't be necessary to zero-initialize the whole buffer
-     * but valgrind complains about access to uninitialised data if
-     * we don't do so. Oh well...
+     * Each thread keeps one read buffer around and reuses it. Nested
+     * calls (e.g. a synchronous transaction made by the handler of an
+     * incoming one) find the slot empty and allocate another buffer.
      */
-    memset(read, 0, sizeof(*read));
-    read->buf.io.ptr = GPOINTER_TO_SIZE(read->data);
-    read->buf.io.size = sizeof(read->data);
+    GBinderDriverReadData* read = g_private_get(&gbinder_driver_read_data);
+
+    if (read && read->size >= self->rbufsize) {
+        g_private_set(&gbinder_driver_read_data, NULL);
+    } else {
+        /* Drop the one which is too small (if any) */
+        g_private_replace(&gbinder_driver_read_data, NULL);
+
+        /*
+         * It shouldn't be necessary to zero-initialize the whole buffer
+         * but valgrind complains about access to uninitialised data if
+         * we don't do so. Oh well... At least we do it only once.
+         */
+        read = g_malloc0(sizeof(*read) + self->rbufsize);
+        read->size = self->rbufsize;
+    }
+
+    read->buf.io.ptr = GPOINTER_TO_SIZE(read + 1);
+    read->buf.io.size = read->size;
+    read->buf.io.consumed = 0;
+    read->buf.offset = 0;
+    return &read->buf;
+}
+
+static
+void
+gbinder_driver_read_buf_release(
+    GBinderDriverReadBuf* rbuf)
+{
+    GBinderDriverReadData* read = G_CAST(rbuf, GBinderDriverReadData, buf);
+
+    if (g_private_get(&gbinder_driver_read_data)) {
+        /* This must have been a nested call */
+        g_free(read);
+    } else {
+        g_private_set(&gbinder_driver_read_data, read);
+    }
+}
+
+static
+gsize
+gbinder_driver_read_buf_size(
+    void)
+{
+    GKeyFile* k = gbinder_config_get();
+
+    if (k) {
+        const int size = g_key_file_get_integer(k,
+            GBINDER_CONFIG_GROUP_GENERAL, CONF_READ_BUFFER_SIZE, NULL);
+
+        if (size > 0) {
+            return CLAMP(size, MIN_READ_BUFFER_SIZE, MAX_READ_BUFFER_SIZE);
+        }
+    }
+    return DEFAULT_READ_BUFFER_SIZE;
 }
 
 static
@@ -438,14 +796,13 @@ gbinder_driver_next_command(
 }
 
 static
-gboolean
+gsize
 gbinder_driver_reply_status(
     GBinderDriver* self,
-    gint32 status)
+    guint8* buf,
+    gint32* status)
 {
     const GBinderIo* io = self->io;
-    GBinderIoBuf write;
-    guint8 buf[sizeof(guint32) + GBINDER_MAX_BC_TRANSACTION_SIZE];
     guint8* ptr = buf;
     const guint32* code = &io->bc.reply;
 
@@ -455,30 +812,25 @@ gbinder_driver_reply_status(
     ptr += sizeof(*code);
 
     /* Data */
-    ptr += io->encode_status_reply(ptr, &status);
+    ptr += io->encode_status_reply(ptr, status);
 
-    GVERBOSE("< BC_REPLY (%d)", status);
-    memset(&write, 0, sizeof(write));
-    write.ptr = (uintptr_t)buf;
-    write.size = ptr - buf;
-    return gbinder_driver_write(self, &write) >= 0;
+    GVERBOSE("< BC_REPLY (%d)", *status);
+    return ptr - buf;
 }
 
 static
-gboolean
+gsize
 gbinder_driver_reply_data(
     GBinderDriver* self,
-    GBinderOutputData* data)
+    guint8* buf,
+    GBinderOutputData* data,
+    GBinderIoOffsetsBuf* offsets_buf)
 {
-    GBinderIoBuf write;
     const GBinderIo* io = self->io;
     const gsize extra_buffers = gbinder_output_data_buffers_size(data);
-    guint8 buf[GBINDER_MAX_BC_TRANSACTION_SG_SIZE + sizeof(guint32)];
     guint32* cmd = (guint32*)buf;
-    guint len = sizeof(*cmd);
-    int status;
+    gsize len = sizeof(*cmd);
     GUtilIntArray* offsets = gbinder_output_data_offsets(data);
-    void* offsets_buf = NULL;
 
     /* Build BC_REPLY */
     if (extra_buffers) {
@@ -486,30 +838,16 @@ gbinder_driver_reply_data(
         gbinder_driver_verbose_dump_bytes(' ', data->bytes);
         *cmd = io->bc.reply_sg;
         len += io->encode_reply_sg(buf + len, 0, 0, data->bytes,
-            offsets, &offsets_buf, extra_buffers);
+            offsets, offsets_buf, extra_buffers);
     } else {
         GVERBOSE("< BC_REPLY");
         gbinder_driver_verbose_dump_bytes(' ', data->bytes);
         *cmd = io->bc.reply;
         len += io->encode_reply(buf + len, 0, 0, data->bytes,
-            offsets, &offsets_buf);
+            offsets, offsets_buf);
     }
 
-#if 0 /* GUTIL_LOG_VERBOSE */
-    if (offsets && offsets->count) {
-        gbinder_driver_verbose_dump('<', (uintptr_t)offsets_buf,
-            offsets->count * io->pointer_size);
-    }
-#endif /* GUTIL_LOG_VERBOSE */
-
-    /* Write it */
-    write.ptr = (uintptr_t)buf;
-    write.size = len;
-    write.consumed = 0;
-    status = gbinder_driver_write(self, &write);
-
-    g_free(offsets_buf);
-    return status >= 0;
+    return len;
 }
 
 static
@@ -534,7 +872,7 @@ gbinder_driver_handle_transaction(
 
     /* Transfer data ownership to the request */
     if (tx.data && tx.size) {
-        GBinderBuffer* buf = gbinder_buffer_new(self,
+        GBinderBuffer* buf = gbinder_buffer_new_pooled(self,
             tx.data, tx.size, tx.objects);
 
         gbinder_driver_verbose_dump(' ', (uintptr_t)tx.data, tx.size);
@@ -573,21 +911,35 @@ gbinder_driver_handle_transaction(
 
     /* No reply for one-way transactions */
     if (!(tx.flags & GBINDER_TX_FLAG_ONEWAY)) {
+        GBinderIoBuf write;
+        guint8 wbuf[GBINDER_MAX_BC_TRANSACTION_SG_SIZE + sizeof(guint32)];
+        GBinderIoOffsetsBuf offsets_buf;
+        gint32 status = txstatus; /* Must stay put until written */
+
+        memset(&write, 0, sizeof(write));
+        write.ptr = (uintptr_t)wbuf;
+        offsets_buf.heap = NULL;
         if (reply) {
             context->bufs = gbinder_buffer_contents_list_add(context->bufs,
                 gbinder_local_reply_contents(reply));
-            gbinder_driver_reply_data(self, gbinder_local_reply_data(reply));
+            write.size = gbinder_driver_reply_data(self, wbuf,
+                gbinder_local_reply_data(reply), &offsets_buf);
         } else {
-            gbinder_driver_reply_status(self, txstatus);
+            write.size = gbinder_driver_reply_status(self, wbuf, &status);
         }
 
-        /* Wait until the reply is handled */
+        /*
+         * Send the reply and wait until it's handled. Both happen in
+         * the same BINDER_WRITE_READ call (unless the driver needs more
+         * than one to deliver BR_TRANSACTION_COMPLETE).
+         */
         do {
-            txstatus = gbinder_driver_write_read(self, NULL, context->rbuf);
+            txstatus = gbinder_driver_write_read(self, &write, context->rbuf);
             if (txstatus >= 0) {
                 txstatus = gbinder_driver_txstatus(self, context, NULL);
             }
         } while (txstatus == (-EAGAIN));
+        g_free(offsets_buf.heap);
     }
 
     /* Free the data allocated for the transaction */
@@ -637,6 +989,7 @@ gbinder_driver_handle_command(
         GVERBOSE("> BR_TRANSACTION_COMPLETE (?)");
     } else if (cmd == io->br.spawn_looper) {
         GVERBOSE("> BR_SPAWN_LOOPER");
+        gbinder_handler_spawn_looper(context->handler);
     } else if (cmd == io->br.finished) {
         GVERBOSE("> BR_FINISHED");
     } else if (cmd == io->br.increfs) {
@@ -814,7 +1167,7 @@ gbinder_driver_txstatus(
 
             /* Transfer data ownership to the reply */
             if (tx.data && tx.size && reply) {
-                GBinderBuffer* buf = gbinder_buffer_new(self,
+                GBinderBuffer* buf = gbinder_buffer_new_pooled(self,
                     tx.data, tx.size, tx.objects);
 
                 gbinder_driver_verbose_dump(' ', (uintptr_t)tx.data, tx.size);
@@ -822,7 +1175,7 @@ gbinder_driver_txstatus(
                 context->bufs = gbinder_buffer_contents_list_add(context->bufs,
                     gbinder_buffer_contents(buf));
             } else {
-                GASSERT(!tx.objects);
+                gbinder_buffer_objects_free(tx.objects);
                 gbinder_driver_free_buffer(self, tx.data);
             }
 
@@ -853,6 +1206,63 @@ gbinder_driver_txstatus(
     return txstatus;
 }
 
+static
+gsize
+gbinder_driver_encode_transaction(
+    GBinderDriver* self,
+    guint8* wbuf,
+    guint32 handle,
+    guint32 code,
+    GBinderLocalRequest* req,
+    guint flags,
+    GBinderIoOffsetsBuf* offsets_buf)
+{
+    const GBinderIo* io = self->io;
+    GBinderOutputData* data = gbinder_local_request_data(req);
+    const gsize extra_buffers = gbinder_output_data_buffers_size(data);
+    GUtilIntArray* offsets = gbinder_output_data_offsets(data);
+    guint32* cmd = (guint32*)wbuf;
+    gsize len = sizeof(*cmd);
+
+    if (extra_buffers) {
+        GVERBOSE("< BC_TRANSACTION_SG 0x%08x 0x%08x %u bytes", handle, code,
+            (guint)extra_buffers);
+        gbinder_driver_verbose_dump_bytes(' ', data->bytes);
+        *cmd = io->bc.transaction_sg;
+        len += io->encode_transaction_sg(wbuf + len, handle, code,
+            data->bytes, flags, offsets, offsets_buf, extra_buffers);
+    } else {
+        GVERBOSE("< BC_TRANSACTION 0x%08x 0x%08x", handle, code);
+        gbinder_driver_verbose_dump_bytes(' ', data->bytes);
+        *cmd = io->bc.transaction;
+        len += io->encode_transaction(wbuf + len, handle, code,
+            data->bytes, flags, offsets, offsets_buf);
+    }
+    return len;
+}
+
+static
+int
+gbinder_driver_finish_transact(
+    GBinderDriver* self,
+    GBinderDriverContext* context,
+    int txstatus)
+{
+    GBinderDriverReadBuf* rbuf = context->rbuf;
+
+    /* Loop until we have handled all the incoming commands */
+    gbinder_driver_handle_commands(self, context);
+    while (rbuf->io.consumed) {
+        int err = gbinder_driver_write_read(self, NULL, rbuf);
+        if (err < 0) {
+            return err;
+        } else {
+            gbinder_driver_handle_commands(self, context);
+        }
+    }
+    return txstatus;
+}
+
 /*==========================================================================*
  * Interface
  *
@@ -896,6 +1306,8 @@ gbinder_driver_new(
                     self->io = io;
                     self->vm = vm;
                     self->vmsize = vmsize;
+                    self->rbufsize = gbinder_driver_read_buf_size();
+                    g_mutex_init(&self->pending_mutex);
                     self->dev = g_strdup(dev);
                     self->name = self->dev + /* Shorter version for logging */
                         (g_str_has_prefix(self->dev, "/dev/") ? 5 : 0);
@@ -938,8 +1350,30 @@ gbinder_driver_unref(
     GBinderDriver* self)
 {
     GASSERT(self->refcount > 0);
+    if (g_atomic_int_get(&self->refcount) == 2) {
+        GBinderEventLoopCallback* cb = NULL;
+
+        /* The other reference may be held by the flush callback */
+
+        /* Lock */
+        g_mutex_lock(&self->pending_mutex);
+        if (self->flush_cb && g_atomic_int_get(&self->refcount) == 2) {
+            cb = self->flush_cb;
+            self->flush_cb = NULL;
+        }
+        g_mutex_unlock(&self->pending_mutex);
+        /* Unlock */
+
+        if (cb) {
+            /* This drops the reference held by the callback */
+            gbinder_driver_flush(self);
+            gbinder_idle_callback_destroy(cb);
+        }
+    }
     if (g_atomic_int_dec_and_test(&self->refcount)) {
+        GASSERT(!self->flush_cb);
         gbinder_driver_close(self);
+        g_mutex_clear(&self->pending_mutex);
         g_free(self->dev);
         g_slice_free(GBinderDriver, self);
     }
@@ -950,6 +1384,7 @@ gbinder_driver_close(
     GBinderDriver* self)
 {
     if (self->vm) {
+        gbinder_driver_flush(self);
         GDEBUG("Closing %s", self->dev);
         gbinder_system_munmap(self->vm, self->vmsize);
         gbinder_system_close(self->fd);
@@ -971,6 +1406,15 @@ int
 gbinder_driver_poll(
     GBinderDriver* self,
     struct pollfd* pipefd)
+{
+    return gbinder_driver_poll_timeout(self, pipefd, -1);
+}
+
+int
+gbinder_driver_poll_timeout(
+    GBinderDriver* self,
+    struct pollfd* pipefd,
+    int timeout_ms)
 {
     struct pollfd fds[2];
     nfds_t n = 1;
@@ -986,7 +1430,7 @@ gbinder_driver_poll(
         n++;
     }
 
-    err = poll(fds, n, -1);
+    err = poll(fds, n, timeout_ms);
     if (err >= 0) {
         if (pipefd) {
             pipefd->revents = fds[1].revents;
@@ -1105,8 +1549,13 @@ gbinder_driver_decrefs(
     GBinderDriver* self,
     guint32 handle)
 {
-    GVERBOSE("< BC_DECREFS 0x%08x", handle);
-    return gbinder_driver_cmd_int32(self, self->io->bc.decrefs, handle);
+    guint32 data[2];
+
+    GVERBOSE("< BC_DECREFS 0x%08x (queued)", handle);
+    data[0] = self->io->bc.decrefs;
+    data[1] = handle;
+    gbinder_driver_queue(self, data, sizeof(data));
+    return TRUE;
 }
 
 gboolean
@@ -1123,8 +1572,13 @@ gbinder_driver_release(
     GBinderDriver* self,
     guint32 handle)
 {
-    GVERBOSE("< BC_RELEASE 0x%08x", handle);
-    return gbinder_driver_cmd_int32(self, self->io->bc.release, handle);
+    guint32 data[2];
+
+    GVERBOSE("< BC_RELEASE 0x%08x (queued)", handle);
+    data[0] = self->io->bc.release;
+    data[1] = handle;
+    gbinder_driver_queue(self, data, sizeof(data));
+    return TRUE;
 }
 
 void
@@ -1159,21 +1613,15 @@ gbinder_driver_free_buffer(
     void* buffer)
 {
     if (buffer) {
-        GBinderIoBuf write;
         const GBinderIo* io = self->io;
         guint8 wbuf[GBINDER_MAX_POINTER_SIZE + sizeof(guint32)];
         guint32* cmd = (guint32*)wbuf;
         guint len = sizeof(*cmd);
 
-        GVERBOSE("< BC_FREE_BUFFER %p", buffer);
+        GVERBOSE("< BC_FREE_BUFFER %p (queued)", buffer);
         *cmd = io->bc.free_buffer;
         len += io->encode_pointer(wbuf + len, buffer);
-
-        /* Write it */
-        write.ptr = (uintptr_t)wbuf;
-        write.size = len;
-        write.consumed = 0;
-        (void) gbinder_driver_write(self, &write);
+        gbinder_driver_queue(self, wbuf, len);
     }
 }
 
@@ -1185,6 +1633,14 @@ gbinder_driver_enter_looper(
     return gbinder_driver_cmd(self, self->io->bc.enter_looper);
 }
 
+gboolean
+gbinder_driver_register_looper(
+    GBinderDriver* self)
+{
+    GVERBOSE("< BC_REGISTER_LOOPER");
+    return gbinder_driver_cmd(self, self->io->bc.register_looper);
+}
+
 gboolean
 gbinder_driver_exit_looper(
     GBinderDriver* self)
@@ -1193,23 +1649,38 @@ gbinder_driver_exit_looper(
     return gbinder_driver_cmd(self, self->io->bc.exit_looper);
 }
 
+gboolean
+gbinder_driver_set_max_threads(
+    GBinderDriver* self,
+    guint max_threads)
+{
+    guint32 value = max_threads;
+
+    if (gbinder_system_ioctl(self->fd, BINDER_SET_MAX_THREADS, &value) < 0) {
+        GERR("%s failed to set max threads (%u): %s", self->dev,
+            max_threads, strerror(errno));
+        return FALSE;
+    }
+    GDEBUG("%s max threads %u", self->name, max_threads);
+    return TRUE;
+}
+
 int
 gbinder_driver_read(
     GBinderDriver* self,
     GBinderObjectRegistry* reg,
     GBinderHandler* handler)
 {
-    GBinderDriverReadData read;
+    GBinderDriverReadBuf* rbuf = gbinder_driver_read_buf_acquire(self);
     GBinderDriverContext context;
     int ret;
 
-    gbinder_driver_read_init(&read);
-    gbinder_driver_context_init(&context, &read.buf, reg, handler);
-    ret = gbinder_driver_write_read(self, NULL, context.rbuf);
+    gbinder_driver_context_init(&context, rbuf, reg, handler);
+    ret = gbinder_driver_write_read(self, NULL, rbuf);
     if (ret >= 0) {
         /* Loop until we have handled all the incoming commands */
         gbinder_driver_handle_commands(self, &context);
-        while (read.buf.io.consumed && gbinder_handler_can_loop(handler)) {
+        while (rbuf->io.consumed && gbinder_handler_can_loop(handler)) {
             ret = gbinder_driver_write_read(self, NULL, context.rbuf);
             if (ret >= 0) {
                 gbinder_driver_handle_commands(self, &context);
@@ -1219,6 +1690,7 @@ gbinder_driver_read(
         }
     }
     gbinder_driver_context_cleanup(&context);
+    gbinder_driver_read_buf_release(rbuf);
     return ret;
 }
 
@@ -1232,50 +1704,20 @@ gbinder_driver_transact(
     GBinderLocalRequest* req,
     GBinderRemoteReply* reply)
 {
-    GBinderDriverReadData read;
+    GBinderDriverReadBuf* rbuf = gbinder_driver_read_buf_acquire(self);
     GBinderDriverContext context;
     GBinderIoBuf write;
-    GBinderDriverReadBuf* rbuf = &read.buf;
-    const GBinderIo* io = self->io;
     const guint flags = reply ? 0 : GBINDER_TX_FLAG_ONEWAY;
-    GBinderOutputData* data = gbinder_local_request_data(req);
-    const gsize extra_buffers = gbinder_output_data_buffers_size(data);
-    GUtilIntArray* offsets = gbinder_output_data_offsets(data);
-    void* offsets_buf = NULL;
+    GBinderIoOffsetsBuf offsets_buf;
     guint8 wbuf[GBINDER_MAX_BC_TRANSACTION_SG_SIZE + sizeof(guint32)];
-    guint32* cmd = (guint32*)wbuf;
-    guint len = sizeof(*cmd);
     int txstatus = (-EAGAIN);
 
-    gbinder_driver_read_init(&read);
-    gbinder_driver_context_init(&context, &read.buf, reg, handler);
-
-    /* Build BC_TRANSACTION */
-    if (extra_buffers) {
-        GVERBOSE("< BC_TRANSACTION_SG 0x%08x 0x%08x %u bytes", handle, code,
-            (guint)extra_buffers);
-        gbinder_driver_verbose_dump_bytes(' ', data->bytes);
-        *cmd = io->bc.transaction_sg;
-        len += io->encode_transaction_sg(wbuf + len, handle, code,
-            data->bytes, flags, offsets, &offsets_buf, extra_buffers);
-    } else {
-        GVERBOSE("< BC_TRANSACTION 0x%08x 0x%08x", handle, code);
-        gbinder_driver_verbose_dump_bytes(' ', data->bytes);
-        *cmd = io->bc.transaction;
-        len += io->encode_transaction(wbuf + len, handle, code,
-            data->bytes, flags, offsets, &offsets_buf);
-    }
-
-#if 0 /* GUTIL_LOG_VERBOSE */
-    if (offsets && offsets->count) {
-        gbinder_driver_verbose_dump('<', (uintptr_t)offsets_buf,
-            offsets->count * io->pointer_size);
-    }
-#endif /* GUTIL_LOG_VERBOSE */
+    gbinder_driver_context_init(&context, rbuf, reg, handler);
 
-    /* Write it */
+    /* Build BC_TRANSACTION and write it */
     write.ptr = (uintptr_t)wbuf;
-    write.size = len;
+    write.size = gbinder_driver_encode_transaction(self, wbuf, handle, code,
+        req, flags, &offsets_buf);
     write.consumed = 0;
 
     /* And wait for reply. Positive txstatus is the transaction status,
@@ -1293,25 +1735,97 @@ gbinder_driver_transact(
     if (txstatus >= 0) {
         /* The whole thing should've been written in case of success */
         GASSERT(write.consumed == write.size || txstatus > 0);
+        txstatus = gbinder_driver_finish_transact(self, &context, txstatus);
+    }
 
-        /* Loop until we have handled all the incoming commands */
-        gbinder_driver_handle_commands(self, &context);
-        while (rbuf->io.consumed) {
-            int err = gbinder_driver_write_read(self, NULL, rbuf);
-            if (err < 0) {
-                txstatus = err;
-                break;
+    gbinder_driver_context_cleanup(&context);
+    gbinder_driver_read_buf_release(rbuf);
+    g_free(offsets_buf.heap);
+    return txstatus;
+}
+
+int
+gbinder_driver_transact_oneway_batch(
+    GBinderDriver* self,
+    GBinderObjectRegistry* reg,
+    GBinderHandler* handler,
+    guint32 handle,
+    const GBinderClientOnewayTx* txs,
+    guint count)
+{
+    GBinderDriverReadBuf* rbuf = gbinder_driver_read_buf_acquire(self);
+    GBinderDriverContext context;
+    GBinderIoOffsetsBuf offsets_buf[ONEWAY_BATCH_SIZE];
+    guint8 wbuf[ONEWAY_BATCH_SIZE *
+        (GBINDER_MAX_BC_TRANSACTION_SG_SIZE + sizeof(guint32))];
+    int txstatus = GBINDER_STATUS_OK;
+
+    gbinder_driver_context_init(&context, rbuf, reg, handler);
+    while (count > 0 && txstatus == GBINDER_STATUS_OK) {
+        const guint n = MIN(count, ONEWAY_BATCH_SIZE);
+        guint i, done = 0;
+        GBinderIoBuf write;
+
+        /* Build a bunch of BC_TRANSACTIONs */
+        memset(&write, 0, sizeof(write));
+        write.ptr = (uintptr_t)wbuf;
+        for (i = 0; i < n; i++) {
+            write.size += gbinder_driver_encode_transaction(self,
+                wbuf + write.size, handle, txs[i].code, txs[i].req,
+                GBINDER_TX_FLAG_ONEWAY, offsets_buf + i);
+        }
+
+        /*
+         * Write them all at once and collect BR_TRANSACTION_COMPLETE
+         * for each of them. The driver stops processing the write buffer
+         * after the first failure.
+         */
+        while (done < n) {
+            txstatus = gbinder_driver_txstatus(self, &context, NULL);
+            if (txstatus == (-EAGAIN)) {
+                txstatus = gbinder_driver_write_read(self, &write, rbuf);
+                if (txstatus < 0) {
+                    break;
+                }
+            } else if (txstatus == GBINDER_STATUS_OK) {
+                done++;
             } else {
-                gbinder_driver_handle_commands(self, &context);
+                break;
             }
         }
+
+        for (i = 0; i < n; i++) {
+            g_free(offsets_buf[i].heap);
+        }
+        txs += n;
+        count -= n;
+    }
+
+    if (txstatus >= 0) {
+        txstatus = gbinder_driver_finish_transact(self, &context, txstatus);
     }
 
     gbinder_driver_context_cleanup(&context);
-    g_free(offsets_buf);
+    gbinder_driver_read_buf_release(rbuf);
     return txstatus;
 }
 
+void
+gbinder_driver_stats(
+    GBinderDriver* self,
+    GBinderDriverStats* stats)
+{
+    GBinderPoolStats pool;
+
+    stats->ioctls = g_atomic_int_get(&self->stat_ioctls);
+    stats->reads = g_atomic_int_get(&self->stat_reads);
+    stats->commands = g_atomic_int_get(&self->stat_commands);
+    stats->max_commands = g_atomic_int_get(&self->stat_max_commands);
+    gbinder_pool_stats(&pool);
+    stats->pool_hits = pool.hits;
+    stats->pool_misses = pool.misses;
+}
+
 GBinderLocalRequest*
 gbinder_driver_local_request_new(
     GBinderDriver* self,
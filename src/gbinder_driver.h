@@ -37,6 +37,15 @@
 
 struct pollfd;
 
+typedef struct gbinder_driver_stats {
+    guint ioctls;       /* BINDER_WRITE_READ calls */
+    guint reads;        /* Calls which returned some BR_* commands */
+    guint commands;     /* BR_* commands received */
+    guint max_commands; /* Max number of BR_* commands per call */
+    guint pool_hits;    /* Recycled allocations (process-wide) */
+    guint pool_misses;  /* Pool allocations which had to malloc */
+} GBinderDriverStats;
+
 GBinderDriver*
 gbinder_driver_new(
     const char* dev,
@@ -69,6 +78,13 @@ gbinder_driver_poll(
     struct pollfd* pollfd)
     GBINDER_INTERNAL;
 
+int
+gbinder_driver_poll_timeout(
+    GBinderDriver* driver,
+    struct pollfd* pollfd,
+    int timeout_ms)
+    GBINDER_INTERNAL;
+
 const char*
 gbinder_driver_dev(
     GBinderDriver* driver)
@@ -150,11 +166,22 @@ gbinder_driver_enter_looper(
     GBinderDriver* driver)
     GBINDER_INTERNAL;
 
+gboolean
+gbinder_driver_register_looper(
+    GBinderDriver* driver)
+    GBINDER_INTERNAL;
+
 gboolean
 gbinder_driver_exit_looper(
     GBinderDriver* driver)
     GBINDER_INTERNAL;
 
+gboolean
+gbinder_driver_set_max_threads(
+    GBinderDriver* driver,
+    guint max_threads)
+    GBINDER_INTERNAL;
+
 int
 gbinder_driver_read(
     GBinderDriver* driver,
@@ -173,6 +200,22 @@ gbinder_driver_transact(
     GBinderRemoteReply* reply)
     GBINDER_INTERNAL;
 
+int
+gbinder_driver_transact_oneway_batch(
+    GBinderDriver* driver,
+    GBinderObjectRegistry* reg,
+    GBinderHandler* handler,
+    guint32 handle,
+    const GBinderClientOnewayTx* txs,
+    guint count)
+    GBINDER_INTERNAL;
+
+void
+gbinder_driver_stats(
+    GBinderDriver* driver,
+    GBinderDriverStats* stats)
+    GBINDER_INTERNAL;
+
 GBinderLocalRequest*
 gbinder_driver_local_request_new(
     GBinderDriver* driver,
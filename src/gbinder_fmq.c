@@ -39,6 +39,7 @@
 #include <linux/futex.h>
 #include <stdint.h>
 #include <sys/mman.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #if GBINDER_FMQ_SUPPORTED
@@ -51,15 +52,61 @@ enum {
     EVENT_FLAG_PTR_POS
 };
 
+/*
+ * With GBINDER_FMQ_FLAG_CACHE_LINE_ALIGN each grantor starts at its own
+ * cache line, so that the reader updating the read counter and the
+ * writer updating the write counter don't keep invalidating each other's
+ * cache. Only the offsets in the grantor descriptors change, the other
+ * side finds everything where the descriptors say.
+ */
+#define GBINDER_FMQ_CACHE_LINE_SIZE (64)
+
+/*
+ * With GBINDER_FMQ_FLAG_SPIN_WAIT the blocking calls poll the queue for
+ * a while before going to sleep. The number of iterations adapts to how
+ * successful spinning has been so far.
+ */
+#define GBINDER_FMQ_SPIN_MIN (16)
+#define GBINDER_FMQ_SPIN_INIT (128)
+#define GBINDER_FMQ_SPIN_MAX (4096)
+
+#if defined(__i386__) || defined(__x86_64__)
+#  define GBINDER_FMQ_CPU_RELAX() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#  define GBINDER_FMQ_CPU_RELAX() __asm__ __volatile__("yield" ::: "memory")
+#else
+#  define GBINDER_FMQ_CPU_RELAX() __asm__ __volatile__("" ::: "memory")
+#endif
+#define GBINDER_FMQ_ALIGN(x,a) (((x) + (a) - 1) & ~((gsize)(a) - 1))
+
+/*
+ * Read pointer and overrun counters. Each reader of an unsynchronized
+ * queue has its own. Overrun counters are only updated by the reader
+ * but may be fetched by any thread.
+ */
+typedef struct gbinder_fmq_read_state {
+    guint64* read_ptr;
+    guint64 lost;
+    guint resyncs;
+} GBinderFmqReadState;
+
 typedef struct gbinder_fmq {
     GBinderMQDescriptor* desc;
     guint8* ring;
-    guint64* read_ptr;
+    GBinderFmqReadState reader;
     guint64* write_ptr;
     guint32* event_flag_ptr;
     guint32 refcount;
+    gint read_spin;
+    gint write_spin;
 } GBinderFmq;
 
+struct gbinder_fmq_reader {
+    GBinderFmq* fmq;
+    GBinderFmqReadState state;
+    guint64 read_ptr;
+};
+
 GBINDER_INLINE_FUNC
 GBinderFmqGrantorDescriptor*
 gbinder_fmq_get_grantor_descriptor(
@@ -72,11 +119,13 @@ gbinder_fmq_get_grantor_descriptor(
 
 static
 gsize
-gbinder_fmq_available_to_read_bytes(
+gbinder_fmq_state_available_bytes(
     GBinderFmq* self,
+    GBinderFmqReadState* state,
     gboolean contiguous)
 {
-    const guint64 read_ptr = __atomic_load_n(self->read_ptr, __ATOMIC_ACQUIRE);
+    const guint64 read_ptr = __atomic_load_n(state->read_ptr,
+        __ATOMIC_ACQUIRE);
     const gsize available_total = __atomic_load_n(self->write_ptr,
         __ATOMIC_ACQUIRE) - read_ptr;
 
@@ -96,6 +145,40 @@ gbinder_fmq_available_to_read_bytes(
     }
 }
 
+GBINDER_INLINE_FUNC
+gsize
+gbinder_fmq_available_to_read_bytes(
+    GBinderFmq* self,
+    gboolean contiguous)
+{
+    return gbinder_fmq_state_available_bytes(self, &self->reader, contiguous);
+}
+
+static
+void
+gbinder_fmq_state_resync(
+    GBinderFmq* self,
+    GBinderFmqReadState* state,
+    guint64 read_ptr,
+    guint64 write_ptr)
+{
+    /* The writer has lapped the reader, whatever was unread is gone */
+    __atomic_add_fetch(&state->lost, (write_ptr - read_ptr) /
+        self->desc->quantum, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&state->resyncs, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(state->read_ptr, write_ptr, __ATOMIC_RELEASE);
+}
+
+static
+void
+gbinder_fmq_state_overruns(
+    GBinderFmqReadState* state,
+    GBinderFmqOverruns* overruns)
+{
+    overruns->lost = __atomic_load_n(&state->lost, __ATOMIC_RELAXED);
+    overruns->resyncs = __atomic_load_n(&state->resyncs, __ATOMIC_RELAXED);
+}
+
 static
 gsize
 gbinder_fmq_available_to_write_bytes(
@@ -128,7 +211,9 @@ GBinderFmqGrantorDescriptor*
 gbinder_fmq_create_grantors(
     gsize queue_size_bytes,
     gsize num_fds,
-    gboolean configure_event_flag)
+    gboolean configure_event_flag,
+    gsize align,
+    gsize* shmem_size)
 {
     const gsize num_grantors = configure_event_flag ?
         (EVENT_FLAG_PTR_POS + 1) : (DATA_PTR_POS + 1);
@@ -144,21 +229,21 @@ gbinder_fmq_create_grantors(
 
     for (pos = 0, offset = 0; pos < num_grantors; pos++) {
         GBinderFmqGrantorDescriptor* grantor = grantors + pos;
-        guint32 grantor_fd_index;
-        gsize grantor_offset;
 
         if (pos == DATA_PTR_POS && num_fds == 2) {
-            grantor_fd_index = 1;
-            grantor_offset = 0;
+            grantor->fd_index = 1;
+            grantor->offset = 0;
         } else {
-            grantor_fd_index = 0;
-            grantor_offset = offset;
+            offset = GBINDER_FMQ_ALIGN(offset, align);
+            grantor->fd_index = 0;
+            grantor->offset = (guint32)offset;
             offset += mem_sizes[pos];
         }
-        grantor->fd_index = grantor_fd_index;
-        grantor->offset = (guint32)G_ALIGN8(grantor_offset);
         grantor->extent = mem_sizes[pos];
     }
+
+    /* Total size of the memory referenced by fd_index 0 */
+    *shmem_size = GBINDER_FMQ_ALIGN(offset, getpagesize());
     return grantors;
 }
 
@@ -210,9 +295,9 @@ gbinder_fmq_free(
 {
     if (self->desc) {
         if (self->desc->flags == GBINDER_FMQ_TYPE_UNSYNC_WRITE) {
-            g_free(self->read_ptr);
+            g_free(self->reader.read_ptr);
         } else {
-            gbinder_fmq_unmap_grantor_descriptor(self, self->read_ptr,
+            gbinder_fmq_unmap_grantor_descriptor(self, self->reader.read_ptr,
                 READ_PTR_POS);
         }
         gbinder_fmq_unmap_grantor_descriptor(self, self->write_ptr,
@@ -264,33 +349,23 @@ gbinder_fmq_new(
         GBinderFmq* self = g_slice_new0(GBinderFmq);
         gboolean configure_event_flag =
             (flags & GBINDER_FMQ_FLAG_CONFIGURE_EVENT_FLAG) != 0;
-        gsize queue_size_bytes = num_items * item_size;
-        gsize meta_data_size;
+        const gsize queue_size_bytes = num_items * item_size;
+        const gsize num_fds = (fd != -1) ? 2 : 1;
         gsize shmem_size;
+        GBinderFmqGrantorDescriptor* grantors =
+            gbinder_fmq_create_grantors(queue_size_bytes, num_fds,
+                configure_event_flag, (flags &
+                    GBINDER_FMQ_FLAG_CACHE_LINE_ALIGN) ?
+                    GBINDER_FMQ_CACHE_LINE_SIZE : 8, &shmem_size);
         int shmem_fd;
 
-        meta_data_size = 2 * sizeof(guint64);
-        if (configure_event_flag) {
-            meta_data_size += sizeof(guint32);
-        }
-
-        /* Allocate shared memory */
-        if (fd != -1) {
-            /* User-supplied ringbuffer memory provided,
-             * allocating memory only for meta data */
-            shmem_size = (meta_data_size + getpagesize() - 1) &
-                ~(getpagesize() - 1);
-        } else {
-            /* Allocate ringbuffer, read counter and write counter */
-            shmem_size = (G_ALIGN8(queue_size_bytes) +
-                meta_data_size + getpagesize() - 1) & ~(getpagesize() - 1);
-        }
-
+        /*
+         * Allocate shared memory for read counter, write counter and
+         * the event flag. Unless user-supplied ringbuffer memory is
+         * provided, the ring buffer goes there too.
+         */
         shmem_fd = syscall(__NR_memfd_create, "MessageQueue", MFD_CLOEXEC);
-
         if (shmem_fd >= 0 && ftruncate(shmem_fd, shmem_size) == 0) {
-            GBinderFmqGrantorDescriptor* grantors;
-            gsize num_fds = (fd != -1) ? 2 : 1;
             gsize fds_size = sizeof(GBinderFds) + sizeof(int) * num_fds;
             GBinderFds* fds = (GBinderFds*)g_malloc0(fds_size);
 
@@ -303,8 +378,6 @@ gbinder_fmq_new(
                 /* Use user-supplied file descriptor for fd_index 1 */
                 (((int*)((fds) + 1))[1]) = fd;
             }
-            grantors = gbinder_fmq_create_grantors(queue_size_bytes,
-                num_fds, configure_event_flag);
 
             /* Fill FMQ descriptor */
             self->desc = g_new0(GBinderMQDescriptor, 1);
@@ -318,17 +391,17 @@ gbinder_fmq_new(
 
             /* Initialize memory pointers */
             if (type == GBINDER_FMQ_TYPE_SYNC_READ_WRITE) {
-                self->read_ptr = gbinder_fmq_map_grantor_descriptor(self,
+                self->reader.read_ptr = gbinder_fmq_map_grantor_descriptor(self,
                     READ_PTR_POS);
             } else {
                 /*
                  * Unsynchronized write FMQs may have multiple readers and
                  * each reader would have their own read pointer counter.
                  */
-                self->read_ptr = g_new0(guint64, 1);
+                self->reader.read_ptr = g_new0(guint64, 1);
             }
 
-            if (!self->read_ptr) {
+            if (!self->reader.read_ptr) {
                 GWARN("Read pointer is null");
             }
 
@@ -339,11 +412,11 @@ gbinder_fmq_new(
             }
 
             if (!(flags & GBINDER_FMQ_FLAG_NO_RESET_POINTERS)) {
-                __atomic_store_n(self->read_ptr, 0, __ATOMIC_RELEASE);
+                __atomic_store_n(self->reader.read_ptr, 0, __ATOMIC_RELEASE);
                 __atomic_store_n(self->write_ptr, 0, __ATOMIC_RELEASE);
             } else if (type != GBINDER_FMQ_TYPE_SYNC_READ_WRITE) {
                 /* Always reset the read pointer */
-                __atomic_store_n(self->read_ptr, 0, __ATOMIC_RELEASE);
+                __atomic_store_n(self->reader.read_ptr, 0, __ATOMIC_RELEASE);
             }
 
             self->ring = gbinder_fmq_map_grantor_descriptor(self,
@@ -360,11 +433,19 @@ gbinder_fmq_new(
                 }
             }
 
+            if (flags & GBINDER_FMQ_FLAG_SPIN_WAIT) {
+                self->read_spin = self->write_spin = GBINDER_FMQ_SPIN_INIT;
+            }
+
             g_atomic_int_set(&self->refcount, 1);
             return self;
         }
 
         GWARN("Failed to allocate shared memory: %s", strerror(errno));
+        if (shmem_fd >= 0) {
+            close(shmem_fd);
+        }
+        g_free(grantors);
         gbinder_fmq_free(self);
     }
 
@@ -426,42 +507,203 @@ gbinder_fmq_available_to_write_contiguous(
         self->desc->quantum) : 0;
 }
 
-const void*
-gbinder_fmq_begin_read(
+static
+void
+gbinder_fmq_tx_init(
     GBinderFmq* self,
-    gsize items)
+    guint64 ptr,
+    gsize bytes,
+    GBinderFmqTx* tx)
 {
-    void* ptr = NULL;
+    const gsize size = gbinder_fmq_get_grantor_descriptor(self,
+        DATA_PTR_POS)->extent;
+    const gsize item_size = self->desc->quantum;
+    const gsize offset = ptr % size;
+    const gsize first = MIN(bytes, size - offset);
+
+    /* The ring size is a multiple of the item size */
+    tx->first.data = self->ring + offset;
+    tx->first.items = first / item_size;
+    if (first < bytes) {
+        tx->second.data = self->ring;
+        tx->second.items = (bytes - first) / item_size;
+    } else {
+        tx->second.data = NULL;
+        tx->second.items = 0;
+    }
+}
 
-    if (G_LIKELY(self) && G_LIKELY(items > 0)) {
+static
+void
+gbinder_fmq_iov_copy(
+    const struct iovec* dest,
+    guint dest_count,
+    const struct iovec* src,
+    guint src_count)
+{
+    gsize dest_off = 0, src_off = 0;
+
+    /* The caller makes sure that the total sizes match */
+    while (dest_count && src_count) {
+        const gsize n = MIN(dest->iov_len - dest_off, src->iov_len - src_off);
+
+        memcpy((guint8*)dest->iov_base + dest_off,
+            (const guint8*)src->iov_base + src_off, n);
+        dest_off += n;
+        src_off += n;
+        if (dest_off == dest->iov_len) {
+            dest++;
+            dest_count--;
+            dest_off = 0;
+        }
+        if (src_off == src->iov_len) {
+            src++;
+            src_count--;
+            src_off = 0;
+        }
+    }
+}
+
+static
+void
+gbinder_fmq_tx_to_iov(
+    const GBinderFmqTx* tx,
+    gsize item_size,
+    struct iovec* iov)
+{
+    iov[0].iov_base = tx->first.data;
+    iov[0].iov_len = tx->first.items * item_size;
+    iov[1].iov_base = tx->second.data;
+    iov[1].iov_len = tx->second.items * item_size;
+}
+
+/* Returns the number of items or zero if the vector is unusable */
+static
+gsize
+gbinder_fmq_iov_items(
+    GBinderFmq* self,
+    const struct iovec* iov,
+    guint count)
+{
+    const gsize item_size = self->desc->quantum;
+    gsize total = 0;
+    guint i;
+
+    if (!iov) {
+        return 0;
+    }
+    for (i = 0; i < count; i++) {
+        if (iov[i].iov_len > G_MAXSIZE - total ||
+            (iov[i].iov_len && !iov[i].iov_base)) {
+            return 0;
+        }
+        total += iov[i].iov_len;
+    }
+    if (total % item_size) {
+        GWARN("Vector size %" G_GSIZE_FORMAT " is not a multiple of item "
+            "size %" G_GSIZE_FORMAT, total, item_size);
+        return 0;
+    }
+    return total / item_size;
+}
+
+static
+gboolean
+gbinder_fmq_state_begin_read(
+    GBinderFmq* self,
+    GBinderFmqReadState* state,
+    gsize items,
+    GBinderFmqTx* tx)
+{
+    if (G_LIKELY(tx) && G_LIKELY(items > 0)) {
         gsize size = gbinder_fmq_get_grantor_descriptor(self,
             DATA_PTR_POS)->extent;
         gsize item_size = self->desc->quantum;
-        gsize bytes_desired = items * item_size;
         guint64 write_ptr = __atomic_load_n(self->write_ptr, __ATOMIC_ACQUIRE);
-        guint64 read_ptr = __atomic_load_n(self->read_ptr, __ATOMIC_RELAXED);
+        guint64 read_ptr = __atomic_load_n(state->read_ptr, __ATOMIC_RELAXED);
 
         if ((write_ptr % item_size) || (read_ptr % item_size)) {
             GWARN("Unable to write data because of misaligned pointer");
         } else if (write_ptr - read_ptr > size) {
-            __atomic_store_n(self->read_ptr, write_ptr, __ATOMIC_RELEASE);
-        } else if (write_ptr - read_ptr < bytes_desired) {
+            gbinder_fmq_state_resync(self, state, read_ptr, write_ptr);
+        } else if (items > size / item_size ||
+            write_ptr - read_ptr < items * item_size) {
             /* Not enough data to read in FMQ. */
         } else {
-            ptr = self->ring + (read_ptr % size);
+            gbinder_fmq_tx_init(self, read_ptr, items * item_size, tx);
+            return TRUE;
         }
     }
-
-    return ptr;
+    return FALSE;
 }
 
-void*
-gbinder_fmq_begin_write(
+/* Returns FALSE if the data has been overwritten while being read */
+static
+gboolean
+gbinder_fmq_state_end_read(
     GBinderFmq* self,
+    GBinderFmqReadState* state,
     gsize items)
 {
-    void* ptr = NULL;
-    if (G_LIKELY(self) && G_LIKELY(items > 0)) {
+    if (G_LIKELY(items > 0)) {
+        gsize size = gbinder_fmq_get_grantor_descriptor(self,
+            DATA_PTR_POS)->extent;
+        guint64 read_ptr = __atomic_load_n(state->read_ptr, __ATOMIC_RELAXED);
+        guint64 write_ptr = __atomic_load_n(self->write_ptr, __ATOMIC_ACQUIRE);
+
+        /*
+         * If queue type is unsynchronized, it is possible that a write
+         * overflow may have occurred.
+         */
+        if (write_ptr - read_ptr > size) {
+            gbinder_fmq_state_resync(self, state, read_ptr, write_ptr);
+            return FALSE;
+        } else {
+            read_ptr += items * self->desc->quantum;
+            __atomic_store_n(state->read_ptr, read_ptr, __ATOMIC_RELEASE);
+        }
+    }
+    return TRUE;
+}
+
+static
+gboolean
+gbinder_fmq_state_readv(
+    GBinderFmq* self,
+    GBinderFmqReadState* state,
+    const struct iovec* iov,
+    guint count)
+{
+    const gsize items = gbinder_fmq_iov_items(self, iov, count);
+    GBinderFmqTx tx;
+
+    if (gbinder_fmq_state_begin_read(self, state, items, &tx)) {
+        struct iovec ring[2];
+
+        gbinder_fmq_tx_to_iov(&tx, self->desc->quantum, ring);
+        gbinder_fmq_iov_copy(iov, count, ring, G_N_ELEMENTS(ring));
+        return gbinder_fmq_state_end_read(self, state, items);
+    }
+    return FALSE;
+}
+
+gboolean
+gbinder_fmq_begin_read_tx(
+    GBinderFmq* self,
+    gsize items,
+    GBinderFmqTx* tx) /* Since 1.1.43 */
+{
+    return G_LIKELY(self) &&
+        gbinder_fmq_state_begin_read(self, &self->reader, items, tx);
+}
+
+gboolean
+gbinder_fmq_begin_write_tx(
+    GBinderFmq* self,
+    gsize items,
+    GBinderFmqTx* tx) /* Since 1.1.43 */
+{
+    if (G_LIKELY(self) && G_LIKELY(tx) && G_LIKELY(items > 0)) {
         const gsize item_size = self->desc->quantum;
         const gsize size = gbinder_fmq_get_grantor_descriptor(self,
             DATA_PTR_POS)->extent;
@@ -477,12 +719,32 @@ gbinder_fmq_begin_write(
             if (write_ptr % item_size) {
                 GWARN("The write pointer has become misaligned.");
             } else {
-
-                ptr = self->ring + (write_ptr % size);
+                gbinder_fmq_tx_init(self, write_ptr, items * item_size, tx);
+                return TRUE;
             }
         }
     }
-    return ptr;
+    return FALSE;
+}
+
+const void*
+gbinder_fmq_begin_read(
+    GBinderFmq* self,
+    gsize items)
+{
+    GBinderFmqTx tx;
+
+    return gbinder_fmq_begin_read_tx(self, items, &tx) ? tx.first.data : NULL;
+}
+
+void*
+gbinder_fmq_begin_write(
+    GBinderFmq* self,
+    gsize items)
+{
+    GBinderFmqTx tx;
+
+    return gbinder_fmq_begin_write_tx(self, items, &tx) ? tx.first.data : NULL;
 }
 
 void
@@ -490,22 +752,8 @@ gbinder_fmq_end_read(
     GBinderFmq* self,
     gsize items)
 {
-    if (G_LIKELY(self) && G_LIKELY(items > 0)) {
-        gsize size = gbinder_fmq_get_grantor_descriptor(self,
-            DATA_PTR_POS)->extent;
-        guint64 read_ptr = __atomic_load_n(self->read_ptr, __ATOMIC_RELAXED);
-        guint64 write_ptr = __atomic_load_n(self->write_ptr, __ATOMIC_ACQUIRE);
-
-        /*
-         * If queue type is unsynchronized, it is possible that a write
-         * overflow may have occurred.
-         */
-        if (write_ptr - read_ptr > size) {
-            __atomic_store_n(self->read_ptr, write_ptr, __ATOMIC_RELEASE);
-        } else {
-            read_ptr += items * self->desc->quantum;
-            __atomic_store_n(self->read_ptr, read_ptr, __ATOMIC_RELEASE);
-        }
+    if (G_LIKELY(self)) {
+        gbinder_fmq_state_end_read(self, &self->reader, items);
     }
 }
 
@@ -528,31 +776,13 @@ gbinder_fmq_read(
     void* data,
     gsize items)
 {
-    if (G_LIKELY(self) && G_LIKELY(data) && G_LIKELY(items > 0)) {
-        const void* in_data = gbinder_fmq_begin_read(self, items);
+    if (G_LIKELY(self) && G_LIKELY(data) && G_LIKELY(items > 0) &&
+        items <= G_MAXSIZE / self->desc->quantum) {
+        struct iovec iov;
 
-        if (in_data) {
-            /*
-             * The number of messages that can be read contiguously without
-             * wrapping around the ring buffer.
-             */
-            const gsize contiguous_messages =
-                gbinder_fmq_available_to_read_contiguous(self);
-            const gsize item_size = self->desc->quantum;
-
-            if (contiguous_messages < items) {
-                /* A wrap around is required */
-                memcpy(data, in_data, contiguous_messages * item_size);
-                memcpy((char*)data + contiguous_messages * item_size,
-                    self->ring, (items - contiguous_messages) * item_size);
-            } else {
-                /* A wrap around is not required */
-                memcpy(data, in_data, items * item_size);
-            }
-
-            gbinder_fmq_end_read(self, items);
-            return TRUE;
-        }
+        iov.iov_base = data;
+        iov.iov_len = items * self->desc->quantum;
+        return gbinder_fmq_readv(self, &iov, 1);
     }
     return FALSE;
 }
@@ -563,29 +793,42 @@ gbinder_fmq_write(
     const void* data,
     gsize items)
 {
-    if (G_LIKELY(self) && G_LIKELY(data) && G_LIKELY(items > 0)) {
-        void *out_data = gbinder_fmq_begin_write(self, items);
+    if (G_LIKELY(self) && G_LIKELY(data) && G_LIKELY(items > 0) &&
+        items <= G_MAXSIZE / self->desc->quantum) {
+        struct iovec iov;
 
-        if (out_data) {
-            /*
-             * The number of messages that can be written contiguously without
-             * wrapping around the ring buffer.
-             */
-            const gsize contiguous_messages =
-                gbinder_fmq_available_to_write_contiguous(self);
-            const gsize item_size = self->desc->quantum;
-
-            if (contiguous_messages < items) {
-                /* A wrap around is required. */
-                memcpy(out_data, data, contiguous_messages * item_size);
-                memcpy(self->ring, (char *)data + contiguous_messages *
-                    item_size / sizeof(char),
-                    (items - contiguous_messages) * item_size);
-            } else {
-                /* A wrap around is not required to write items */
-                memcpy(out_data, data, items * item_size);
-            }
+        iov.iov_base = (void*)data;
+        iov.iov_len = items * self->desc->quantum;
+        return gbinder_fmq_writev(self, &iov, 1);
+    }
+    return FALSE;
+}
+
+gboolean
+gbinder_fmq_readv(
+    GBinderFmq* self,
+    const struct iovec* iov,
+    guint count) /* Since 1.1.43 */
+{
+    return G_LIKELY(self) &&
+        gbinder_fmq_state_readv(self, &self->reader, iov, count);
+}
 
+gboolean
+gbinder_fmq_writev(
+    GBinderFmq* self,
+    const struct iovec* iov,
+    guint count) /* Since 1.1.43 */
+{
+    if (G_LIKELY(self)) {
+        const gsize items = gbinder_fmq_iov_items(self, iov, count);
+        GBinderFmqTx tx;
+
+        if (gbinder_fmq_begin_write_tx(self, items, &tx)) {
+            struct iovec ring[2];
+
+            gbinder_fmq_tx_to_iov(&tx, self->desc->quantum, ring);
+            gbinder_fmq_iov_copy(ring, G_N_ELEMENTS(ring), iov, count);
             gbinder_fmq_end_write(self, items);
             return TRUE;
         }
@@ -686,6 +929,264 @@ gbinder_fmq_wake(
     return ret;
 }
 
+void
+gbinder_fmq_get_overruns(
+    GBinderFmq* self,
+    GBinderFmqOverruns* overruns) /* Since 1.1.43 */
+{
+    if (G_LIKELY(overruns)) {
+        if (G_LIKELY(self)) {
+            gbinder_fmq_state_overruns(&self->reader, overruns);
+        } else {
+            memset(overruns, 0, sizeof(*overruns));
+        }
+    }
+}
+
+GBinderFmqReader*
+gbinder_fmq_reader_new(
+    GBinderFmq* fmq) /* Since 1.1.43 */
+{
+    if (G_LIKELY(fmq) && G_LIKELY(fmq->write_ptr)) {
+        if (fmq->desc->flags == GBINDER_FMQ_TYPE_UNSYNC_WRITE) {
+            GBinderFmqReader* self = g_slice_new0(GBinderFmqReader);
+
+            /* Only the data written from now on is visible to the reader */
+            self->fmq = gbinder_fmq_ref(fmq);
+            self->state.read_ptr = &self->read_ptr;
+            self->read_ptr = __atomic_load_n(fmq->write_ptr,
+                __ATOMIC_ACQUIRE);
+            return self;
+        } else {
+            GWARN("Synchronized queue can only have one reader");
+        }
+    }
+    return NULL;
+}
+
+void
+gbinder_fmq_reader_free(
+    GBinderFmqReader* self) /* Since 1.1.43 */
+{
+    if (G_LIKELY(self)) {
+        gbinder_fmq_unref(self->fmq);
+        g_slice_free(GBinderFmqReader, self);
+    }
+}
+
+gsize
+gbinder_fmq_reader_available(
+    GBinderFmqReader* self) /* Since 1.1.43 */
+{
+    if (G_LIKELY(self)) {
+        GBinderFmq* fmq = self->fmq;
+
+        return gbinder_fmq_state_available_bytes(fmq, &self->state, FALSE) /
+            fmq->desc->quantum;
+    }
+    return 0;
+}
+
+gboolean
+gbinder_fmq_reader_begin_tx(
+    GBinderFmqReader* self,
+    gsize items,
+    GBinderFmqTx* tx) /* Since 1.1.43 */
+{
+    return G_LIKELY(self) &&
+        gbinder_fmq_state_begin_read(self->fmq, &self->state, items, tx);
+}
+
+gboolean
+gbinder_fmq_reader_end_read(
+    GBinderFmqReader* self,
+    gsize items) /* Since 1.1.43 */
+{
+    return G_LIKELY(self) &&
+        gbinder_fmq_state_end_read(self->fmq, &self->state, items);
+}
+
+gboolean
+gbinder_fmq_reader_read(
+    GBinderFmqReader* self,
+    void* data,
+    gsize items) /* Since 1.1.43 */
+{
+    if (G_LIKELY(self) && G_LIKELY(data) && G_LIKELY(items > 0)) {
+        GBinderFmq* fmq = self->fmq;
+
+        if (items <= G_MAXSIZE / fmq->desc->quantum) {
+            struct iovec iov;
+
+            iov.iov_base = data;
+            iov.iov_len = items * fmq->desc->quantum;
+            return gbinder_fmq_state_readv(fmq, &self->state, &iov, 1);
+        }
+    }
+    return FALSE;
+}
+
+void
+gbinder_fmq_reader_get_overruns(
+    GBinderFmqReader* self,
+    GBinderFmqOverruns* overruns) /* Since 1.1.43 */
+{
+    if (G_LIKELY(overruns)) {
+        if (G_LIKELY(self)) {
+            gbinder_fmq_state_overruns(&self->state, overruns);
+        } else {
+            memset(overruns, 0, sizeof(*overruns));
+        }
+    }
+}
+
+static
+gboolean
+gbinder_fmq_ready(
+    GBinderFmq* self,
+    gsize items,
+    gboolean read)
+{
+    return (read ? gbinder_fmq_available_to_read(self) :
+        gbinder_fmq_available_to_write(self)) >= items;
+}
+
+static
+gboolean
+gbinder_fmq_spin(
+    GBinderFmq* self,
+    gsize items,
+    gboolean read,
+    gint* spin)
+{
+    const gint limit = g_atomic_int_get(spin);
+
+    if (limit) {
+        gint i;
+
+        for (i = 0; i < limit; i++) {
+            if (gbinder_fmq_ready(self, items, read)) {
+                /* It paid off, may spin a bit longer next time */
+                if (limit < GBINDER_FMQ_SPIN_MAX) {
+                    g_atomic_int_set(spin, limit * 2);
+                }
+                return TRUE;
+            }
+            GBINDER_FMQ_CPU_RELAX();
+        }
+        if (limit > GBINDER_FMQ_SPIN_MIN) {
+            g_atomic_int_set(spin, limit / 2);
+        }
+    }
+    return FALSE;
+}
+
+static
+gboolean
+gbinder_fmq_transfer_blocking(
+    GBinderFmq* self,
+    void* data,
+    gsize items,
+    guint32 done_bit,
+    guint32 wait_bit,
+    int timeout_ms,
+    gboolean read)
+{
+    const gint64 deadline = (timeout_ms > 0) ?
+        (g_get_monotonic_time() + ((gint64)timeout_ms) * 1000) : 0;
+    gint* spin = read ? &self->read_spin : &self->write_spin;
+
+    for (;;) {
+        guint32 state;
+        int wait_ms, err;
+
+        if (read ? gbinder_fmq_read(self, data, items) :
+            gbinder_fmq_write(self, data, items)) {
+            /*
+             * gbinder_fmq_wake() only makes a syscall if the bit has been
+             * cleared, i.e. if the other side may be sleeping on it.
+             */
+            gbinder_fmq_wake(self, done_bit);
+            return TRUE;
+        } else if (gbinder_fmq_spin(self, items, read, spin)) {
+            continue;
+        } else if (timeout_ms > 0) {
+            const gint64 left = deadline - g_get_monotonic_time();
+
+            if (left <= 0) {
+                return FALSE;
+            }
+            wait_ms = (int)((left + 999) / 1000);
+        } else if (!timeout_ms) {
+            return FALSE;
+        } else {
+            wait_ms = -1;
+        }
+
+        err = gbinder_fmq_wait_timeout(self, wait_bit, &state, wait_ms);
+        if (err && err != -ETIMEDOUT && err != -EAGAIN && err != -EINTR) {
+            GWARN("FMQ wait failed: %s", strerror(-err));
+            return FALSE;
+        }
+    }
+}
+
+static
+gboolean
+gbinder_fmq_can_block(
+    GBinderFmq* self,
+    gsize items,
+    guint32 read_notification,
+    guint32 write_notification)
+{
+    if (G_LIKELY(self) && G_LIKELY(items > 0)) {
+        if (self->desc->flags != GBINDER_FMQ_TYPE_SYNC_READ_WRITE) {
+            GWARN("Blocking calls require a synchronized queue");
+        } else if (!self->event_flag_ptr) {
+            GWARN("Blocking calls require the event flag");
+        } else if (!read_notification || !write_notification) {
+            GWARN("Notification bits must be non-zero");
+        } else {
+            const gsize size = gbinder_fmq_get_grantor_descriptor(self,
+                DATA_PTR_POS)->extent;
+
+            /* Otherwise it would block forever */
+            return items <= size / self->desc->quantum;
+        }
+    }
+    return FALSE;
+}
+
+gboolean
+gbinder_fmq_read_blocking(
+    GBinderFmq* self,
+    void* data,
+    gsize items,
+    guint32 read_notification,
+    guint32 write_notification,
+    int timeout_ms) /* Since 1.1.43 */
+{
+    return G_LIKELY(data) && gbinder_fmq_can_block(self, items,
+        read_notification, write_notification) &&
+        gbinder_fmq_transfer_blocking(self, data, items,
+            read_notification, write_notification, timeout_ms, TRUE);
+}
+
+gboolean
+gbinder_fmq_write_blocking(
+    GBinderFmq* self,
+    const void* data,
+    gsize items,
+    guint32 read_notification,
+    guint32 write_notification,
+    int timeout_ms) /* Since 1.1.43 */
+{
+    return G_LIKELY(data) && gbinder_fmq_can_block(self, items,
+        read_notification, write_notification) &&
+        gbinder_fmq_transfer_blocking(self, (void*)data, items,
+            write_notification, read_notification, timeout_ms, FALSE);
+}
+
 #else /* !GBINDER_FMQ_SUPPORTED */
 #pragma message("Not compiling FMQ")
 #endif
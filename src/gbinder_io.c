@@ -300,7 +300,7 @@ GBINDER_IO_FN(fill_transaction_data)(
     const GByteArray* payload,
     guint tx_flags,
     GUtilIntArray* offsets,
-    void** offsets_buf)
+    GBinderIoOffsetsBuf* offsets_buf)
 {
     memset(tr, 0, sizeof(*tr));
     tr->target.handle = handle;
@@ -308,18 +308,27 @@ GBINDER_IO_FN(fill_transaction_data)(
     tr->data_size = payload->len;
     tr->data.ptr.buffer = (uintptr_t)payload->data;
     tr->flags = tx_flags;
+    offsets_buf->heap = NULL;
     if (offsets && offsets->count) {
-        guint i;
-        binder_size_t* tx_offsets = g_new(binder_size_t, offsets->count);
-
         tr->offsets_size = offsets->count * sizeof(binder_size_t);
-        tr->data.ptr.offsets = (uintptr_t)tx_offsets;
-        for (i = 0; i < offsets->count; i++) {
-            tx_offsets[i] = offsets->data[i];
+        if (sizeof(binder_size_t) == sizeof(offsets->data[0])) {
+            /* Same layout, the driver can read the array directly */
+            tr->data.ptr.offsets = (uintptr_t)offsets->data;
+        } else {
+            guint i;
+            binder_size_t* tx_offsets;
+
+            if (tr->offsets_size <= sizeof(offsets_buf->data)) {
+                tx_offsets = (binder_size_t*)offsets_buf->data;
+            } else {
+                tx_offsets = g_new(binder_size_t, offsets->count);
+                offsets_buf->heap = tx_offsets;
+            }
+            for (i = 0; i < offsets->count; i++) {
+                tx_offsets[i] = offsets->data[i];
+            }
+            tr->data.ptr.offsets = (uintptr_t)tx_offsets;
         }
-        *offsets_buf = tx_offsets;
-    } else {
-        *offsets_buf = NULL;
     }
 }
 
@@ -333,7 +342,7 @@ GBINDER_IO_FN(encode_transaction)(
     const GByteArray* payload,
     guint flags,
     GUtilIntArray* offsets,
-    void** offsets_buf)
+    GBinderIoOffsetsBuf* offsets_buf)
 {
     struct binder_transaction_data* tr = out;
 
@@ -353,7 +362,7 @@ GBINDER_IO_FN(encode_transaction_sg)(
     const GByteArray* payload,
     guint flags,
     GUtilIntArray* offsets,
-    void** offsets_buf,
+    GBinderIoOffsetsBuf* offsets_buf,
     gsize buffers_size)
 {
     struct binder_transaction_data_sg* sg = out;
@@ -375,7 +384,7 @@ GBINDER_IO_FN(encode_reply)(
     guint32 code,
     const GByteArray* payload,
     GUtilIntArray* offsets,
-    void** offsets_buf)
+    GBinderIoOffsetsBuf* offsets_buf)
 {
     struct binder_transaction_data* tr = out;
 
@@ -393,7 +402,7 @@ GBINDER_IO_FN(encode_reply_sg)(
     guint32 code,
     const GByteArray* payload,
     GUtilIntArray* offsets,
-    void** offsets_buf,
+    GBinderIoOffsetsBuf* offsets_buf,
     gsize buffers_size)
 {
     struct binder_transaction_data_sg* sg = out;
@@ -467,7 +476,7 @@ GBINDER_IO_FN(decode_transaction_data)(
             }
 
             if (objcount > 0) {
-                tx->objects = g_new(void*, objcount + 1);
+                tx->objects = gbinder_buffer_objects_new(objcount);
                 for (i = 0; i < objcount; i++) {
                     tx->objects[i] = (guint8*)tx->data + offsets[i];
                 }
@@ -62,7 +62,18 @@ typedef struct gbinder_io_tx_data {
     void** objects;
 } GBinderIoTxData;
 
-/* Read buffer size (allocated on stack, shouldn't be too large) */
+/*
+ * Offsets of the objects passed to the driver along with the transaction
+ * data. Small arrays are stored inline, larger ones get allocated (and
+ * have to be deallocated by the caller).
+ */
+#define GBINDER_IO_INLINE_OFFSETS (8)
+typedef struct gbinder_io_offsets_buf {
+    void* heap;
+    guint64 data[GBINDER_IO_INLINE_OFFSETS];
+} GBinderIoOffsetsBuf;
+
+/* Minimum read buffer size */
 #define GBINDER_IO_READ_BUFFER_SIZE (128)
 
 /*
@@ -167,21 +178,22 @@ struct gbinder_io {
 #define GBINDER_MAX_BC_TRANSACTION_SIZE (64)
     guint (*encode_transaction)(void* out, guint32 handle, guint32 code,
         const GByteArray* data, guint flags /* See below */,
-        GUtilIntArray* offsets, void** offsets_buf);
+        GUtilIntArray* offsets, GBinderIoOffsetsBuf* offsets_buf);
 #define GBINDER_MAX_BC_TRANSACTION_SG_SIZE (72)
     guint (*encode_transaction_sg)(void* out, guint32 handle, guint32 code,
         const GByteArray* data, guint flags /* GBINDER_TX_FLAG_xxx */,
-        GUtilIntArray* offsets, void** offsets_buf,
+        GUtilIntArray* offsets, GBinderIoOffsetsBuf* offsets_buf,
         gsize buffers_size);
 
     /* Encode BC_REPLY/REPLY_SG data */
 #define GBINDER_MAX_BC_REPLY_SIZE GBINDER_MAX_BC_TRANSACTION_SIZE
     guint (*encode_reply)(void* out, guint32 handle, guint32 code,
-        const GByteArray* data, GUtilIntArray* offsets, void** offsets_buf);
+        const GByteArray* data, GUtilIntArray* offsets,
+        GBinderIoOffsetsBuf* offsets_buf);
 #define GBINDER_MAX_BC_REPLY_SG_SIZE GBINDER_MAX_BC_TRANSACTION_SG_SIZE
     guint (*encode_reply_sg)(void* out, guint32 handle, guint32 code,
-        const GByteArray* data, GUtilIntArray* offsets, void** offsets_buf,
-        gsize buffers_size);
+        const GByteArray* data, GUtilIntArray* offsets,
+        GBinderIoOffsetsBuf* offsets_buf, gsize buffers_size);
 
     /* Encode BC_REPLY */
     guint (*encode_status_reply)(void* out, gint32* status);
@@ -33,6 +33,7 @@
 #define _GNU_SOURCE  /* pthread_*_np */
 
 #include "gbinder_ipc.h"
+#include "gbinder_config.h"
 #include "gbinder_driver.h"
 #include "gbinder_handler.h"
 #include "gbinder_io.h"
@@ -50,33 +51,49 @@
 
 #include <gutil_macros.h>
 
+#include <stdio.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <poll.h>
+#include <sys/eventfd.h>
 #include <errno.h>
 #include <time.h>
 
 typedef struct gbinder_ipc_looper GBinderIpcLooper;
 typedef GObjectClass GBinderIpcClass;
 
+/*
+ * Object registries are split into shards, each one protected by its
+ * own mutex. Remote objects are distributed by handle, local ones by
+ * pointer. Lookups of different objects rarely contend with each other.
+ */
+#define GBINDER_IPC_REGISTRY_SHARDS (16) /* Must be a power of 2 */
+
+typedef struct gbinder_ipc_registry_shard {
+    GMutex mutex;
+    GHashTable* table;
+} GBinderIpcRegistryShard;
+
 struct gbinder_ipc_priv {
     GBinderIpc* self;
     GThreadPool* tx_pool;
+    GThreadPool* oneway_pool;
     GHashTable* tx_table;
     char* dev;
     char* key;
     const char* name;
     GBinderObjectRegistry object_registry;
 
-    GMutex remote_objects_mutex;
-    GHashTable* remote_objects;
-
-    GMutex local_objects_mutex;
-    GHashTable* local_objects;
+    GBinderIpcRegistryShard remote_objects[GBINDER_IPC_REGISTRY_SHARDS];
+    GBinderIpcRegistryShard local_objects[GBINDER_IPC_REGISTRY_SHARDS];
 
     GMutex looper_mutex;
     GBinderIpcLooper* primary_loopers;
     GBinderIpcLooper* blocked_loopers;
+    guint min_loopers;
+    guint max_loopers;
+    guint spawned_loopers_exited;
+    gboolean stopping_loopers;
 };
 
 #define PARENT_CLASS gbinder_ipc_parent_class
@@ -94,7 +111,10 @@ static GHashTable* gbinder_ipc_table = NULL;
 static pthread_mutex_t gbinder_ipc_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 #define GBINDER_IPC_MAX_TX_THREADS (15)
-#define GBINDER_IPC_MAX_PRIMARY_LOOPERS (5)
+#define GBINDER_IPC_MIN_LOOPERS (1)
+#define GBINDER_IPC_MAX_LOOPERS (5)
+#define GBINDER_IPC_LOOPERS_LIMIT (0xffff)
+#define GBINDER_IPC_LOOPER_IDLE_TIMEOUT_MS (30000)
 #define GBINDER_IPC_LOOPER_START_TIMEOUT_SEC (2)
 #define GBINDER_IPC_LOOPER_JOIN_TIMEOUT_MS (500)
 
@@ -103,15 +123,15 @@ static pthread_mutex_t gbinder_ipc_mutex = PTHREAD_MUTEX_INITIALIZER;
  *
  * 1. Finds the target object and allocates GBinderIpcLooperTx.
  * 2. Posts the GBinderIpcLooperTx reference to the main thread
- * 4. Waits for (any) byte from the receiving end of the tx pipe.
+ * 4. Waits for the tx eventfd to get signaled.
  *
  * When the main thread receives GBinderIpcLooperTx:
  *
  * 1. Lets the object to process it and produce the response (GBinderOutput).
- * 2. Writes one byte (TX_DONE) to the sending end of the tx pipe.
+ * 2. Adds TX_DONE to the tx eventfd counter.
  * 3. Unreferences GBinderIpcLooperTx
  *
- * When tx pipe wakes up the looper:
+ * When tx eventfd wakes up the looper:
  *
  * 1. Sends the transaction to the kernel.
  * 2. Unreferences GBinderIpcLooperTx
@@ -121,13 +141,16 @@ static pthread_mutex_t gbinder_ipc_mutex = PTHREAD_MUTEX_INITIALIZER;
  * before it gets processed.
  *
  * When transaction is blocked by gbinder_remote_request_block() call, it
- * gets slightly more complicated. Then the main thread writes TX_BLOCKED
- * to the pipe (rather than TX_DONE) and then looper thread spawn another
- * looper and keeps waiting for TX_DONE.
+ * gets slightly more complicated. Then the main thread signals TX_BLOCKED
+ * (rather than TX_DONE) and then looper thread spawn another looper and
+ * keeps waiting for TX_DONE.
+ *
+ * The eventfd counter accumulates the values, that's why these are bits.
+ * Each of them is signaled at most once per transaction.
  */
 
-#define TX_DONE (0x2a)
-#define TX_BLOCKED (0x3b)
+#define TX_BLOCKED (0x01)
+#define TX_DONE (0x02)
 
 typedef enum gbinder_ipc_looper_tx_state {
     GBINDER_IPC_LOOPER_TX_SCHEDULED,
@@ -142,7 +165,7 @@ struct gbinder_ipc_looper_tx {
     /* Reference count */
     gint refcount;
     /* These are filled by the looper: */
-    int pipefd[2];
+    int fd; /* eventfd */
     guint32 code;
     guint32 flags;
     GBinderLocalObject* obj;
@@ -160,21 +183,17 @@ struct gbinder_ipc_looper {
     GBinderHandler handler;
     GBinderDriver* driver;
     GBinderIpc* ipc; /* Not a reference! */
+    gboolean spawned; /* Requested by the kernel */
     pthread_t thread;
     GMutex mutex;
     GCond start_cond;
     gint exit;
     gint started;
     gint joined;
-    int pipefd[2];
-    int txfd[2];
+    int wakefd; /* eventfd */
+    int txfd; /* eventfd */
 };
 
-typedef struct gbinder_ipc_tx_handler {
-    int pipefd[2];
-    int txfd[2];
-} GBinderIpcTxHandler;
-
 typedef struct gbinder_ipc_tx_priv GBinderIpcTxPriv;
 
 typedef
@@ -212,7 +231,8 @@ typedef struct gbinder_ipc_tx_custom {
 static
 GBinderIpcLooper*
 gbinder_ipc_looper_new(
-    GBinderIpc* ipc);
+    GBinderIpc* ipc,
+    gboolean spawned);
 
 static
 GBinderRemoteReply*
@@ -235,31 +255,56 @@ gbinder_ipc_transact_sync_oneway_worker(
  * Utilities
  *==========================================================================*/
 
+static
+int
+gbinder_ipc_eventfd_new(
+    void)
+{
+    /* Note: this call can actually fail */
+    const int fd = eventfd(0, EFD_CLOEXEC);
+
+    if (fd < 0) {
+        GERR("Failed to create eventfd: %s", strerror(errno));
+    }
+    return fd;
+}
+
+static
+void
+gbinder_ipc_signal(
+    int fd,
+    guint64 value)
+{
+    if (write(fd, &value, sizeof(value)) != sizeof(value)) {
+        GWARN("Failed to signal eventfd: %s", strerror(errno));
+    }
+}
+
 static
 gboolean
 gbinder_ipc_wait(
     int fd_wakeup,
     int fd_read,
-    guint8* out)
+    guint64* out)
 {
     struct pollfd fds[2];
 
+    /* Negative fd_wakeup is ignored by poll() */
     memset(fds, 0, sizeof(fds));
     fds[0].fd = fd_wakeup;
     fds[0].events = POLLIN | POLLERR | POLLHUP | POLLNVAL;
     fds[1].fd = fd_read;
     fds[1].events = POLLIN | POLLERR | POLLHUP | POLLNVAL;
     if (poll(fds, 2, -1) < 0) {
-        GWARN("Transaction pipe polling error: %s", strerror(errno));
+        GWARN("Transaction eventfd polling error: %s", strerror(errno));
     } else if (fds[1].revents & POLLIN) {
-        const ssize_t n = read(fds[1].fd, out, 1);
+        guint64 value;
 
-        if (n == 1) {
+        if (read(fds[1].fd, &value, sizeof(value)) == sizeof(value)) {
+            *out |= value;
             return TRUE;
-        } else if (n < 0) {
-            GWARN("Transaction pipe read error: %s", strerror(errno));
         } else {
-            GWARN("Nothing was read from the transaction pipe");
+            GWARN("Transaction eventfd read error: %s", strerror(errno));
         }
     }
     return FALSE;
@@ -285,12 +330,12 @@ gbinder_ipc_looper_tx_new(
     guint32 code,
     guint32 flags,
     GBinderRemoteRequest* req,
-    const int* fd)
+    int fd)
 {
     GBinderIpcLooperTx* tx = g_slice_new0(GBinderIpcLooperTx);
 
     g_atomic_int_set(&tx->refcount, 1);
-    memcpy(tx->pipefd, fd, sizeof(tx->pipefd));
+    tx->fd = fd;
     tx->code = code;
     tx->flags = flags;
     tx->obj = gbinder_local_object_ref(obj);
@@ -303,9 +348,8 @@ void
 gbinder_ipc_looper_tx_free(
     GBinderIpcLooperTx* tx)
 {
-    if (tx->pipefd[0] >= 0) {
-        close(tx->pipefd[0]);
-        close(tx->pipefd[1]);
+    if (tx->fd >= 0) {
+        close(tx->fd);
     }
     gbinder_local_object_unref(tx->obj);
     gbinder_remote_request_unref(tx->req);
@@ -333,7 +377,7 @@ gbinder_ipc_looper_tx_unref(
     GASSERT(tx->refcount > 0);
     if (g_atomic_int_dec_and_test(&tx->refcount)) {
         if (dropfd) {
-            tx->pipefd[0] = tx->pipefd[1] = -1;
+            tx->fd = -1;
             dropped = TRUE;
         }
         gbinder_ipc_looper_tx_free(tx);
@@ -397,8 +441,6 @@ gbinder_remote_request_complete(
 
         GASSERT(tx);
         if (G_LIKELY(tx)) {
-            const guint8 done = TX_DONE;
-
             switch (tx->state) {
             case GBINDER_IPC_LOOPER_TX_BLOCKING:
                 /* Called by the transaction handler */
@@ -412,9 +454,7 @@ gbinder_remote_request_complete(
                 tx->reply = gbinder_local_reply_ref(reply);
                 tx->state = GBINDER_IPC_LOOPER_TX_COMPLETE;
                 /* Wake up the looper */
-                if (write(tx->pipefd[1], &done, sizeof(done)) <= 0) {
-                    GWARN("Failed to wake up the looper");
-                }
+                gbinder_ipc_signal(tx->fd, TX_DONE);
                 break;
             default:
                 GWARN("Unexpected state %d in request completion", tx->state);
@@ -440,11 +480,9 @@ gbinder_ipc_looper_free(
     if (!looper->joined && looper->thread != pthread_self()) {
         pthread_join(looper->thread, NULL);
     }
-    close(looper->pipefd[0]);
-    close(looper->pipefd[1]);
-    if (looper->txfd[0] >= 0) {
-        close(looper->txfd[0]);
-        close(looper->txfd[1]);
+    close(looper->wakefd);
+    if (looper->txfd >= 0) {
+        close(looper->txfd);
     }
     gbinder_driver_unref(looper->driver);
     g_free(looper->name);
@@ -483,7 +521,7 @@ gbinder_ipc_looper_tx_handle(
     GBinderRemoteRequest* req = tx->req;
     GBinderLocalReply* reply;
     int status = GBINDER_STATUS_OK;
-    guint8 done;
+    guint64 done;
 
     /*
      * Transaction reference for gbinder_remote_request_block()
@@ -546,9 +584,7 @@ gbinder_ipc_looper_tx_handle(
     }
 
     /* And wake up the looper */
-    if (write(tx->pipefd[1], &done, sizeof(done)) <= 0) {
-        GWARN("Failed to wake up the looper");
-    }
+    gbinder_ipc_signal(tx->fd, done);
 }
 
 static
@@ -627,15 +663,58 @@ gbinder_ipc_looper_remove_blocked(
 static
 guint
 gbinder_ipc_looper_count_primary(
-    GBinderIpcLooper* looper)
+    GBinderIpcPriv* priv)
 {
-    const GBinderIpcLooper* ptr = looper->ipc->priv->primary_loopers;
+    const GBinderIpcLooper* ptr = priv->primary_loopers;
     guint n = 0;
 
+    /* Caller holds looper_mutex */
     for (n = 0; ptr; ptr = ptr->next) n++;
     return n;
 }
 
+static
+void
+gbinder_ipc_looper_update_max_threads(
+    GBinderIpcPriv* priv)
+{
+    /*
+     * Caller holds looper_mutex. The kernel never forgets the loopers
+     * it has requested, even after they exit. The reaped ones have to
+     * be added back to its budget.
+     */
+    gbinder_driver_set_max_threads(priv->self->driver,
+        priv->max_loopers - priv->min_loopers +
+        priv->spawned_loopers_exited);
+}
+
+static
+gboolean
+gbinder_ipc_looper_reap(
+    GBinderIpcLooper* looper)
+{
+    GBinderIpcPriv* priv = looper->ipc->priv;
+    gboolean reap = FALSE;
+
+    /*
+     * The looper is removed from the list right here, under the same
+     * lock as the check. Otherwise two idle loopers could both decide
+     * to exit, dropping the number of loopers below the minimum.
+     */
+
+    /* Lock */
+    g_mutex_lock(&priv->looper_mutex);
+    if (gbinder_ipc_looper_count_primary(priv) > priv->min_loopers &&
+        gbinder_ipc_looper_remove_primary(looper)) {
+        priv->spawned_loopers_exited++;
+        gbinder_ipc_looper_update_max_threads(priv);
+        reap = TRUE;
+    }
+    g_mutex_unlock(&priv->looper_mutex);
+    /* Unlock */
+    return reap;
+}
+
 static
 gboolean
 gbinder_ipc_looper_can_loop(
@@ -646,6 +725,50 @@ gbinder_ipc_looper_can_loop(
     return !g_atomic_int_get(&looper->exit);
 }
 
+static
+void
+gbinder_ipc_looper_spawn(
+    GBinderHandler* handler)
+{
+    GBinderIpcLooper* looper = G_CAST(handler,GBinderIpcLooper,handler);
+    GBinderIpcPriv* priv = looper->ipc->priv;
+    GBinderIpcLooper* new_looper = NULL;
+    gboolean stopping;
+
+    /*
+     * The number of loopers spawned on the kernel's request is limited
+     * by BINDER_SET_MAX_THREADS. Refusing this request would make the
+     * kernel think that the looper is still on its way, so don't. It
+     * doesn't matter whether the looper which has received the request
+     * is about to exit, the new one is needed anyway.
+     */
+
+    /* Lock */
+    g_mutex_lock(&priv->looper_mutex);
+    stopping = priv->stopping_loopers;
+    if (!stopping) {
+        new_looper = gbinder_ipc_looper_new(priv->self, TRUE);
+        if (new_looper) {
+            new_looper->next = priv->primary_loopers;
+            priv->primary_loopers = new_looper;
+        }
+    }
+    g_mutex_unlock(&priv->looper_mutex);
+    /* Unlock */
+
+    if (!new_looper && !stopping) {
+        GBinderDriver* driver = looper->driver;
+
+        /*
+         * Let the kernel know that the requested looper has come
+         * and gone, otherwise it will never request another one.
+         */
+        GWARN("Failed to spawn looper for %s", looper->name);
+        gbinder_driver_register_looper(driver);
+        gbinder_driver_exit_looper(driver);
+    }
+}
+
 static
 GBinderLocalReply*
 gbinder_ipc_looper_transact(
@@ -661,15 +784,15 @@ gbinder_ipc_looper_transact(
     GBinderLocalReply* reply = NULL;
     int status = -EFAULT;
 
-    if (looper->txfd[0] < 0 && pipe(looper->txfd)) {
-        GERR("Failed to create a tx pipe: %s", strerror(errno));
+    if (looper->txfd < 0) {
+        looper->txfd = gbinder_ipc_eventfd_new();
     }
 
-    if (looper->txfd[0] >= 0) {
+    if (looper->txfd >= 0) {
         GBinderIpcLooperTx* tx = gbinder_ipc_looper_tx_new(obj, code, flags,
             req, looper->txfd);
         GBinderIpcPriv* priv = ipc->priv;
-        guint8 done = 0;
+        guint64 done = 0;
         gboolean was_blocked = FALSE;
         /* Let GBinderLocalObject handle the transaction on the main thread */
         GBinderEventLoopCallback* callback =
@@ -677,7 +800,7 @@ gbinder_ipc_looper_transact(
                 gbinder_ipc_looper_tx_ref(tx), gbinder_ipc_looper_tx_done);
 
         /* Wait for either transaction completion or looper shutdown */
-        if (gbinder_ipc_wait(looper->pipefd[0], tx->pipefd[0], &done) &&
+        if (gbinder_ipc_wait(looper->wakefd, tx->fd, &done) &&
             done == TX_BLOCKED) {
             /*
              * We are going to block this looper for potentially
@@ -701,7 +824,7 @@ gbinder_ipc_looper_transact(
 
                 /* If there's no more primary loopers left, create one */
                 if (!priv->primary_loopers) {
-                    new_looper = gbinder_ipc_looper_new(ipc);
+                    new_looper = gbinder_ipc_looper_new(ipc, FALSE);
                     if (new_looper) {
                         /* Will unref it after it gets started */
                         gbinder_ipc_looper_ref(new_looper);
@@ -719,15 +842,13 @@ gbinder_ipc_looper_transact(
             }
 
             /* Block until asynchronous transaction gets completed. */
-            done = 0;
-            if (gbinder_ipc_wait(looper->pipefd[0], tx->pipefd[0], &done)) {
+            if (gbinder_ipc_wait(looper->wakefd, tx->fd, &done)) {
                 GVERBOSE("Looper %s is released", looper->name);
-                GASSERT(done == TX_DONE);
+                GASSERT(done & TX_DONE);
             }
         }
 
-        if (done) {
-            GASSERT(done == TX_DONE);
+        if (done & TX_DONE) {
             reply = gbinder_local_reply_ref(tx->reply);
             status = tx->status;
         }
@@ -736,10 +857,10 @@ gbinder_ipc_looper_transact(
             /*
              * This wasn't the last reference meaning that
              * gbinder_ipc_looper_tx_free() will close the
-             * descriptors and we will have to create a new
-             * pipe for the next transaction.
+             * descriptor and we will have to create a new
+             * eventfd for the next transaction.
              */
-            looper->txfd[0] = looper->txfd[1] = -1;
+            looper->txfd = -1;
         }
 
         gbinder_idle_callback_destroy(callback);
@@ -748,8 +869,8 @@ gbinder_ipc_looper_transact(
             guint n;
 
             g_mutex_lock(&priv->looper_mutex);
-            n = gbinder_ipc_looper_count_primary(looper);
-            if (n >= GBINDER_IPC_MAX_PRIMARY_LOOPERS) {
+            n = gbinder_ipc_looper_count_primary(priv);
+            if (n >= priv->max_loopers) {
                 /* Looper will exit once transaction completes */
                 GDEBUG("Too many primary loopers (%u)", n);
                 g_atomic_int_set(&looper->exit, 1);
@@ -773,11 +894,15 @@ gbinder_ipc_looper_thread(
 {
     GBinderIpcLooper* looper = data;
     GBinderDriver* driver = looper->driver;
+    const int timeout = looper->spawned ?
+        GBINDER_IPC_LOOPER_IDLE_TIMEOUT_MS : -1;
 
     g_mutex_lock(&looper->mutex);
     pthread_setname_np(looper->thread, looper->name);
-    if (gbinder_driver_enter_looper(driver)) {
-        struct pollfd pipefd;
+    if (looper->spawned ? gbinder_driver_register_looper(driver) :
+        gbinder_driver_enter_looper(driver)) {
+        struct pollfd wakefd;
+        gboolean reaped = FALSE;
         int res;
 
         GDEBUG("Looper %s running", looper->name);
@@ -785,11 +910,11 @@ gbinder_ipc_looper_thread(
         g_cond_broadcast(&looper->start_cond);
         g_mutex_unlock(&looper->mutex);
 
-        memset(&pipefd, 0, sizeof(pipefd));
-        pipefd.fd = looper->pipefd[0]; /* read end of the pipe */
-        pipefd.events = POLLIN | POLLERR | POLLHUP | POLLNVAL;
+        memset(&wakefd, 0, sizeof(wakefd));
+        wakefd.fd = looper->wakefd;
+        wakefd.events = POLLIN | POLLERR | POLLHUP | POLLNVAL;
 
-        res = gbinder_driver_poll(driver, &pipefd);
+        res = gbinder_driver_poll_timeout(driver, &wakefd, timeout);
         while (!g_atomic_int_get(&looper->exit) && ((res & POLLIN) || !res)) {
             if (res & POLLIN) {
                 /*
@@ -810,12 +935,18 @@ gbinder_ipc_looper_thread(
                     break;
                 }
             }
-            /* Any event from this pipe terminates the loop */
-            if (pipefd.revents || g_atomic_int_get(&looper->exit)) {
+            /* Any event from this eventfd terminates the loop */
+            if (wakefd.revents || g_atomic_int_get(&looper->exit)) {
                 GDEBUG("Looper %s is requested to exit", looper->name);
                 break;
             }
-            res = gbinder_driver_poll(driver, &pipefd);
+            /* Spawned loopers go away after being idle for a while */
+            if (!res && looper->spawned && gbinder_ipc_looper_reap(looper)) {
+                GDEBUG("Looper %s is idle", looper->name);
+                reaped = TRUE;
+                break;
+            }
+            res = gbinder_driver_poll_timeout(driver, &wakefd, timeout);
         }
 
         gbinder_driver_exit_looper(driver);
@@ -830,10 +961,16 @@ gbinder_ipc_looper_thread(
 
             /* Lock */
             g_mutex_lock(&priv->looper_mutex);
-            if (gbinder_ipc_looper_remove_blocked(looper) ||
+            if (reaped ||
+                gbinder_ipc_looper_remove_blocked(looper) ||
                 gbinder_ipc_looper_remove_primary(looper)) {
                 /* Spontaneous exit */
                 GDEBUG("Looper %s exits", looper->name);
+                if (looper->spawned && !reaped) {
+                    /* gbinder_ipc_looper_reap() has done this already */
+                    priv->spawned_loopers_exited++;
+                    gbinder_ipc_looper_update_max_threads(priv);
+                }
                 gbinder_ipc_looper_unref(looper);
             } else {
                 /* Main thread is shutting it down */
@@ -857,22 +994,23 @@ gbinder_ipc_looper_thread(
 static
 GBinderIpcLooper*
 gbinder_ipc_looper_new(
-    GBinderIpc* ipc)
+    GBinderIpc* ipc,
+    gboolean spawned)
 {
-    int fd[2];
+    const int fd = gbinder_ipc_eventfd_new();
 
-    /* Note: this call can actually fail */
-    if (!pipe(fd)) {
+    if (fd >= 0) {
         static const GBinderHandlerFunctions handler_functions = {
             .can_loop = gbinder_ipc_looper_can_loop,
-            .transact = gbinder_ipc_looper_transact
+            .transact = gbinder_ipc_looper_transact,
+            .spawn_looper = gbinder_ipc_looper_spawn
         };
         GBinderIpcLooper* looper = g_slice_new0(GBinderIpcLooper);
         static gint gbinder_ipc_next_looper_id = 1;
         guint id = (guint)g_atomic_int_add(&gbinder_ipc_next_looper_id, 1);
 
-        memcpy(looper->pipefd, fd, sizeof(fd));
-        looper->txfd[0] = looper->txfd[1] = -1;
+        looper->wakefd = fd;
+        looper->txfd = -1;
         g_atomic_int_set(&looper->refcount, 1);
         g_cond_init(&looper->start_cond);
         g_mutex_init(&looper->mutex);
@@ -880,6 +1018,7 @@ gbinder_ipc_looper_new(
         looper->name = g_strdup_printf("%s#%u", gbinder_ipc_name(ipc), id);
         looper->handler.f = &handler_functions;
         looper->ipc = ipc;
+        looper->spawned = spawned;
         looper->driver = gbinder_driver_ref(ipc->driver);
         if (!pthread_create(&looper->thread, NULL, gbinder_ipc_looper_thread,
             looper)) {
@@ -893,8 +1032,6 @@ gbinder_ipc_looper_new(
         }
         g_mutex_unlock(&looper->mutex);
         gbinder_ipc_looper_unref(looper);
-    } else {
-        GERR("Failed to create looper pipe: %s", strerror(errno));
     }
     return NULL;
 }
@@ -905,25 +1042,38 @@ gbinder_ipc_looper_check(
 {
     if (G_LIKELY(self)) {
         GBinderIpcPriv* priv = self->priv;
-        GBinderIpcLooper* new_looper = NULL;
+        GSList* new_loopers = NULL;
+        guint n;
 
         /* Lock */
         g_mutex_lock(&priv->looper_mutex);
-        if (!priv->primary_loopers) {
-            priv->primary_loopers = gbinder_ipc_looper_new(self);
-            new_looper = priv->primary_loopers;
-            if (new_looper) {
-                gbinder_ipc_looper_ref(new_looper);
+        n = gbinder_ipc_looper_count_primary(priv);
+        while (n < priv->min_loopers) {
+            GBinderIpcLooper* looper = gbinder_ipc_looper_new(self, FALSE);
+
+            if (looper) {
+                looper->next = priv->primary_loopers;
+                priv->primary_loopers = looper;
+                new_loopers = g_slist_prepend(new_loopers,
+                    gbinder_ipc_looper_ref(looper));
+                n++;
+            } else {
+                break;
             }
         }
         g_mutex_unlock(&priv->looper_mutex);
         /* Unlock */
 
         /* We are not ready to accept incoming transactions until
-         * looper has started. We may need to wait a bit. */
-        if (new_looper) {
-            gbinder_ipc_looper_start(new_looper);
-            gbinder_ipc_looper_unref(new_looper);
+         * loopers have started. We may need to wait a bit. */
+        if (new_loopers) {
+            GSList* l;
+
+            for (l = new_loopers; l; l = l->next) {
+                gbinder_ipc_looper_start(l->data);
+                gbinder_ipc_looper_unref(l->data);
+            }
+            g_slist_free(new_loopers);
         }
     }
 }
@@ -938,11 +1088,7 @@ gbinder_ipc_looper_stop(
         GDEBUG("Stopping looper %s", looper->name);
         g_atomic_int_set(&looper->exit, TRUE);
         if (looper->thread != pthread_self()) {
-            guint8 done = TX_DONE;
-
-            if (write(looper->pipefd[1], &done, sizeof(done)) <= 0) {
-                GWARN("Failed to stop looper %s", looper->name);
-            }
+            gbinder_ipc_signal(looper->wakefd, TX_DONE);
         }
     }
 }
@@ -1006,7 +1152,7 @@ gbinder_ipc_looper_join(
 }
 
 /*==========================================================================*
- * GBinderIpcTxHandler
+ * Transaction handler of the worker threads
  *
  * It's needed to handle the following scenario:
  *
@@ -1016,49 +1162,24 @@ gbinder_ipc_looper_join(
  *    receive a valid incoming transation.
  * 3. This transaction is handled by gbinder_ipc_tx_handler_transact.
  *
- * This seems to be quite a rare scenario, so we allocate a new
- * GBinderIpcTxHandler (and new pipes) for each such transaction,
- * to keep things as simple as possible.
+ * Each worker thread keeps its own eventfd for such transactions and
+ * only has to create a new one if the previous transaction has outlived
+ * the wait (and took the old descriptor with it).
  *
  *==========================================================================*/
 
-static
-GBinderIpcTxHandler*
-gbinder_ipc_tx_handler_new(
-    void)
-{
-    GBinderIpcTxHandler* h = g_slice_new0(GBinderIpcTxHandler);
-
-    /* Note: pipe() calls can actually fail */
-    if (!pipe(h->txfd)) {
-        if (!pipe(h->pipefd)) {
-            return h;
-        } else {
-            GERR("Failed to create a tx pipe: %s", strerror(errno));
-        }
-        close(h->txfd[0]);
-        close(h->txfd[1]);
-    } else {
-        GERR("Failed to create a tx pipe: %s", strerror(errno));
-    }
-    g_slice_free(GBinderIpcTxHandler, h);
-    return NULL;
-}
-
 static
 void
-gbinder_ipc_tx_handler_free(
-    GBinderIpcTxHandler* h)
+gbinder_ipc_tx_handler_fd_close(
+    gpointer data)
 {
-    close(h->pipefd[0]);
-    close(h->pipefd[1]);
-    if (h->txfd[0] >= 0) {
-        close(h->txfd[0]);
-        close(h->txfd[1]);
-    }
-    g_slice_free(GBinderIpcTxHandler, h);
+    close(GPOINTER_TO_INT(data) - 1);
 }
 
+/* The value is fd + 1 so that zero (NULL) means no descriptor */
+static GPrivate gbinder_ipc_tx_handler_fd =
+    G_PRIVATE_INIT(gbinder_ipc_tx_handler_fd_close);
+
 static
 GBinderLocalReply*
 gbinder_ipc_tx_handler_transact(
@@ -1069,31 +1190,35 @@ gbinder_ipc_tx_handler_transact(
     guint flags,
     int* result)
 {
-    GBinderIpcTxHandler* h = gbinder_ipc_tx_handler_new();
     GBinderLocalReply* reply = NULL;
     int status = -EFAULT;
+    int fd = GPOINTER_TO_INT(g_private_get(&gbinder_ipc_tx_handler_fd)) - 1;
 
-    if (h) {
+    if (fd < 0) {
+        fd = gbinder_ipc_eventfd_new();
+        if (fd >= 0) {
+            g_private_set(&gbinder_ipc_tx_handler_fd, GINT_TO_POINTER(fd + 1));
+        }
+    }
+
+    if (fd >= 0) {
         GBinderIpcLooperTx* tx = gbinder_ipc_looper_tx_new(obj, code, flags,
-            req, h->txfd);
-        guint8 done = 0;
+            req, fd);
+        guint64 done = 0;
         /* Handle transaction on the main thread */
         GBinderEventLoopCallback* callback =
             gbinder_idle_callback_schedule_new(gbinder_ipc_looper_tx_handle,
                 gbinder_ipc_looper_tx_ref(tx), gbinder_ipc_looper_tx_done);
 
         /* Wait for completion */
-        if (gbinder_ipc_wait(h->pipefd[0], tx->pipefd[0], &done) &&
-            done == TX_BLOCKED) {
+        if (gbinder_ipc_wait(-1, fd, &done) && done == TX_BLOCKED) {
             /* Block until asynchronous transaction gets completed. */
-            done = 0;
-            if (gbinder_ipc_wait(h->pipefd[0], tx->pipefd[0], &done)) {
-                GASSERT(done == TX_DONE);
+            if (gbinder_ipc_wait(-1, fd, &done)) {
+                GASSERT(done & TX_DONE);
             }
         }
 
-        if (done) {
-            GASSERT(done == TX_DONE);
+        if (done & TX_DONE) {
             reply = gbinder_local_reply_ref(tx->reply);
             status = tx->status;
         }
@@ -1102,14 +1227,14 @@ gbinder_ipc_tx_handler_transact(
             /*
              * This wasn't the last references meaning that
              * gbinder_ipc_looper_tx_free() will close the
-             * descriptors and we will have to create a new
-             * pipe for the next transaction.
+             * descriptor and we will have to create a new
+             * eventfd for the next transaction. Note that unlike
+             * g_private_replace(), g_private_set() doesn't close it.
              */
-            h->txfd[0] = h->txfd[1] = -1;
+            g_private_set(&gbinder_ipc_tx_handler_fd, NULL);
         }
 
         gbinder_idle_callback_destroy(callback);
-        gbinder_ipc_tx_handler_free(h);
     }
 
     *result = status;
@@ -1120,19 +1245,41 @@ gbinder_ipc_tx_handler_transact(
  * GBinderObjectRegistry
  *==========================================================================*/
 
+GBINDER_INLINE_FUNC
+GBinderIpcRegistryShard*
+gbinder_ipc_remote_shard(
+    GBinderIpcPriv* priv,
+    guint32 handle)
+{
+    return priv->remote_objects + (handle & (GBINDER_IPC_REGISTRY_SHARDS-1));
+}
+
+GBINDER_INLINE_FUNC
+GBinderIpcRegistryShard*
+gbinder_ipc_local_shard(
+    GBinderIpcPriv* priv,
+    gconstpointer pointer)
+{
+    /* Low bits are always zero because of alignment */
+    const gsize x = GPOINTER_TO_SIZE(pointer) >> 4;
+
+    return priv->local_objects + ((x ^ (x >> 8)) &
+        (GBINDER_IPC_REGISTRY_SHARDS-1));
+}
+
 static
 void
 gbinder_ipc_invalidate_local_object_locked(
     GBinderIpc* self,
+    GBinderIpcRegistryShard* shard,
     GBinderLocalObject* obj)
 {
-    GBinderIpcPriv* priv = self->priv;
-
-    if (priv->local_objects && g_hash_table_remove(priv->local_objects, obj)) {
+    /* Caller holds shard->mutex */
+    if (shard->table && g_hash_table_remove(shard->table, obj)) {
         GVERBOSE_("%p %s", obj, gbinder_ipc_name(self));
-        if (g_hash_table_size(priv->local_objects) == 0) {
-            g_hash_table_unref(priv->local_objects);
-            priv->local_objects = NULL;
+        if (g_hash_table_size(shard->table) == 0) {
+            g_hash_table_unref(shard->table);
+            shard->table = NULL;
         }
     }
 }
@@ -1141,22 +1288,21 @@ static
 void
 gbinder_ipc_invalidate_remote_handle_locked(
     GBinderIpc* self,
+    GBinderIpcRegistryShard* shard,
     guint32 handle)
 {
-    GBinderIpcPriv* priv = self->priv;
-
-    /* Caller holds priv->remote_objects_mutex */
-    if (priv->remote_objects) {
+    /* Caller holds shard->mutex */
+    if (shard->table) {
         const gpointer key = GINT_TO_POINTER(handle);
 #if GUTIL_LOG_VERBOSE
-        const gpointer obj = g_hash_table_lookup(priv->remote_objects, key);
+        const gpointer obj = g_hash_table_lookup(shard->table, key);
 #endif
 
-        if (g_hash_table_remove(priv->remote_objects, key)) {
+        if (g_hash_table_remove(shard->table, key)) {
             GVERBOSE_("handle %u %p %s", handle, obj, gbinder_ipc_name(self));
-            if (g_hash_table_size(priv->remote_objects) == 0) {
-                g_hash_table_unref(priv->remote_objects);
-                priv->remote_objects = NULL;
+            if (g_hash_table_size(shard->table) == 0) {
+                g_hash_table_unref(shard->table);
+                shard->table = NULL;
             }
         }
     }
@@ -1167,12 +1313,12 @@ gbinder_ipc_invalidate_local_object(
     GBinderIpc* self,
     GBinderLocalObject* obj)
 {
-    GBinderIpcPriv* priv = self->priv;
+    GBinderIpcRegistryShard* shard = gbinder_ipc_local_shard(self->priv, obj);
 
     /* Lock */
-    g_mutex_lock(&priv->local_objects_mutex);
-    gbinder_ipc_invalidate_local_object_locked(self, obj);
-    g_mutex_unlock(&priv->local_objects_mutex);
+    g_mutex_lock(&shard->mutex);
+    gbinder_ipc_invalidate_local_object_locked(self, shard, obj);
+    g_mutex_unlock(&shard->mutex);
     /* Unlock */
 }
 
@@ -1181,12 +1327,13 @@ gbinder_ipc_invalidate_remote_handle(
     GBinderIpc* self,
     guint32 handle)
 {
-    GBinderIpcPriv* priv = self->priv;
+    GBinderIpcRegistryShard* shard = gbinder_ipc_remote_shard(self->priv,
+        handle);
 
     /* Lock */
-    g_mutex_lock(&priv->remote_objects_mutex);
-    gbinder_ipc_invalidate_remote_handle_locked(self, handle);
-    g_mutex_unlock(&priv->remote_objects_mutex);
+    g_mutex_lock(&shard->mutex);
+    gbinder_ipc_invalidate_remote_handle_locked(self, shard, handle);
+    g_mutex_unlock(&shard->mutex);
     /* Unlock */
 }
 
@@ -1198,7 +1345,7 @@ gbinder_ipc_invalidate_remote_handle(
  *
  * 1. Last reference to GBinderObject goes away.
  * 2. gbinder_ipc_object_disposed() is invoked by gbinder_object_dispose()
- * 3. Before gbinder_ipc_object_disposed() grabs the lock,
+ * 3. Before gbinder_ipc_object_disposed() grabs the (shard) lock,
  *    gbinder_ipc_new_remote_object() gets there first, finds the
  *    object in the hashtable, bumps its refcount (under the lock)
  *    and returns new reference to the caller.
@@ -1215,14 +1362,14 @@ gbinder_ipc_local_object_disposed(
     GBinderIpc* self,
     GBinderLocalObject* obj)
 {
-    GBinderIpcPriv* priv = self->priv;
+    GBinderIpcRegistryShard* shard = gbinder_ipc_local_shard(self->priv, obj);
 
     /* Lock */
-    g_mutex_lock(&priv->local_objects_mutex);
+    g_mutex_lock(&shard->mutex);
     if (g_atomic_int_get(&obj->object.ref_count) == 1) {
-        gbinder_ipc_invalidate_local_object_locked(self, obj);
+        gbinder_ipc_invalidate_local_object_locked(self, shard, obj);
     }
-    g_mutex_unlock(&priv->local_objects_mutex);
+    g_mutex_unlock(&shard->mutex);
     /* Unlock */
 }
 
@@ -1231,7 +1378,8 @@ gbinder_ipc_remote_object_disposed(
     GBinderIpc* self,
     GBinderRemoteObject* obj)
 {
-    GBinderIpcPriv* priv = self->priv;
+    GBinderIpcRegistryShard* shard = gbinder_ipc_remote_shard(self->priv,
+        obj->handle);
 
     /*
      * Check of ref_count for 1 makes it possible (albeit quite unlikely)
@@ -1249,7 +1397,7 @@ gbinder_ipc_remote_object_disposed(
      *
      * We still have to invalidate the handle here because it's the last
      * point when GObject can be legitimately re-referenced and brought
-     * back to life. Which means that GBinderIpc mutex has to acquired
+     * back to life. Which means that the registry mutex has to acquired
      * twice during GBinderRemoteObject destruction.
      *
      * The same applies to GBinderLocalObject too, except that it calls
@@ -1257,11 +1405,11 @@ gbinder_ipc_remote_object_disposed(
      */
 
     /* Lock */
-    g_mutex_lock(&priv->remote_objects_mutex);
+    g_mutex_lock(&shard->mutex);
     if (g_atomic_int_get(&obj->object.ref_count) == 1) {
-        gbinder_ipc_invalidate_remote_handle_locked(self, obj->handle);
+        gbinder_ipc_invalidate_remote_handle_locked(self, shard, obj->handle);
     }
-    g_mutex_unlock(&priv->remote_objects_mutex);
+    g_mutex_unlock(&shard->mutex);
     /* Unlock */
 }
 
@@ -1270,18 +1418,18 @@ gbinder_ipc_register_local_object(
     GBinderIpc* self,
     GBinderLocalObject* obj)
 {
-    GBinderIpcPriv* priv = self->priv;
+    GBinderIpcRegistryShard* shard = gbinder_ipc_local_shard(self->priv, obj);
 
     /* Lock */
-    g_mutex_lock(&priv->local_objects_mutex);
-    if (!priv->local_objects) {
-        priv->local_objects = g_hash_table_new(g_direct_hash, g_direct_equal);
+    g_mutex_lock(&shard->mutex);
+    if (!shard->table) {
+        shard->table = g_hash_table_new(g_direct_hash, g_direct_equal);
     }
-    if (!g_hash_table_contains(priv->local_objects, obj)) {
-        g_hash_table_insert(priv->local_objects, obj, obj);
+    if (!g_hash_table_contains(shard->table, obj)) {
+        g_hash_table_insert(shard->table, obj, obj);
         GVERBOSE_("%p %s", obj, gbinder_ipc_name(self));
     }
-    g_mutex_unlock(&priv->local_objects_mutex);
+    g_mutex_unlock(&shard->mutex);
     /* Unlock */
 
     gbinder_ipc_looper_check(self);
@@ -1296,10 +1444,12 @@ gbinder_ipc_priv_get_local_object(
     GBinderLocalObject* obj = NULL;
 
     if (pointer) {
+        GBinderIpcRegistryShard* shard = gbinder_ipc_local_shard(priv, pointer);
+
         /* Lock */
-        g_mutex_lock(&priv->local_objects_mutex);
-        if (priv->local_objects) {
-            obj = g_hash_table_lookup(priv->local_objects, pointer);
+        g_mutex_lock(&shard->mutex);
+        if (shard->table) {
+            obj = g_hash_table_lookup(shard->table, pointer);
             if (obj) {
                 gbinder_local_object_ref(obj);
             } else {
@@ -1308,7 +1458,7 @@ gbinder_ipc_priv_get_local_object(
         } else {
             GWARN("Unknown local object %p %s", pointer, priv->name);
         }
-        g_mutex_unlock(&priv->local_objects_mutex);
+        g_mutex_unlock(&shard->mutex);
         /* Unlock */
     }
 
@@ -1324,12 +1474,13 @@ gbinder_ipc_priv_get_remote_object(
     gboolean maybe_dead)
 {
     GBinderRemoteObject* obj = NULL;
+    GBinderIpcRegistryShard* shard = gbinder_ipc_remote_shard(priv, handle);
     void* key = GINT_TO_POINTER(handle);
 
     /* Lock */
-    g_mutex_lock(&priv->remote_objects_mutex);
-    if (priv->remote_objects) {
-        obj = g_hash_table_lookup(priv->remote_objects, key);
+    g_mutex_lock(&shard->mutex);
+    if (shard->table) {
+        obj = g_hash_table_lookup(shard->table, key);
     }
     if (obj) {
         gbinder_remote_object_ref(obj);
@@ -1344,16 +1495,15 @@ gbinder_ipc_priv_get_remote_object(
             REMOTE_OBJECT_CREATE_DEAD : (create == REMOTE_REGISTRY_CAN_CREATE) ?
             REMOTE_OBJECT_CREATE_ALIVE :
             REMOTE_OBJECT_CREATE_ACQUIRED);
-        if (!priv->remote_objects) {
-            priv->remote_objects = g_hash_table_new
-                (g_direct_hash, g_direct_equal);
+        if (!shard->table) {
+            shard->table = g_hash_table_new(g_direct_hash, g_direct_equal);
         }
         GVERBOSE_("%p handle %u %s", obj, handle, gbinder_ipc_name(self));
-        g_hash_table_replace(priv->remote_objects, key, obj);
+        g_hash_table_replace(shard->table, key, obj);
     } else {
         GWARN("Unknown handle %u %s", handle, priv->name);
     }
-    g_mutex_unlock(&priv->remote_objects_mutex);
+    g_mutex_unlock(&shard->mutex);
     /* Unlock */
 
     return obj;
@@ -1369,25 +1519,30 @@ gbinder_ipc_find_local_object(
 
     if (self)  {
         GBinderIpcPriv* priv = self->priv;
+        int i;
 
-        /* Lock */
-        g_mutex_lock(&priv->local_objects_mutex);
-        if (priv->local_objects) {
-            GHashTableIter it;
-            gpointer value;
-
-            g_hash_table_iter_init(&it, priv->local_objects);
-            while (g_hash_table_iter_next(&it, NULL, &value)) {
-                GBinderLocalObject* obj = GBINDER_LOCAL_OBJECT(value);
+        for (i = 0; i < GBINDER_IPC_REGISTRY_SHARDS && !found; i++) {
+            GBinderIpcRegistryShard* shard = priv->local_objects + i;
 
-                if (func(obj, user_data)) {
-                    found = gbinder_local_object_ref(obj);
-                    break;
+            /* Lock */
+            g_mutex_lock(&shard->mutex);
+            if (shard->table) {
+                GHashTableIter it;
+                gpointer value;
+
+                g_hash_table_iter_init(&it, shard->table);
+                while (g_hash_table_iter_next(&it, NULL, &value)) {
+                    GBinderLocalObject* obj = GBINDER_LOCAL_OBJECT(value);
+
+                    if (func(obj, user_data)) {
+                        found = gbinder_local_object_ref(obj);
+                        break;
+                    }
                 }
             }
+            g_mutex_unlock(&shard->mutex);
+            /* Unlock */
         }
-        g_mutex_unlock(&priv->local_objects_mutex);
-        /* Unlock */
     }
 
     return found;
@@ -1702,7 +1857,7 @@ gbinder_ipc_tx_custom_new(
     return priv;
 }
 
-/* Invoked on a thread from tx_pool */
+/* Invoked on a thread from tx_pool or oneway_pool */
 static
 void
 gbinder_ipc_tx_proc(
@@ -1783,9 +1938,34 @@ gbinder_ipc_transact_sync_oneway_worker(
     }
 }
 
+static
+int
+gbinder_ipc_transact_sync_oneway_batch_worker(
+    GBinderIpc* self,
+    guint32 handle,
+    const GBinderClientOnewayTx* txs,
+    guint count)
+{
+    /* Must be invoked on worker thread */
+    if (G_LIKELY(self)) {
+        static const GBinderHandlerFunctions handler_fn = {
+            .can_loop = NULL,
+            .transact = gbinder_ipc_tx_handler_transact
+        };
+        GBinderHandler handler = { &handler_fn };
+        GBinderIpcPriv* priv = self->priv;
+
+        return gbinder_driver_transact_oneway_batch(self->driver,
+            &priv->object_registry, &handler, handle, txs, count);
+    } else {
+        return (-EINVAL);
+    }
+}
+
 const GBinderIpcSyncApi gbinder_ipc_sync_worker = {
     .sync_reply = gbinder_ipc_transact_sync_reply_worker,
-    .sync_oneway = gbinder_ipc_transact_sync_oneway_worker
+    .sync_oneway = gbinder_ipc_transact_sync_oneway_worker,
+    .sync_oneway_batch = gbinder_ipc_transact_sync_oneway_batch_worker
 };
 
 /*==========================================================================*
@@ -1838,11 +2018,69 @@ gbinder_ipc_transact_sync_oneway(
     }
 }
 
+static
+int
+gbinder_ipc_transact_sync_oneway_batch(
+    GBinderIpc* self,
+    guint32 handle,
+    const GBinderClientOnewayTx* txs,
+    guint count)
+{
+    if (G_LIKELY(self)) {
+        GBinderIpcPriv* priv = self->priv;
+
+        return gbinder_driver_transact_oneway_batch(self->driver,
+            &priv->object_registry, NULL, handle, txs, count);
+    } else {
+        return (-EINVAL);
+    }
+}
+
 const GBinderIpcSyncApi gbinder_ipc_sync_main = {
     .sync_reply = gbinder_ipc_transact_sync_reply,
-    .sync_oneway = gbinder_ipc_transact_sync_oneway
+    .sync_oneway = gbinder_ipc_transact_sync_oneway,
+    .sync_oneway_batch = gbinder_ipc_transact_sync_oneway_batch
 };
 
+static
+gconstpointer
+gbinder_ipc_looper_limits_value_map(
+    const char* value)
+{
+    guint min, max;
+    char c;
+
+    /* "min,max" packed into a non-NULL pointer */
+    if (sscanf(value, "%u,%u%c", &min, &max, &c) == 2 && min > 0 &&
+        max >= min && max <= GBINDER_IPC_LOOPERS_LIMIT) {
+        return GUINT_TO_POINTER((min << 16) | max);
+    }
+    return NULL;
+}
+
+static
+void
+gbinder_ipc_looper_limits_load_config(
+    GBinderIpcPriv* priv)
+{
+    GHashTable* map = gbinder_config_load(GBINDER_CONFIG_GROUP_LOOPERS,
+        gbinder_ipc_looper_limits_value_map);
+    gconstpointer val = g_hash_table_lookup(map, priv->dev);
+
+    if (!val) {
+        val = g_hash_table_lookup(map, GBINDER_CONFIG_VALUE_DEFAULT);
+    }
+    if (val) {
+        const guint limits = GPOINTER_TO_UINT(val);
+
+        priv->min_loopers = limits >> 16;
+        priv->max_loopers = limits & 0xffff;
+        GDEBUG("%s loopers %u..%u", priv->name, priv->min_loopers,
+            priv->max_loopers);
+    }
+    g_hash_table_destroy(map);
+}
+
 /*==========================================================================*
  * Interface
  *==========================================================================*/
@@ -1889,6 +2127,8 @@ gbinder_ipc_new(
             /* With "/dev/" prefix, it may be too long to be a thread name */
             priv->name = self->dev +
                 (g_str_has_prefix(priv->dev, "/dev/") ? 5 : 0);
+            gbinder_ipc_looper_limits_load_config(priv);
+            gbinder_ipc_looper_update_max_threads(priv);
         } else {
             g_free(key);
         }
@@ -1982,7 +2222,13 @@ gbinder_ipc_transact(
         const gulong id = tx->pub.id;
 
         g_hash_table_insert(priv->tx_table, GINT_TO_POINTER(id), tx);
-        g_thread_pool_push(priv->tx_pool, tx, NULL);
+        /*
+         * One-way transactions don't wait for the reply and don't need
+         * to occupy the threads from tx_pool. They are all submitted by
+         * a single thread, in the order in which they were issued.
+         */
+        g_thread_pool_push((flags & GBINDER_TX_FLAG_ONEWAY) ?
+            priv->oneway_pool : priv->tx_pool, tx, NULL);
         return id;
     } else {
         return 0;
@@ -2038,6 +2284,66 @@ gbinder_ipc_set_max_threads(
     return g_thread_pool_set_max_threads(self->priv->tx_pool, max, NULL);
 }
 
+gboolean
+gbinder_ipc_set_looper_limits(
+    GBinderIpc* self,
+    guint min_loopers,
+    guint max_loopers)
+{
+    if (G_LIKELY(self) && min_loopers > 0 && max_loopers >= min_loopers &&
+        max_loopers <= GBINDER_IPC_LOOPERS_LIMIT) {
+        GBinderIpcPriv* priv = self->priv;
+        gboolean looping;
+
+        /* Lock */
+        g_mutex_lock(&priv->looper_mutex);
+        priv->min_loopers = min_loopers;
+        priv->max_loopers = max_loopers;
+        looping = (priv->primary_loopers != NULL);
+        gbinder_ipc_looper_update_max_threads(priv);
+        g_mutex_unlock(&priv->looper_mutex);
+        /* Unlock */
+
+        /* Start more loopers if necessary */
+        if (looping) {
+            gbinder_ipc_looper_check(self);
+        }
+        return TRUE;
+    }
+    return FALSE;
+}
+
+void
+gbinder_ipc_get_looper_limits(
+    GBinderIpc* self,
+    guint* min_loopers,
+    guint* max_loopers)
+{
+    GBinderIpcPriv* priv = self->priv;
+
+    /* Lock */
+    g_mutex_lock(&priv->looper_mutex);
+    *min_loopers = priv->min_loopers;
+    *max_loopers = priv->max_loopers;
+    g_mutex_unlock(&priv->looper_mutex);
+    /* Unlock */
+}
+
+guint
+gbinder_ipc_looper_count(
+    GBinderIpc* self)
+{
+    GBinderIpcPriv* priv = self->priv;
+    guint n;
+
+    /* Lock */
+    g_mutex_lock(&priv->looper_mutex);
+    n = gbinder_ipc_looper_count_primary(priv);
+    g_mutex_unlock(&priv->looper_mutex);
+    /* Unlock */
+    return n;
+}
+
 /*==========================================================================*
  * Internals
  *==========================================================================*/
@@ -2055,13 +2361,20 @@ gbinder_ipc_init(
     };
     GBinderIpcPriv* priv = G_TYPE_INSTANCE_GET_PRIVATE(self, THIS_TYPE,
         GBinderIpcPriv);
+    int i;
 
     g_mutex_init(&priv->looper_mutex);
-    g_mutex_init(&priv->local_objects_mutex);
-    g_mutex_init(&priv->remote_objects_mutex);
+    priv->min_loopers = GBINDER_IPC_MIN_LOOPERS;
+    priv->max_loopers = GBINDER_IPC_MAX_LOOPERS;
+    for (i = 0; i < GBINDER_IPC_REGISTRY_SHARDS; i++) {
+        g_mutex_init(&priv->local_objects[i].mutex);
+        g_mutex_init(&priv->remote_objects[i].mutex);
+    }
     priv->tx_table = g_hash_table_new(g_direct_hash, g_direct_equal);
     priv->tx_pool = g_thread_pool_new(gbinder_ipc_tx_proc, self,
         GBINDER_IPC_MAX_TX_THREADS, FALSE, NULL);
+    priv->oneway_pool = g_thread_pool_new(gbinder_ipc_tx_proc, self,
+        1, FALSE, NULL);
     priv->object_registry.f = &object_registry_functions;
     priv->self = self;
     self->priv = priv;
@@ -2080,6 +2393,7 @@ gbinder_ipc_stop_loopers(
 
         /* Lock */
         g_mutex_lock(&priv->looper_mutex);
+        priv->stopping_loopers = TRUE; /* Don't spawn any more loopers */
         loopers = gbinder_ipc_looper_stop_all(gbinder_ipc_looper_stop_all(NULL,
             priv->primary_loopers), priv->blocked_loopers);
         priv->blocked_loopers = NULL;
@@ -2097,6 +2411,12 @@ gbinder_ipc_stop_loopers(
             gbinder_ipc_looper_unref(looper);
         }
     } while (loopers);
+
+    /* Lock */
+    g_mutex_lock(&priv->looper_mutex);
+    priv->stopping_loopers = FALSE;
+    g_mutex_unlock(&priv->looper_mutex);
+    /* Unlock */
 }
 
 static
@@ -2138,15 +2458,21 @@ gbinder_ipc_finalize(
 {
     GBinderIpc* self = THIS(object);
     GBinderIpcPriv* priv = self->priv;
+    int i;
 
-    GASSERT(!priv->local_objects);
-    GASSERT(!priv->remote_objects);
+    for (i = 0; i < GBINDER_IPC_REGISTRY_SHARDS; i++) {
+        GASSERT(!priv->local_objects[i].table);
+        GASSERT(!priv->remote_objects[i].table);
+        g_mutex_clear(&priv->local_objects[i].mutex);
+        g_mutex_clear(&priv->remote_objects[i].mutex);
+    }
     g_mutex_clear(&priv->looper_mutex);
-    g_mutex_clear(&priv->local_objects_mutex);
-    g_mutex_clear(&priv->remote_objects_mutex);
     if (priv->tx_pool) {
         g_thread_pool_free(priv->tx_pool, FALSE, TRUE);
     }
+    if (priv->oneway_pool) {
+        g_thread_pool_free(priv->oneway_pool, FALSE, TRUE);
+    }
     GASSERT(!g_hash_table_size(priv->tx_table));
     g_hash_table_unref(priv->tx_table);
     gbinder_driver_unref(self->driver);
@@ -2194,6 +2520,7 @@ gbinder_ipc_exit()
         GSList* tx_keys = NULL;
         GSList* k;
         GSList* l;
+        int j;
 
         /* Terminate looper threads */
         GVERBOSE_("%s", ipc->dev);
@@ -2206,6 +2533,12 @@ gbinder_ipc_exit()
             priv->tx_pool = NULL;
             g_thread_pool_free(pool, FALSE, TRUE);
         }
+        if (priv->oneway_pool) {
+            GThreadPool* pool = priv->oneway_pool;
+
+            priv->oneway_pool = NULL;
+            g_thread_pool_free(pool, FALSE, TRUE);
+        }
 
         /*
          * Since this function is supposed to be invoked on the main thread,
@@ -2227,17 +2560,21 @@ gbinder_ipc_exit()
         GASSERT(!g_hash_table_size(priv->tx_table));
         g_slist_free(tx_keys);
 
-        /* Lock */
-        g_mutex_lock(&priv->local_objects_mutex);
-        if (priv->local_objects) {
-            g_hash_table_iter_init(&it, priv->local_objects);
-            while (g_hash_table_iter_next(&it, NULL, &value)) {
-                local_objs = g_slist_append(local_objs,
-                    gbinder_local_object_ref(value));
+        for (j = 0; j < GBINDER_IPC_REGISTRY_SHARDS; j++) {
+            GBinderIpcRegistryShard* shard = priv->local_objects + j;
+
+            /* Lock */
+            g_mutex_lock(&shard->mutex);
+            if (shard->table) {
+                g_hash_table_iter_init(&it, shard->table);
+                while (g_hash_table_iter_next(&it, NULL, &value)) {
+                    local_objs = g_slist_append(local_objs,
+                        gbinder_local_object_ref(value));
+                }
             }
+            g_mutex_unlock(&shard->mutex);
+            /* Unlock */
         }
-        g_mutex_unlock(&priv->local_objects_mutex);
-        /* Unlock */
 
         /* Drop remote references */
         for (l = local_objs; l; l = l->next) {
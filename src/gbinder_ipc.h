@@ -90,9 +90,18 @@ int
     guint32 code,
     GBinderLocalRequest* req);
 
+typedef
+int
+(*GBinderIpcSyncOnewayBatchFunc)(
+    GBinderIpc* ipc,
+    guint32 handle,
+    const GBinderClientOnewayTx* txs,
+    guint count);
+
 struct gbinder_ipc_sync_api {
     GBinderIpcSyncReplyFunc sync_reply;
     GBinderIpcSyncOnewayFunc sync_oneway;
+    GBinderIpcSyncOnewayBatchFunc sync_oneway_batch;
 };
 
 extern const GBinderIpcSyncApi gbinder_ipc_sync_main GBINDER_INTERNAL;
@@ -226,6 +235,25 @@ gbinder_ipc_set_max_threads(
     gint max_threads)
     GBINDER_INTERNAL;
 
+gboolean
+gbinder_ipc_set_looper_limits(
+    GBinderIpc* ipc,
+    guint min_loopers,
+    guint max_loopers)
+    GBINDER_INTERNAL;
+
+void
+gbinder_ipc_get_looper_limits(
+    GBinderIpc* ipc,
+    guint* min_loopers,
+    guint* max_loopers)
+    GBINDER_INTERNAL;
+
+guint
+gbinder_ipc_looper_count(
+    GBinderIpc* ipc)
+    GBINDER_INTERNAL;
+
 /* Declared for unit tests */
 void
 gbinder_ipc_exit(
@@ -36,6 +36,7 @@
 #include "gbinder_local_object_p.h"
 #include "gbinder_local_reply_p.h"
 #include "gbinder_remote_request.h"
+#include "gbinder_rpc_protocol.h"
 #include "gbinder_eventloop_p.h"
 #include "gbinder_writer.h"
 #include "gbinder_log.h"
@@ -49,6 +50,12 @@ struct gbinder_local_object_priv {
     char** ifaces;
     GBinderLocalTransactFunc txproc;
     void* user_data;
+    gboolean concurrent;
+    /* These are only used by concurrent objects */
+    GMutex txproc_mutex;
+    guint txproc_calls;
+    gboolean dropped;
+    GDestroyNotify destroy;
 };
 
 typedef struct gbinder_local_object_acquire_data {
@@ -97,29 +104,117 @@ gbinder_local_object_create_reply(
 }
 
 static
-GBINDER_LOCAL_TRANSACTION_SUPPORT
-gbinder_local_object_default_can_handle_transaction(
-    GBinderLocalObject* self,
+gboolean
+gbinder_local_object_is_builtin_transaction(
     const char* iface,
     guint code)
 {
     switch (code) {
     case GBINDER_PING_TRANSACTION:
     case GBINDER_INTERFACE_TRANSACTION:
-        return GBINDER_LOCAL_TRANSACTION_LOOPER;
+        return TRUE;
     case HIDL_PING_TRANSACTION:
     case HIDL_GET_DESCRIPTOR_TRANSACTION:
     case HIDL_DESCRIPTOR_CHAIN_TRANSACTION:
-        if (!g_strcmp0(iface, hidl_base_interface)) {
-            return GBINDER_LOCAL_TRANSACTION_LOOPER;
-        }
-        /* no break */
+        return !g_strcmp0(iface, hidl_base_interface);
     default:
+        return FALSE;
+    }
+}
+
+static
+GBINDER_LOCAL_TRANSACTION_SUPPORT
+gbinder_local_object_default_can_handle_transaction(
+    GBinderLocalObject* self,
+    const char* iface,
+    guint code)
+{
+    if (gbinder_local_object_is_builtin_transaction(iface, code) ||
+        self->priv->concurrent) {
+        return GBINDER_LOCAL_TRANSACTION_LOOPER;
+    } else {
         return self->priv->txproc ? GBINDER_LOCAL_TRANSACTION_SUPPORTED :
             GBINDER_LOCAL_TRANSACTION_NOT_SUPPORTED;
     }
 }
 
+static
+void
+gbinder_local_object_concurrent_clear_locked(
+    GBinderLocalObjectPriv* priv,
+    GDestroyNotify* destroy,
+    void** user_data)
+{
+    /* Caller holds txproc_mutex and invokes destroy after releasing it */
+    *destroy = priv->destroy;
+    *user_data = priv->user_data;
+    priv->txproc = NULL;
+    priv->user_data = NULL;
+    priv->destroy = NULL;
+}
+
+static
+GBinderLocalReply*
+gbinder_local_object_concurrent_transaction(
+    GBinderLocalObject* self,
+    GBinderRemoteRequest* req,
+    guint code,
+    guint flags,
+    int* status)
+{
+    GBinderLocalObjectPriv* priv = self->priv;
+    GBinderLocalTransactFunc txproc;
+    void* user_data;
+
+    /*
+     * The callback is cleared by gbinder_local_object_drop() only after
+     * the calls in progress have completed. That never blocks, and so
+     * the handler itself may drop the object.
+     */
+
+    /* Lock */
+    g_mutex_lock(&priv->txproc_mutex);
+    if (priv->dropped) {
+        txproc = NULL;
+        user_data = NULL;
+    } else {
+        txproc = priv->txproc;
+        user_data = priv->user_data;
+        if (txproc) {
+            priv->txproc_calls++;
+        }
+    }
+    g_mutex_unlock(&priv->txproc_mutex);
+    /* Unlock */
+
+    if (txproc) {
+        GBinderLocalReply* reply;
+        GDestroyNotify destroy = NULL;
+
+        gbinder_local_object_ref(self);
+        reply = txproc(self, req, code, flags, status, user_data);
+
+        /* Lock */
+        g_mutex_lock(&priv->txproc_mutex);
+        if (!--priv->txproc_calls && priv->dropped) {
+            /* The last call after gbinder_local_object_drop() */
+            gbinder_local_object_concurrent_clear_locked(priv, &destroy,
+                &user_data);
+        }
+        g_mutex_unlock(&priv->txproc_mutex);
+        /* Unlock */
+
+        if (destroy) {
+            destroy(user_data);
+        }
+        gbinder_local_object_unref(self);
+        return reply;
+    } else {
+        if (status) *status = (-EBADMSG);
+        return NULL;
+    }
+}
+
 static
 GBinderLocalReply*
 gbinder_local_object_default_handle_transaction(
@@ -241,6 +336,13 @@ gbinder_local_object_default_handle_looper_transaction(
 {
     GBinderLocalObjectTxHandler handler = NULL;
 
+    if (self->priv->concurrent && !gbinder_local_object_is_builtin_transaction
+        (gbinder_remote_request_interface(req), code)) {
+        /* Invoked directly on the looper thread */
+        return gbinder_local_object_concurrent_transaction(self, req,
+            code, flags, status);
+    }
+
     switch (code) {
     case GBINDER_PING_TRANSACTION:
         handler = gbinder_local_object_ping_transaction;
@@ -274,8 +376,28 @@ gbinder_local_object_default_drop(
     GBinderLocalObjectPriv* priv = self->priv;
 
     /* Clear the transaction callback */
-    priv->txproc = NULL;
-    priv->user_data = NULL;
+    if (priv->concurrent) {
+        GDestroyNotify destroy = NULL;
+        void* user_data = NULL;
+
+        /* Lock */
+        g_mutex_lock(&priv->txproc_mutex);
+        priv->dropped = TRUE;
+        if (!priv->txproc_calls) {
+            /* Otherwise the last call in progress will clear it */
+            gbinder_local_object_concurrent_clear_locked(priv, &destroy,
+                &user_data);
+        }
+        g_mutex_unlock(&priv->txproc_mutex);
+        /* Unlock */
+
+        if (destroy) {
+            destroy(user_data);
+        }
+    } else {
+        priv->txproc = NULL;
+        priv->user_data = NULL;
+    }
 }
 
 static
@@ -392,6 +514,27 @@ gbinder_local_object_new(
         ipc, ifaces, txproc, user_data);
 }
 
+GBinderLocalObject*
+gbinder_local_object_new_concurrent(
+    GBinderIpc* ipc,
+    const char* const* ifaces,
+    GBinderLocalTransactFunc txproc,
+    void* user_data,
+    GDestroyNotify destroy) /* Since 1.1.43 */
+{
+    if (G_LIKELY(ipc)) {
+        GBinderLocalObject* obj = g_object_new(GBINDER_TYPE_LOCAL_OBJECT,
+            NULL);
+
+        gbinder_local_object_init_base(obj, ipc, ifaces, txproc, user_data);
+        obj->priv->concurrent = TRUE;
+        obj->priv->destroy = destroy;
+        gbinder_ipc_register_local_object(ipc, obj);
+        return obj;
+    }
+    return NULL;
+}
+
 GBinderLocalObject*
 gbinder_local_object_new_with_type(
     GType type,
@@ -432,6 +575,7 @@ gbinder_local_object_init_base(
     priv->ifaces = g_new(char*, n + 1);
     if (ifaces) {
         while (*ifaces) {
+            gbinder_rpc_protocol_register_iface(*ifaces);
             priv->ifaces[i++] = g_strdup(*ifaces++);
         }
     }
@@ -634,6 +778,7 @@ gbinder_local_object_init(
     GBinderLocalObjectPriv* priv = G_TYPE_INSTANCE_GET_PRIVATE(self,
         GBINDER_TYPE_LOCAL_OBJECT, GBinderLocalObjectPriv);
 
+    g_mutex_init(&priv->txproc_mutex);
     self->priv = priv;
 }
 
@@ -657,9 +802,14 @@ gbinder_local_object_finalize(
     GBinderLocalObjectPriv* priv = self->priv;
 
     GASSERT(!self->strong_refs);
+    if (priv->destroy) {
+        /* Concurrent object which has never been dropped */
+        priv->destroy(priv->user_data);
+    }
     gbinder_ipc_invalidate_local_object(self->ipc, self);
     gbinder_ipc_unref(self->ipc);
     g_strfreev(priv->ifaces);
+    g_mutex_clear(&priv->txproc_mutex);
     G_OBJECT_CLASS(PARENT_CLASS)->finalize(object);
 }
 
@@ -122,6 +122,7 @@ gbinder_local_reply_free(
     gutil_int_array_free(data->offsets, TRUE);
     g_byte_array_free(data->bytes, TRUE);
     gbinder_cleanup_free(data->cleanup);
+    gbinder_arena_free(&data->arena);
     gbinder_buffer_contents_unref(self->contents);
     gutil_slice_free(self);
 }
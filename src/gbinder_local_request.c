@@ -162,6 +162,7 @@ gbinder_local_request_free(
     g_byte_array_free(data->bytes, TRUE);
     gutil_int_array_free(data->offsets, TRUE);
     gbinder_cleanup_free(data->cleanup);
+    gbinder_arena_free(&data->arena);
     g_slice_free(GBinderLocalRequest, self);
 }
 
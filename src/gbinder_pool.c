@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "gbinder_pool.h"
+#include "gbinder_config.h"
+#include "gbinder_log.h"
+
+#include <gutil_macros.h>
+
+/*
+ * Number of free blocks of each type kept by each thread can be
+ * configured like this:
+ *
+ * [General]
+ * PoolSize=64
+ *
+ * Zero disables the pools.
+ */
+static const char CONF_POOL_SIZE[] = "PoolSize";
+
+#define DEFAULT_POOL_SIZE (16)
+#define MAX_POOL_SIZE (1024)
+
+/*
+ * Each block is preceded by a header which remembers the cache of the
+ * thread which allocated it. A block freed by that thread goes straight
+ * to its free list. A block freed by another thread is pushed to the
+ * owner's lock-free return stack, which the owner picks up when its free
+ * list runs dry. That way the blocks allocated by the looper threads
+ * don't pile up on the main thread which usually frees them.
+ *
+ * The header is two pointers long to preserve the malloc alignment.
+ */
+typedef struct gbinder_pool_cache GBinderPoolCache;
+typedef struct gbinder_pool_block GBinderPoolBlock;
+
+struct gbinder_pool_block {
+    GBinderPoolCache* owner;
+    GBinderPoolBlock* next;
+};
+
+typedef struct gbinder_pool_list {
+    GBinderPoolBlock* first;
+    guint count;
+} GBinderPoolList;
+
+/*
+ * The cache is referenced by its thread and by each block handed out
+ * by it, so it survives the thread until all its blocks are freed.
+ */
+struct gbinder_pool_cache {
+    gint refcount;
+    gint exited;
+    GBinderPoolList list[GBINDER_POOL_COUNT];
+    GBinderPoolBlock* returned[GBINDER_POOL_COUNT]; /* Lock-free stacks */
+};
+
+static
+void
+gbinder_pool_cache_exit(
+    gpointer data);
+
+static GPrivate gbinder_pool_cache = G_PRIVATE_INIT(gbinder_pool_cache_exit);
+static gint gbinder_pool_max = -1; /* Not yet known */
+static gint gbinder_pool_hits = 0;
+static gint gbinder_pool_misses = 0;
+
+#define gbinder_pool_block_data(block) ((void*)((block) + 1))
+#define gbinder_pool_data_block(ptr) (((GBinderPoolBlock*)(ptr)) - 1)
+
+/*==========================================================================*
+ * Implementation
+ *==========================================================================*/
+
+static
+void
+gbinder_pool_block_list_free(
+    GBinderPoolBlock* block)
+{
+    while (block) {
+        GBinderPoolBlock* next = block->next;
+
+        g_free(block);
+        block = next;
+    }
+}
+
+static
+GBinderPoolBlock*
+gbinder_pool_cache_take_returned(
+    GBinderPoolCache* cache,
+    GBinderPoolType type)
+{
+    GBinderPoolBlock** stack = cache->returned + type;
+    GBinderPoolBlock* first;
+
+    /* Taking the whole stack at once is immune to ABA */
+    do {
+        first = g_atomic_pointer_get(stack);
+    } while (first && !g_atomic_pointer_compare_and_exchange(stack,
+        first, NULL));
+    return first;
+}
+
+static
+void
+gbinder_pool_cache_return(
+    GBinderPoolCache* cache,
+    GBinderPoolType type,
+    GBinderPoolBlock* block)
+{
+    GBinderPoolBlock** stack = cache->returned + type;
+    GBinderPoolBlock* first;
+
+    do {
+        first = g_atomic_pointer_get(stack);
+        block->next = first;
+    } while (!g_atomic_pointer_compare_and_exchange(stack, first, block));
+}
+
+static
+void
+gbinder_pool_cache_clear(
+    GBinderPoolCache* cache)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(cache->list); i++) {
+        GBinderPoolList* list = cache->list + i;
+
+        gbinder_pool_block_list_free(list->first);
+        gbinder_pool_block_list_free(gbinder_pool_cache_take_returned(cache,
+            i));
+        list->first = NULL;
+        list->count = 0;
+    }
+}
+
+static
+void
+gbinder_pool_cache_unref(
+    GBinderPoolCache* cache)
+{
+    if (g_atomic_int_dec_and_test(&cache->refcount)) {
+        gbinder_pool_cache_clear(cache);
+        g_free(cache);
+    }
+}
+
+static
+void
+gbinder_pool_cache_exit(
+    gpointer data)
+{
+    GBinderPoolCache* cache = data;
+
+    /* The blocks which are still in use will be freed without caching */
+    g_atomic_int_set(&cache->exited, TRUE);
+    gbinder_pool_cache_clear(cache);
+    gbinder_pool_cache_unref(cache);
+}
+
+static
+gboolean
+gbinder_pool_cache_refill(
+    GBinderPoolCache* cache,
+    GBinderPoolType type)
+{
+    GBinderPoolList* list = cache->list + type;
+    GBinderPoolBlock* block = gbinder_pool_cache_take_returned(cache, type);
+    const guint max = gbinder_pool_max_size();
+
+    /* Caller has checked that the list is empty */
+    while (block && list->count < max) {
+        GBinderPoolBlock* next = block->next;
+
+        block->next = list->first;
+        list->first = block;
+        list->count++;
+        block = next;
+    }
+    /* Blocks in excess of the limit */
+    gbinder_pool_block_list_free(block);
+    return list->first != NULL;
+}
+
+static
+guint
+gbinder_pool_conf_size(
+    void)
+{
+    GKeyFile* k = gbinder_config_get();
+
+    if (k) {
+        GError* error = NULL;
+        const int size = g_key_file_get_integer(k,
+            GBINDER_CONFIG_GROUP_GENERAL, CONF_POOL_SIZE, &error);
+
+        if (!error) {
+            return CLAMP(size, 0, MAX_POOL_SIZE);
+        }
+        g_error_free(error);
+    }
+    return DEFAULT_POOL_SIZE;
+}
+
+/*==========================================================================*
+ * Internal interface
+ *==========================================================================*/
+
+void*
+gbinder_pool_alloc0(
+    GBinderPoolType type,
+    gsize size)
+{
+    GBinderPoolCache* cache = g_private_get(&gbinder_pool_cache);
+    GBinderPoolBlock* block;
+
+    if (!cache && gbinder_pool_max_size()) {
+        cache = g_new0(GBinderPoolCache, 1);
+        g_atomic_int_set(&cache->refcount, 1);
+        g_private_set(&gbinder_pool_cache, cache);
+    }
+
+    if (cache) {
+        GBinderPoolList* list = cache->list + type;
+
+        /* Each block handed out holds a reference to its cache */
+        g_atomic_int_inc(&cache->refcount);
+        if (list->first || gbinder_pool_cache_refill(cache, type)) {
+            block = list->first;
+            list->first = block->next;
+            list->count--;
+            g_atomic_int_inc(&gbinder_pool_hits);
+            memset(gbinder_pool_block_data(block), 0, size);
+            return gbinder_pool_block_data(block);
+        }
+    }
+    g_atomic_int_inc(&gbinder_pool_misses);
+    block = g_malloc0(sizeof(GBinderPoolBlock) + size);
+    block->owner = cache;
+    return gbinder_pool_block_data(block);
+}
+
+void
+gbinder_pool_free(
+    GBinderPoolType type,
+    void* ptr)
+{
+    if (ptr) {
+        GBinderPoolBlock* block = gbinder_pool_data_block(ptr);
+        GBinderPoolCache* owner = block->owner;
+
+        if (owner) {
+            if (owner == g_private_get(&gbinder_pool_cache)) {
+                GBinderPoolList* list = owner->list + type;
+
+                if (list->count < gbinder_pool_max_size()) {
+                    block->next = list->first;
+                    list->first = block;
+                    list->count++;
+                    block = NULL;
+                }
+            } else if (!g_atomic_int_get(&owner->exited)) {
+                /* Give it back to the thread which has allocated it */
+                gbinder_pool_cache_return(owner, type, block);
+                block = NULL;
+            }
+            /* This may free the cache of the thread which has exited */
+            gbinder_pool_cache_unref(owner);
+        }
+        g_free(block);
+    }
+}
+
+guint
+gbinder_pool_max_size(
+    void)
+{
+    const gint max = g_atomic_int_get(&gbinder_pool_max);
+
+    if (max < 0) {
+        /* If it races with gbinder_pool_set_max_size(), the setter wins */
+        g_atomic_int_compare_and_exchange(&gbinder_pool_max, -1,
+            gbinder_pool_conf_size());
+        return g_atomic_int_get(&gbinder_pool_max);
+    }
+    return max;
+}
+
+void
+gbinder_pool_set_max_size(
+    guint max)
+{
+    /* Blocks in excess of the new limit get freed as they are reused */
+    g_atomic_int_set(&gbinder_pool_max, MIN(max, MAX_POOL_SIZE));
+}
+
+void
+gbinder_pool_trim(
+    void)
+{
+    GBinderPoolCache* cache = g_private_get(&gbinder_pool_cache);
+
+    if (cache) {
+        gbinder_pool_cache_clear(cache);
+    }
+}
+
+void
+gbinder_pool_stats(
+    GBinderPoolStats* stats)
+{
+    stats->hits = g_atomic_int_get(&gbinder_pool_hits);
+    stats->misses = g_atomic_int_get(&gbinder_pool_misses);
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef GBINDER_POOL_H
+#define GBINDER_POOL_H
+
+#include "gbinder_types_p.h"
+
+/*
+ * Per-thread free lists for the small structures allocated (and freed)
+ * for each transaction. Each thread keeps a bounded number of free
+ * blocks of each type. A block may be freed by a thread other than the
+ * one which allocated it, it then gets returned to the thread which has
+ * allocated it. All blocks of the same type must have the same size,
+ * and only pointers returned by gbinder_pool_alloc0() may be passed to
+ * gbinder_pool_free().
+ */
+
+typedef enum gbinder_pool_type {
+    GBINDER_POOL_REMOTE_REQUEST,
+    GBINDER_POOL_REMOTE_REPLY,
+    GBINDER_POOL_BUFFER,
+    GBINDER_POOL_BUFFER_CONTENTS,
+    GBINDER_POOL_BUFFER_OBJECTS,
+    GBINDER_POOL_COUNT
+} GBinderPoolType;
+
+typedef struct gbinder_pool_stats {
+    guint hits;         /* Allocations satisfied from a free list */
+    guint misses;       /* Allocations which had to call malloc */
+} GBinderPoolStats;
+
+void*
+gbinder_pool_alloc0(
+    GBinderPoolType type,
+    gsize size)
+    GBINDER_INTERNAL;
+
+void
+gbinder_pool_free(
+    GBinderPoolType type,
+    void* ptr)
+    GBINDER_INTERNAL;
+
+/* Max number of free blocks of each type kept by each thread */
+guint
+gbinder_pool_max_size(
+    void)
+    GBINDER_INTERNAL;
+
+void
+gbinder_pool_set_max_size(
+    guint max)
+    GBINDER_INTERNAL;
+
+/* Releases the free blocks cached by the calling thread */
+void
+gbinder_pool_trim(
+    void)
+    GBINDER_INTERNAL;
+
+/* Process-wide counters */
+void
+gbinder_pool_stats(
+    GBinderPoolStats* stats)
+    GBINDER_INTERNAL;
+
+#endif /* GBINDER_POOL_H */
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
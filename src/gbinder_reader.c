@@ -684,6 +684,66 @@ gbinder_reader_read_nullable_string8(
     return FALSE;
 }
 
+/*
+ * Narrows the leading ASCII part of UTF-16 string, four code units at
+ * a time. Returns the number of code units converted.
+ */
+static
+gsize
+gbinder_reader_utf16_to_ascii(
+    char* dest,
+    const gunichar2* src,
+    gsize len)
+{
+    const guint64 mask = G_GUINT64_CONSTANT(0xff80ff80ff80ff80);
+    gsize i = 0;
+
+    while (i + 4 <= len) {
+        guint64 w;
+        guint k;
+
+        memcpy(&w, src + i, sizeof(w));
+        if (w & mask) {
+            break;
+        }
+        for (k = 0; k < 4; k++) {
+            dest[i + k] = (char)src[i + k];
+        }
+        i += 4;
+    }
+    while (i < len && src[i] < 0x80) {
+        dest[i] = (char)src[i];
+        i++;
+    }
+    return i;
+}
+
+char*
+gbinder_reader_utf16_to_utf8(
+    const gunichar2* utf16,
+    gsize len,
+    char* buf,
+    gsize bufsize)
+{
+    if (len < bufsize) {
+        if (gbinder_reader_utf16_to_ascii(buf, utf16, len) == len) {
+            buf[len] = 0;
+            return buf;
+        }
+    } else {
+        char* str = g_malloc(len + 1);
+
+        if (gbinder_reader_utf16_to_ascii(str, utf16, len) == len) {
+            str[len] = 0;
+            return str;
+        }
+        g_free(str);
+    }
+
+    /* Not ASCII, let glib take care of it */
+    return g_utf16_to_utf8(utf16, len, NULL, NULL, NULL);
+}
+
 /* The equivalent of Android's Parcel::readString16 */
 gboolean
 gbinder_reader_read_nullable_string16(
@@ -695,7 +755,8 @@ gbinder_reader_read_nullable_string16(
 
     if (gbinder_reader_read_nullable_string16_utf16(reader, &str, &len)) {
         if (out) {
-            *out = str ? g_utf16_to_utf8(str, len, NULL, NULL, NULL) : NULL;
+            *out = str ? gbinder_reader_utf16_to_utf8(str, len, NULL, 0) :
+                NULL;
         }
         return TRUE;
     }
@@ -778,6 +839,54 @@ gbinder_reader_skip_string16(
     return gbinder_reader_read_nullable_string16_utf16(reader, NULL, NULL);
 }
 
+gboolean
+gbinder_reader_string16_equal(
+    const gunichar2* str,
+    gsize len,
+    const char* utf8) /* Since 1.1.43 */
+{
+    if (str && utf8) {
+        const char* ptr = utf8;
+        gsize i = 0;
+
+        while (*ptr) {
+            const guchar c = *ptr;
+
+            if (c < 0x80) {
+                if (i >= len || str[i] != c) {
+                    return FALSE;
+                }
+                i++;
+                ptr++;
+            } else {
+                const gunichar ch = g_utf8_get_char_validated(ptr, -1);
+
+                if (ch > 0x10ffff) {
+                    /* (gunichar)-1 or (gunichar)-2 i.e. invalid UTF-8 */
+                    return FALSE;
+                } else if (ch < 0x10000) {
+                    if (i >= len || str[i] != ch) {
+                        return FALSE;
+                    }
+                    i++;
+                } else {
+                    const gunichar u = ch - 0x10000;
+
+                    if (i + 1 >= len ||
+                        str[i] != (0xd800 + (u >> 10)) ||
+                        str[i + 1] != (0xdc00 + (u & 0x3ff))) {
+                        return FALSE;
+                    }
+                    i += 2;
+                }
+                ptr = g_utf8_next_char(ptr);
+            }
+        }
+        return i == len;
+    }
+    return !str && !utf8;
+}
+
 const void*
 gbinder_reader_read_byte_array(
     GBinderReader* reader,
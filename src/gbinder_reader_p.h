@@ -51,6 +51,18 @@ gbinder_reader_init(
     gsize len)
     GBINDER_INTERNAL;
 
+/*
+ * Returns buf if the string is ASCII and fits into the buffer, otherwise
+ * the result is allocated from the heap and has to be freed by the caller.
+ */
+char*
+gbinder_reader_utf16_to_utf8(
+    const gunichar2* utf16,
+    gsize len,
+    char* buf,
+    gsize bufsize)
+    GBINDER_INTERNAL;
+
 #endif /* GBINDER_READER_PRIVATE_H */
 
 /*
@@ -36,6 +36,7 @@
 #include "gbinder_object_registry.h"
 #include "gbinder_buffer_p.h"
 #include "gbinder_log.h"
+#include "gbinder_pool.h"
 
 #include <gutil_macros.h>
 
@@ -48,7 +49,8 @@ GBinderRemoteReply*
 gbinder_remote_reply_new(
     GBinderObjectRegistry* reg)
 {
-    GBinderRemoteReply* self = g_slice_new0(GBinderRemoteReply);
+    GBinderRemoteReply* self = gbinder_pool_alloc0
+        (GBINDER_POOL_REMOTE_REPLY, sizeof(GBinderRemoteReply));
     GBinderReaderData* data = &self->data;
 
     g_atomic_int_set(&self->refcount, 1);
@@ -65,7 +67,7 @@ gbinder_remote_reply_free(
 
     gbinder_object_registry_unref(data->reg);
     gbinder_buffer_free(data->buffer);
-    g_slice_free(GBinderRemoteReply, self);
+    gbinder_pool_free(GBINDER_POOL_REMOTE_REPLY, self);
 }
 
 void
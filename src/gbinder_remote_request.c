@@ -39,6 +39,7 @@
 #include "gbinder_buffer_p.h"
 #include "gbinder_driver.h"
 #include "gbinder_log.h"
+#include "gbinder_pool.h"
 
 #include <gutil_macros.h>
 
@@ -51,7 +52,7 @@ typedef struct gbinder_remote_request_priv {
     uid_t euid;
     const GBinderRpcProtocol* protocol;
     const char* iface;
-    char* iface2;
+    GBinderRpcIfaceBuf iface2;
     gsize header_size;
     GBinderReaderData data;
 } GBinderRemoteRequestPriv;
@@ -67,7 +68,8 @@ gbinder_remote_request_new(
     pid_t pid,
     uid_t euid)
 {
-    GBinderRemoteRequestPriv* self = g_slice_new0(GBinderRemoteRequestPriv);
+    GBinderRemoteRequestPriv* self = gbinder_pool_alloc0
+        (GBINDER_POOL_REMOTE_REQUEST, sizeof(GBinderRemoteRequestPriv));
     GBinderReaderData* data = &self->data;
 
     g_atomic_int_set(&self->refcount, 1);
@@ -133,8 +135,8 @@ gbinder_remote_request_free(
     }
     gbinder_object_registry_unref(data->reg);
     gbinder_buffer_free(data->buffer);
-    g_free(self->iface2);
-    g_slice_free(GBinderRemoteRequestPriv, self);
+    g_free(self->iface2.alloc);
+    gbinder_pool_free(GBINDER_POOL_REMOTE_REQUEST, self);
 }
 
 static
@@ -167,7 +169,8 @@ gbinder_remote_request_set_data(
     GBinderReaderData* data = &self->data;
     GBinderReader reader;
 
-    g_free(self->iface2);
+    g_free(self->iface2.alloc);
+    self->iface2.alloc = NULL;
     gbinder_buffer_free(data->buffer);
     data->buffer = buffer;
     data->objects = gbinder_buffer_objects(buffer);
@@ -31,7 +31,7 @@
  */
 
 #include "gbinder_rpc_protocol.h"
-#include "gbinder_reader.h"
+#include "gbinder_reader_p.h"
 #include "gbinder_writer.h"
 #include "gbinder_config.h"
 #include "gbinder_log.h"
@@ -78,6 +78,108 @@ static const GBinderRpcProtocol DEFAULT_PROTOCOL;
 static const GBinderRpcProtocol* gbinder_rpc_protocol_default =
     &DEFAULT_PROTOCOL;
 
+/*==========================================================================*
+ * Interned interface names
+ *
+ * The interfaces implemented by the local objects are mapped (by their
+ * raw UTF-16 representation) to the strings interned with g_intern_string(),
+ * so that incoming requests for those interfaces get their names decoded
+ * without any conversion or memory allocation. Only the names registered
+ * by this process get interned, whatever the peers send gets decoded for
+ * each request. The table is only modified when a local object is created,
+ * the readers don't block each other.
+ *==========================================================================*/
+
+typedef struct gbinder_rpc_iface_key {
+    const gunichar2* str;
+    gsize len;
+} GBinderRpcIfaceKey;
+
+static GHashTable* gbinder_rpc_iface_table = NULL;
+static GRWLock gbinder_rpc_iface_lock;
+
+static
+guint
+gbinder_rpc_iface_key_hash(
+    gconstpointer key)
+{
+    const GBinderRpcIfaceKey* k = key;
+    guint32 h = 5381;
+    gsize i;
+
+    for (i = 0; i < k->len; i++) {
+        h = (h << 5) + h + k->str[i];
+    }
+    return h;
+}
+
+static
+gboolean
+gbinder_rpc_iface_key_equal(
+    gconstpointer a,
+    gconstpointer b)
+{
+    const GBinderRpcIfaceKey* k1 = a;
+    const GBinderRpcIfaceKey* k2 = b;
+
+    return k1->len == k2->len && !memcmp(k1->str, k2->str, k1->len * 2);
+}
+
+static
+const char*
+gbinder_rpc_iface_lookup(
+    const gunichar2* str,
+    gsize len)
+{
+    const char* name = NULL;
+
+    if (g_atomic_pointer_get(&gbinder_rpc_iface_table)) {
+        GBinderRpcIfaceKey key;
+
+        key.str = str;
+        key.len = len;
+
+        /* Lock */
+        g_rw_lock_reader_lock(&gbinder_rpc_iface_lock);
+        if (gbinder_rpc_iface_table) {
+            name = g_hash_table_lookup(gbinder_rpc_iface_table, &key);
+        }
+        g_rw_lock_reader_unlock(&gbinder_rpc_iface_lock);
+        /* Unlock */
+    }
+    return name;
+}
+
+static
+const char*
+gbinder_rpc_protocol_read_iface(
+    GBinderReader* reader,
+    GBinderRpcIfaceBuf* iface)
+{
+    const gunichar2* str;
+    gsize len;
+
+    if (gbinder_reader_read_nullable_string16_utf16(reader, &str, &len) &&
+        str) {
+        const char* name = gbinder_rpc_iface_lookup(str, len);
+        char* utf8;
+
+        if (name) {
+            return name;
+        }
+
+        /* Not implemented by any local object, decode this one */
+        utf8 = gbinder_reader_utf16_to_utf8(str, len, iface->buf,
+            sizeof(iface->buf));
+
+        if (utf8 != iface->buf) {
+            iface->alloc = utf8;
+        }
+        return utf8;
+    }
+    return NULL;
+}
+
 /*==========================================================================*
  * The original AIDL protocol.
  *==========================================================================*/
@@ -110,17 +212,16 @@ const char*
 gbinder_rpc_protocol_aidl_read_rpc_header(
     GBinderReader* reader,
     guint32 txcode,
-    char** iface)
+    GBinderRpcIfaceBuf* iface)
 {
     if (txcode > GBINDER_TRANSACTION(0,0,0)) {
         /* Internal transaction e.g. GBINDER_DUMP_TRANSACTION etc. */
-        *iface = NULL;
+        return NULL;
     } else if (gbinder_reader_read_int32(reader, NULL)) {
-        *iface = gbinder_reader_read_string16(reader);
+        return gbinder_rpc_protocol_read_iface(reader, iface);
     } else {
-        *iface = NULL;
+        return NULL;
     }
-    return *iface;
 }
 
 static const GBinderRpcProtocol gbinder_rpc_protocol_aidl = {
@@ -157,18 +258,17 @@ const char*
 gbinder_rpc_protocol_aidl2_read_rpc_header(
     GBinderReader* reader,
     guint32 txcode,
-    char** iface)
+    GBinderRpcIfaceBuf* iface)
 {
     if (txcode > GBINDER_TRANSACTION(0,0,0)) {
         /* Internal transaction e.g. GBINDER_DUMP_TRANSACTION etc. */
-        *iface = NULL;
+        return NULL;
     } else if (gbinder_reader_read_int32(reader, NULL) /* flags */ &&
         gbinder_reader_read_int32(reader, NULL) /* work source */) {
-        *iface = gbinder_reader_read_string16(reader);
+        return gbinder_rpc_protocol_read_iface(reader, iface);
     } else {
-        *iface = NULL;
+        return NULL;
     }
-    return *iface;
 }
 
 static const GBinderRpcProtocol gbinder_rpc_protocol_aidl2 = {
@@ -200,19 +300,17 @@ const char*
 gbinder_rpc_protocol_aidl3_read_rpc_header(
     GBinderReader* reader,
     guint32 txcode,
-    char** iface)
+    GBinderRpcIfaceBuf* iface)
 {
     if (txcode > GBINDER_TRANSACTION(0,0,0)) {
-        *iface = NULL;
+        return NULL;
     } else if (gbinder_reader_read_int32(reader, NULL) /* flags */ &&
         gbinder_reader_read_int32(reader, NULL) /* work source */ &&
         gbinder_reader_read_int32(reader, NULL) /* sys header */) {
-        *iface = gbinder_reader_read_string16(reader);
+        return gbinder_rpc_protocol_read_iface(reader, iface);
     } else {
-        *iface = NULL;
+        return NULL;
     }
-
-    return *iface;
 }
 
 static
@@ -306,9 +404,8 @@ const char*
 gbinder_rpc_protocol_hidl_read_rpc_header(
     GBinderReader* reader,
     guint32 txcode,
-    char** iface)
+    GBinderRpcIfaceBuf* iface)
 {
-    *iface = NULL;
     return gbinder_reader_read_string8(reader);
 }
 
@@ -392,10 +489,57 @@ gbinder_rpc_protocol_exit()
         g_hash_table_destroy(gbinder_rpc_protocol_map);
         gbinder_rpc_protocol_map = NULL;
     }
+    /* Lock */
+    g_rw_lock_writer_lock(&gbinder_rpc_iface_lock);
+    if (gbinder_rpc_iface_table) {
+        g_hash_table_destroy(gbinder_rpc_iface_table);
+        g_atomic_pointer_set(&gbinder_rpc_iface_table, NULL);
+    }
+    g_rw_lock_writer_unlock(&gbinder_rpc_iface_lock);
+    /* Unlock */
     /* Reset the default too, mostly for unit testing */
     gbinder_rpc_protocol_default = &DEFAULT_PROTOCOL;
 }
 
+void
+gbinder_rpc_protocol_register_iface(
+    const char* iface)
+{
+    glong len = 0;
+    gunichar2* utf16 = iface ?
+        g_utf8_to_utf16(iface, -1, NULL, &len, NULL) : NULL;
+
+    if (utf16) {
+        GBinderRpcIfaceKey key;
+
+        key.str = utf16;
+        key.len = len;
+
+        /* Lock */
+        g_rw_lock_writer_lock(&gbinder_rpc_iface_lock);
+        if (!gbinder_rpc_iface_table) {
+            g_atomic_pointer_set(&gbinder_rpc_iface_table,
+                g_hash_table_new_full(gbinder_rpc_iface_key_hash,
+                    gbinder_rpc_iface_key_equal, g_free, NULL));
+        }
+        if (!g_hash_table_lookup(gbinder_rpc_iface_table, &key)) {
+            /* Key and its UTF-16 data share the same memory block */
+            GBinderRpcIfaceKey* copy = g_malloc(sizeof(*copy) + len * 2);
+            gunichar2* chars = (gunichar2*)(copy + 1);
+
+            memcpy(chars, utf16, len * 2);
+            copy->str = chars;
+            copy->len = len;
+            g_hash_table_insert(gbinder_rpc_iface_table, copy, (gpointer)
+                g_intern_string(iface));
+        }
+        g_rw_lock_writer_unlock(&gbinder_rpc_iface_lock);
+        /* Unlock */
+
+        g_free(utf16);
+    }
+}
+
 /*==========================================================================*
  * Interface
  *==========================================================================*/
@@ -40,13 +40,26 @@
  * transaction headers and transaction codes.
  */
 
+/*
+ * Storage for the interface name extracted from the RPC header. Short
+ * ASCII names (which is pretty much all of them) are converted into the
+ * fixed size buffer, so that no memory gets allocated for the incoming
+ * transactions. Others are allocated from the heap.
+ */
+#define GBINDER_RPC_IFACE_BUF_SIZE (64)
+
+typedef struct gbinder_rpc_iface_buf {
+    char* alloc;
+    char buf[GBINDER_RPC_IFACE_BUF_SIZE];
+} GBinderRpcIfaceBuf;
+
 struct gbinder_rpc_protocol {
     const char* name;
     guint32 ping_tx;
     void (*write_ping)(GBinderWriter* writer);
     void (*write_rpc_header)(GBinderWriter* writer, const char* iface);
     const char* (*read_rpc_header)(GBinderReader* reader, guint32 txcode,
-        char** iface);
+        GBinderRpcIfaceBuf* iface);
 
     /*
      * For the sake of simplicity, let's assume that the trailer has a
@@ -71,6 +84,12 @@ gbinder_rpc_protocol_for_device(
     const char* dev)
     GBINDER_INTERNAL;
 
+/* Incoming requests for these interfaces are decoded without allocation */
+void
+gbinder_rpc_protocol_register_iface(
+    const char* iface)
+    GBINDER_INTERNAL;
+
 /* Runs at exit, declared here strictly for unit tests */
 void
 gbinder_rpc_protocol_exit(
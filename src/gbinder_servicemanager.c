@@ -93,9 +93,36 @@ static GHashTable* gbinder_servicemanager_map = NULL;
 static const GBinderServiceManagerType* gbinder_servicemanager_default =
     SERVICEMANAGER_TYPE_DEFAULT;
 
-#define PRESENSE_WAIT_MS_MIN  (100)
-#define PRESENSE_WAIT_MS_MAX  (1000)
-#define PRESENSE_WAIT_MS_STEP (100)
+/*
+ * Presence of a dead servicemanager is checked with exponentially
+ * growing and randomized intervals, so that a servicemanager restart
+ * doesn't get every process pinging it at the same time:
+ *
+ * [General]
+ * PresenceCheckMin = 100
+ * PresenceCheckMax = 1000
+ * PresenceCheckJitter = 20
+ *
+ * The first two are in milliseconds, the jitter is a percentage of
+ * the current interval by which each delay is randomly shifted.
+ */
+static const char CONF_PRESENCE_CHECK_MIN[] = "PresenceCheckMin";
+static const char CONF_PRESENCE_CHECK_MAX[] = "PresenceCheckMax";
+static const char CONF_PRESENCE_CHECK_JITTER[] = "PresenceCheckJitter";
+
+#define DEFAULT_PRESENCE_CHECK_MIN_MS (100)
+#define DEFAULT_PRESENCE_CHECK_MAX_MS (1000)
+#define DEFAULT_PRESENCE_CHECK_JITTER (20)
+#define MAX_PRESENCE_CHECK_MS (60000)
+
+typedef struct gbinder_servicemanager_backoff {
+    guint min_ms;
+    guint max_ms;
+    guint jitter;
+} GBinderServiceManagerBackoff;
+
+static GBinderServiceManagerBackoff gbinder_servicemanager_backoff;
+static gsize gbinder_servicemanager_backoff_loaded = 0;
 
 typedef struct gbinder_servicemanager_watch {
     char* name;
@@ -104,8 +131,18 @@ typedef struct gbinder_servicemanager_watch {
     gboolean watched;
 } GBinderServiceManagerWatch;
 
+typedef struct gbinder_servicemanager_cache_entry {
+    GBinderServiceManager* sm;
+    char* name;
+    GBinderRemoteObject* obj;
+    gulong death_id;
+} GBinderServiceManagerCacheEntry;
+
 struct gbinder_servicemanager_priv {
     GHashTable* watch_table;
+    GHashTable* cache; /* NULL if caching is disabled */
+    GBinderServiceManagerCacheStats cache_stats;
+    GHashTable* get_services; /* Bulk lookups in progress, by id */
     gulong death_id;
     gboolean present;
     GBinderEventLoopTimeout* presence_check;
@@ -173,6 +210,57 @@ gbinder_servicemanager_watch_new(
     return watch;
 }
 
+static
+guint
+gbinder_servicemanager_conf_int(
+    GKeyFile* k,
+    const char* key,
+    int def,
+    int min,
+    int max)
+{
+    if (k) {
+        GError* error = NULL;
+        const int value = g_key_file_get_integer(k,
+            GBINDER_CONFIG_GROUP_GENERAL, key, &error);
+
+        if (!error) {
+            return CLAMP(value, min, max);
+        }
+        g_error_free(error);
+    }
+    return def;
+}
+
+static
+const GBinderServiceManagerBackoff*
+gbinder_servicemanager_backoff_conf(
+    void)
+{
+    /*
+     * The presence check may be started on any thread, make sure that
+     * nobody sees a partially filled structure.
+     */
+    if (g_once_init_enter(&gbinder_servicemanager_backoff_loaded)) {
+        GBinderServiceManagerBackoff* backoff = &gbinder_servicemanager_backoff;
+        GKeyFile* k = gbinder_config_get();
+
+        backoff->min_ms = gbinder_servicemanager_conf_int(k,
+            CONF_PRESENCE_CHECK_MIN, DEFAULT_PRESENCE_CHECK_MIN_MS,
+            1, MAX_PRESENCE_CHECK_MS);
+        backoff->max_ms = gbinder_servicemanager_conf_int(k,
+            CONF_PRESENCE_CHECK_MAX, MAX(DEFAULT_PRESENCE_CHECK_MAX_MS,
+            backoff->min_ms), backoff->min_ms, MAX_PRESENCE_CHECK_MS);
+        backoff->jitter = gbinder_servicemanager_conf_int(k,
+            CONF_PRESENCE_CHECK_JITTER, DEFAULT_PRESENCE_CHECK_JITTER,
+            0, 100);
+        GDEBUG("Presence check %u..%u ms, jitter %u%%", backoff->min_ms,
+            backoff->max_ms, backoff->jitter);
+        g_once_init_leave(&gbinder_servicemanager_backoff_loaded, 1);
+    }
+    return &gbinder_servicemanager_backoff;
+}
+
 static
 void
 gbinder_servicemanager_watch_free(
@@ -185,6 +273,94 @@ gbinder_servicemanager_watch_free(
     g_free(watch);
 }
 
+/*
+ * The lookup cache is only touched on the main thread: by the sync
+ * calls, when async calls are submitted and completed, and by death
+ * and registration notifications.
+ */
+
+static
+void
+gbinder_servicemanager_cache_entry_free(
+    gpointer data)
+{
+    GBinderServiceManagerCacheEntry* entry = data;
+
+    gbinder_remote_object_remove_handler(entry->obj, entry->death_id);
+    gbinder_remote_object_unref(entry->obj);
+    g_free(entry->name);
+    g_slice_free(GBinderServiceManagerCacheEntry, entry);
+}
+
+static
+void
+gbinder_servicemanager_cache_entry_died(
+    GBinderRemoteObject* obj,
+    void* user_data)
+{
+    GBinderServiceManagerCacheEntry* entry = user_data;
+    GBinderServiceManagerPriv* priv = entry->sm->priv;
+
+    GDEBUG("Service %s has died", entry->name);
+    g_hash_table_remove(priv->cache, entry->name);
+}
+
+static
+GBinderRemoteObject*
+gbinder_servicemanager_cache_lookup(
+    GBinderServiceManager* self,
+    const char* name)
+{
+    GBinderServiceManagerPriv* priv = self->priv;
+
+    if (priv->cache) {
+        GBinderServiceManagerCacheEntry* entry =
+            g_hash_table_lookup(priv->cache, name);
+
+        if (entry) {
+            priv->cache_stats.hits++;
+            return entry->obj;
+        }
+        priv->cache_stats.misses++;
+    }
+    return NULL;
+}
+
+static
+void
+gbinder_servicemanager_cache_add(
+    GBinderServiceManager* self,
+    const char* name,
+    GBinderRemoteObject* obj)
+{
+    GBinderServiceManagerPriv* priv = self->priv;
+
+    /* Negative results are not cached */
+    if (priv->cache && obj && !obj->dead) {
+        GBinderServiceManagerCacheEntry* entry =
+            g_slice_new(GBinderServiceManagerCacheEntry);
+
+        entry->sm = self;
+        entry->name = g_strdup(name);
+        entry->obj = gbinder_remote_object_ref(obj);
+        entry->death_id = gbinder_remote_object_add_death_handler(obj,
+            gbinder_servicemanager_cache_entry_died, entry);
+        g_hash_table_replace(priv->cache, entry->name, entry);
+    }
+}
+
+static
+void
+gbinder_servicemanager_cache_clear(
+    GBinderServiceManager* self)
+{
+    GBinderServiceManagerPriv* priv = self->priv;
+
+    if (priv->cache) {
+        g_hash_table_remove_all(priv->cache);
+    }
+}
+
 typedef struct gbinder_servicemanager_list_tx_data {
     GBinderServiceManager* sm;
     GBinderServiceManagerListFunc func;
@@ -232,6 +408,7 @@ typedef struct gbinder_servicemanager_get_service_tx {
     GBinderServiceManager* sm;
     GBinderServiceManagerGetServiceFunc func;
     GBinderRemoteObject* obj;
+    gboolean cached;
     int status;
     char* name;
     void* user_data;
@@ -244,9 +421,11 @@ gbinder_servicemanager_get_service_tx_exec(
 {
     GBinderServiceManagerGetServiceTxData* data = tx->user_data;
 
-    data->obj = GBINDER_SERVICEMANAGER_GET_CLASS(data->sm)->
-        get_service(data->sm, data->name, &data->status,
-            &gbinder_ipc_sync_worker);
+    if (!data->cached) {
+        data->obj = GBINDER_SERVICEMANAGER_GET_CLASS(data->sm)->
+            get_service(data->sm, data->name, &data->status,
+                &gbinder_ipc_sync_worker);
+    }
 }
 
 static
@@ -256,6 +435,9 @@ gbinder_servicemanager_get_service_tx_done(
 {
     GBinderServiceManagerGetServiceTxData* data = tx->user_data;
 
+    if (!data->cached) {
+        gbinder_servicemanager_cache_add(data->sm, data->name, data->obj);
+    }
     data->func(data->sm, data->obj, data->status, data->user_data);
 }
 
@@ -272,6 +454,124 @@ gbinder_servicemanager_get_service_tx_free(
     g_slice_free(GBinderServiceManagerGetServiceTxData, data);
 }
 
+/*
+ * gbinder_servicemanager_get_services() submits a separate job for each
+ * name which needs to be looked up, so that the lookups run in parallel
+ * on the worker threads. The jobs share the results and complete the
+ * whole thing together. The id of the first job identifies all of them.
+ */
+typedef struct gbinder_servicemanager_get_services_tx
+    GBinderServiceManagerGetServicesTxData;
+
+typedef struct gbinder_servicemanager_get_services_job {
+    GBinderServiceManagerGetServicesTxData* data;
+    guint index; /* Equals data->count if there's nothing to look up */
+    gulong id;
+} GBinderServiceManagerGetServicesJob;
+
+struct gbinder_servicemanager_get_services_tx {
+    GBinderServiceManager* sm;
+    GBinderServiceManagerGetServicesFunc func;
+    char** names;
+    GBinderRemoteObject** objs;
+    guint count;
+    GBinderServiceManagerGetServicesJob* jobs;
+    guint njobs;
+    guint pending; /* Jobs not completed yet */
+    guint alive; /* Jobs not freed yet */
+    gulong id; /* Id of the first job */
+    void* user_data;
+};
+
+static
+void
+gbinder_servicemanager_get_services_tx_exec(
+    const GBinderIpcTx* tx)
+{
+    GBinderServiceManagerGetServicesJob* job = tx->user_data;
+    GBinderServiceManagerGetServicesTxData* data = job->data;
+
+    /* Each job only touches its own slot */
+    if (job->index < data->count) {
+        int status;
+
+        data->objs[job->index] = GBINDER_SERVICEMANAGER_GET_CLASS(data->sm)->
+            get_service(data->sm, data->names[job->index], &status,
+                &gbinder_ipc_sync_worker);
+    }
+}
+
+static
+void
+gbinder_servicemanager_get_services_tx_done(
+    const GBinderIpcTx* tx)
+{
+    GBinderServiceManagerGetServicesJob* job = tx->user_data;
+    GBinderServiceManagerGetServicesTxData* data = job->data;
+
+    if (job->index < data->count) {
+        gbinder_servicemanager_cache_add(data->sm, data->names[job->index],
+            data->objs[job->index]);
+    }
+    if (!--data->pending) {
+        g_hash_table_remove(data->sm->priv->get_services,
+            GSIZE_TO_POINTER(data->id));
+        data->func(data->sm, (const char* const*) data->names,
+            (GBinderRemoteObject* const*) data->objs, data->count,
+            data->user_data);
+    }
+}
+
+static
+void
+gbinder_servicemanager_get_services_tx_free(
+    gpointer user_data)
+{
+    GBinderServiceManagerGetServicesJob* job = user_data;
+    GBinderServiceManagerGetServicesTxData* data = job->data;
+
+    job->id = 0;
+    if (!--data->alive) {
+        guint i;
+
+        for (i = 0; i < data->count; i++) {
+            gbinder_remote_object_unref(data->objs[i]);
+        }
+        g_hash_table_remove(data->sm->priv->get_services,
+            GSIZE_TO_POINTER(data->id));
+        gbinder_servicemanager_unref(data->sm);
+        g_strfreev(data->names);
+        g_free(data->objs);
+        g_free(data->jobs);
+        g_slice_free(GBinderServiceManagerGetServicesTxData, data);
+    }
+}
+
+static
+gboolean
+gbinder_servicemanager_get_services_cancel(
+    GBinderServiceManager* self,
+    gulong id)
+{
+    GBinderServiceManagerPriv* priv = self->priv;
+    GBinderServiceManagerGetServicesTxData* data = priv->get_services ?
+        g_hash_table_lookup(priv->get_services, GSIZE_TO_POINTER(id)) : NULL;
+
+    if (data) {
+        GBinderIpc* ipc = gbinder_client_ipc(self->client);
+        guint i;
+
+        g_hash_table_remove(priv->get_services, GSIZE_TO_POINTER(id));
+        for (i = 0; i < data->njobs; i++) {
+            if (data->jobs[i].id) {
+                gbinder_ipc_cancel(ipc, data->jobs[i].id);
+            }
+        }
+        return TRUE;
+    }
+    return FALSE;
+}
+
 typedef struct gbinder_servicemanager_add_service_tx {
     GBinderServiceManager* sm;
     GBinderServiceManagerAddServiceFunc func;
@@ -358,7 +658,6 @@ gbinder_servicemanager_presense_check_timer(
     GBinderServiceManager* self = GBINDER_SERVICEMANAGER(user_data);
     GBinderRemoteObject* remote = self->client->remote;
     GBinderServiceManagerPriv* priv = self->priv;
-    gboolean result;
 
     GASSERT(remote->dead);
     gbinder_servicemanager_ref(self);
@@ -366,18 +665,17 @@ gbinder_servicemanager_presense_check_timer(
         /* Done */
         priv->presence_check = NULL;
         gbinder_servicemanager_reanimated(self);
-        result = G_SOURCE_REMOVE;
-    } else if (priv->presence_check_delay_ms < PRESENSE_WAIT_MS_MAX) {
-        priv->presence_check_delay_ms += PRESENSE_WAIT_MS_STEP;
-        priv->presence_check =
-            gbinder_timeout_add(priv->presence_check_delay_ms,
-                gbinder_servicemanager_presense_check_timer, self);
-        result = G_SOURCE_REMOVE;
     } else {
-        result = G_SOURCE_CONTINUE;
+        /* Each delay is randomized, even at the maximum interval */
+        priv->presence_check_delay_ms = gbinder_servicemanager_backoff_next
+            (priv->presence_check_delay_ms);
+        priv->presence_check = gbinder_timeout_add
+            (gbinder_servicemanager_backoff_delay
+                (priv->presence_check_delay_ms),
+                gbinder_servicemanager_presense_check_timer, self);
     }
     gbinder_servicemanager_unref(self);
-    return result;
+    return G_SOURCE_REMOVE;
 }
 
 static
@@ -388,9 +686,11 @@ gbinder_servicemanager_presence_check_start(
     GBinderServiceManagerPriv* priv = self->priv;
 
     GASSERT(!priv->presence_check);
-    priv->presence_check_delay_ms = PRESENSE_WAIT_MS_MIN;
-    priv->presence_check = gbinder_timeout_add(PRESENSE_WAIT_MS_MIN,
-        gbinder_servicemanager_presense_check_timer, self);
+    priv->presence_check_delay_ms =
+        gbinder_servicemanager_backoff_min();
+    priv->presence_check = gbinder_timeout_add
+        (gbinder_servicemanager_backoff_delay(priv->presence_check_delay_ms),
+            gbinder_servicemanager_presense_check_timer, self);
 }
 
 static
@@ -404,6 +704,7 @@ gbinder_servicemanager_died(
 
     GWARN("Service manager %s has died", self->dev);
     gbinder_servicemanager_presence_check_start(self);
+    gbinder_servicemanager_cache_clear(self);
 
     /* Will re-arm watches after servicemanager gets restarted */
     if (g_hash_table_size(priv->watch_table) > 0) {
@@ -426,6 +727,80 @@ gbinder_servicemanager_died(
     g_signal_emit(self, gbinder_servicemanager_signals[SIGNAL_PRESENCE], 0);
 }
 
+typedef struct gbinder_servicemanager_wait {
+    GBinderServiceManager* sm;
+    GBinderServiceManagerWaitFunc func;
+    void* user_data;
+    gulong id;
+    GBinderEventLoopTimeout* timeout;
+    GBinderEventLoopTimeout* idle;
+} GBinderServiceManagerWait;
+
+static
+void
+gbinder_servicemanager_wait_free(
+    gpointer data,
+    GClosure* closure)
+{
+    GBinderServiceManagerWait* wait = data;
+
+    gbinder_timeout_remove(wait->timeout);
+    gbinder_timeout_remove(wait->idle);
+    g_slice_free(GBinderServiceManagerWait, wait);
+}
+
+static
+void
+gbinder_servicemanager_wait_finish(
+    GBinderServiceManagerWait* wait,
+    gboolean present)
+{
+    GBinderServiceManager* sm = gbinder_servicemanager_ref(wait->sm);
+    GBinderServiceManagerWaitFunc func = wait->func;
+    void* user_data = wait->user_data;
+
+    /* This deallocates GBinderServiceManagerWait */
+    g_signal_handler_disconnect(sm, wait->id);
+    func(sm, present, user_data);
+    gbinder_servicemanager_unref(sm);
+}
+
+static
+void
+gbinder_servicemanager_wait_presence(
+    GBinderServiceManager* sm,
+    void* user_data)
+{
+    if (gbinder_servicemanager_is_present(sm)) {
+        gbinder_servicemanager_wait_finish(user_data, TRUE);
+    }
+}
+
+static
+gboolean
+gbinder_servicemanager_wait_timeout(
+    gpointer user_data)
+{
+    GBinderServiceManagerWait* wait = user_data;
+
+    wait->timeout = NULL;
+    gbinder_servicemanager_wait_finish(wait, FALSE);
+    return G_SOURCE_REMOVE;
+}
+
+static
+gboolean
+gbinder_servicemanager_wait_idle(
+    gpointer user_data)
+{
+    GBinderServiceManagerWait* wait = user_data;
+
+    wait->idle = NULL;
+    gbinder_servicemanager_wait_finish(wait,
+        gbinder_servicemanager_is_present(wait->sm));
+    return G_SOURCE_REMOVE;
+}
+
 static
 void
 gbinder_servicemanager_sleep_ms(
@@ -509,12 +884,49 @@ gbinder_servicemanager_exit(
     }
     /* Reset the default too, mostly for unit testing */
     gbinder_servicemanager_default = SERVICEMANAGER_TYPE_DEFAULT;
+    /* Nothing else can be running at this point */
+    gbinder_servicemanager_backoff_loaded = 0;
 }
 
 /*==========================================================================*
  * Internal interface
  *==========================================================================*/
 
+guint
+gbinder_servicemanager_backoff_min(
+    void)
+{
+    return gbinder_servicemanager_backoff_conf()->min_ms;
+}
+
+guint
+gbinder_servicemanager_backoff_next(
+    guint interval_ms)
+{
+    const GBinderServiceManagerBackoff* backoff =
+        gbinder_servicemanager_backoff_conf();
+
+    return (interval_ms < backoff->max_ms / 2) ? (interval_ms * 2) :
+        backoff->max_ms;
+}
+
+guint
+gbinder_servicemanager_backoff_delay(
+    guint interval_ms)
+{
+    const guint spread = interval_ms *
+        gbinder_servicemanager_backoff_conf()->jitter / 100;
+
+    if (spread) {
+        const guint delay = interval_ms - spread +
+            g_random_int_range(0, 2 * spread + 1);
+
+        return MAX(delay, 1);
+    } else {
+        return interval_ms;
+    }
+}
+
 GBinderServiceManager*
 gbinder_servicemanager_new_with_type(
     GType type,
@@ -608,6 +1020,10 @@ gbinder_servicemanager_service_registered(
         watch = g_hash_table_lookup(priv->watch_table, normalized_name);
     }
     g_free(tmp_name);
+    if (priv->cache) {
+        /* The name may now refer to a different object */
+        g_hash_table_remove(priv->cache, name);
+    }
     g_signal_emit(self, gbinder_servicemanager_signals[SIGNAL_REGISTRATION],
         watch ? watch->quark : 0, name);
 }
@@ -703,6 +1119,22 @@ gbinder_servicemanager_new_local_object2(
     return NULL;
 }
 
+GBinderLocalObject*
+gbinder_servicemanager_new_local_object_concurrent(
+    GBinderServiceManager* self,
+    const char* const* ifaces,
+    GBinderLocalTransactFunc txproc,
+    void* user_data,
+    GDestroyNotify destroy) /* Since 1.1.43 */
+{
+    if (G_LIKELY(self)) {
+        return gbinder_local_object_new_concurrent
+            (gbinder_client_ipc(self->client), ifaces, txproc, user_data,
+                destroy);
+    }
+    return NULL;
+}
+
 GBinderServiceManager*
 gbinder_servicemanager_ref(
     GBinderServiceManager* self)
@@ -736,6 +1168,16 @@ gbinder_servicemanager_is_present(
     return G_LIKELY(self) && !self->client->remote->dead;
 }
 
+gboolean
+gbinder_servicemanager_set_looper_limits(
+    GBinderServiceManager* self,
+    guint min_loopers,
+    guint max_loopers) /* Since 1.1.43 */
+{
+    return G_LIKELY(self) && gbinder_ipc_set_looper_limits
+        (gbinder_servicemanager_ipc(self), min_loopers, max_loopers);
+}
+
 gboolean
 gbinder_servicemanager_wait(
     GBinderServiceManager* self,
@@ -751,9 +1193,12 @@ gbinder_servicemanager_wait(
             return TRUE;
         } else if (max_wait_ms != 0) {
             /* Zero timeout means a singe check and it's already done */
-            long delay_ms = PRESENSE_WAIT_MS_MIN;
+            guint interval_ms = gbinder_servicemanager_backoff_min();
 
             while (max_wait_ms != 0) {
+                long delay_ms =
+                    gbinder_servicemanager_backoff_delay(interval_ms);
+
                 if (max_wait_ms > 0) {
                     if (max_wait_ms < delay_ms) {
                         delay_ms = max_wait_ms;
@@ -767,12 +1212,7 @@ gbinder_servicemanager_wait(
                     gbinder_servicemanager_reanimated(self);
                     return TRUE;
                 }
-                if (delay_ms < PRESENSE_WAIT_MS_MAX) {
-                    delay_ms += PRESENSE_WAIT_MS_STEP;
-                    if (delay_ms > PRESENSE_WAIT_MS_MAX) {
-                        delay_ms = PRESENSE_WAIT_MS_MAX;
-                    }
-                }
+                interval_ms = gbinder_servicemanager_backoff_next(interval_ms);
             }
             /* Timeout */
             GWARN("Timeout waiting for service manager %s", self->dev);
@@ -781,6 +1221,42 @@ gbinder_servicemanager_wait(
     return FALSE;
 }
 
+gulong
+gbinder_servicemanager_wait_async(
+    GBinderServiceManager* self,
+    long max_wait_ms,
+    GBinderServiceManagerWaitFunc func,
+    void* user_data) /* Since 1.1.43 */
+{
+    if (G_LIKELY(self) && G_LIKELY(func)) {
+        GBinderServiceManagerWait* wait =
+            g_slice_new0(GBinderServiceManagerWait);
+
+        wait->sm = self;
+        wait->func = func;
+        wait->user_data = user_data;
+        wait->id = g_signal_connect_data(self, SIGNAL_PRESENCE_NAME,
+            G_CALLBACK(gbinder_servicemanager_wait_presence), wait,
+            gbinder_servicemanager_wait_free, 0);
+
+        /*
+         * Nothing is done here synchronously. If servicemanager is
+         * already known to be there, or we aren't supposed to wait,
+         * the result is delivered on idle. Otherwise the presence
+         * check (which is already running) will let us know.
+         */
+        if (!self->client->remote->dead || !max_wait_ms) {
+            wait->idle = gbinder_idle_add(gbinder_servicemanager_wait_idle,
+                wait);
+        } else if (max_wait_ms > 0) {
+            wait->timeout = gbinder_timeout_add(max_wait_ms,
+                gbinder_servicemanager_wait_timeout, wait);
+        }
+        return wait->id;
+    }
+    return 0;
+}
+
 gulong
 gbinder_servicemanager_list(
     GBinderServiceManager* self,
@@ -830,6 +1306,13 @@ gbinder_servicemanager_get_service(
         data->name = g_strdup(name);
         data->user_data = user_data;
         data->status = (-EFAULT);
+        data->obj = gbinder_remote_object_ref
+            (gbinder_servicemanager_cache_lookup(self, name));
+        if (data->obj) {
+            /* Still completes asynchronously but without IPC */
+            data->cached = TRUE;
+            data->status = GBINDER_STATUS_OK;
+        }
 
         return gbinder_ipc_transact_custom(gbinder_client_ipc(self->client),
             gbinder_servicemanager_get_service_tx_exec,
@@ -839,6 +1322,67 @@ gbinder_servicemanager_get_service(
     return 0;
 }
 
+gulong
+gbinder_servicemanager_get_services(
+    GBinderServiceManager* self,
+    const char* const* names,
+    GBinderServiceManagerGetServicesFunc func,
+    void* user_data) /* Since 1.1.43 */
+{
+    if (G_LIKELY(self) && func && names && names[0]) {
+        GBinderServiceManagerPriv* priv = self->priv;
+        GBinderIpc* ipc = gbinder_client_ipc(self->client);
+        GBinderServiceManagerGetServicesTxData* data =
+            g_slice_new0(GBinderServiceManagerGetServicesTxData);
+        guint i;
+
+        data->sm = gbinder_servicemanager_ref(self);
+        data->func = func;
+        data->names = g_strdupv((char**) names);
+        data->count = g_strv_length(data->names);
+        data->objs = g_new0(GBinderRemoteObject*, data->count);
+        data->jobs = g_new0(GBinderServiceManagerGetServicesJob,
+            data->count);
+        data->user_data = user_data;
+
+        /* Only the names missing from the cache need to be looked up */
+        for (i = 0; i < data->count; i++) {
+            data->objs[i] = gbinder_remote_object_ref
+                (gbinder_servicemanager_cache_lookup(self, names[i]));
+            if (!data->objs[i]) {
+                data->jobs[data->njobs++].index = i;
+            }
+        }
+
+        /* Even if everything is cached, still complete asynchronously */
+        if (!data->njobs) {
+            data->jobs[data->njobs++].index = data->count;
+        }
+
+        /* Completions are handled on the main thread, i.e. not yet */
+        data->pending = data->alive = data->njobs;
+        for (i = 0; i < data->njobs; i++) {
+            GBinderServiceManagerGetServicesJob* job = data->jobs + i;
+
+            job->data = data;
+            job->id = gbinder_ipc_transact_custom(ipc,
+                gbinder_servicemanager_get_services_tx_exec,
+                gbinder_servicemanager_get_services_tx_done,
+                gbinder_servicemanager_get_services_tx_free, job);
+        }
+
+        if (!priv->get_services) {
+            priv->get_services = g_hash_table_new(g_direct_hash,
+                g_direct_equal);
+        }
+        data->id = data->jobs[0].id;
+        g_hash_table_insert(priv->get_services, GSIZE_TO_POINTER(data->id),
+            data);
+        return data->id;
+    }
+    return 0;
+}
+
 GBinderRemoteObject* /* autoreleased */
 gbinder_servicemanager_get_service_sync(
     GBinderServiceManager* self,
@@ -848,8 +1392,15 @@ gbinder_servicemanager_get_service_sync(
     GBinderRemoteObject* obj = NULL;
 
     if (G_LIKELY(self) && name) {
-        obj = GBINDER_SERVICEMANAGER_GET_CLASS(self)->
-            get_service(self, name, status, &gbinder_ipc_sync_main);
+        obj = gbinder_remote_object_ref
+            (gbinder_servicemanager_cache_lookup(self, name));
+        if (obj) {
+            if (status) *status = GBINDER_STATUS_OK;
+        } else {
+            obj = GBINDER_SERVICEMANAGER_GET_CLASS(self)->
+                get_service(self, name, status, &gbinder_ipc_sync_main);
+            gbinder_servicemanager_cache_add(self, name, obj);
+        }
         if (obj) {
             GBinderServiceManagerPriv* priv = self->priv;
 
@@ -906,12 +1457,45 @@ gbinder_servicemanager_add_service_sync(
     }
 }
 
+void
+gbinder_servicemanager_set_cache_enabled(
+    GBinderServiceManager* self,
+    gboolean enabled) /* Since 1.1.43 */
+{
+    if (G_LIKELY(self)) {
+        GBinderServiceManagerPriv* priv = self->priv;
+
+        if (enabled && !priv->cache) {
+            priv->cache = g_hash_table_new_full(g_str_hash, g_str_equal,
+                NULL, gbinder_servicemanager_cache_entry_free);
+        } else if (!enabled && priv->cache) {
+            g_hash_table_destroy(priv->cache);
+            priv->cache = NULL;
+        }
+    }
+}
+
+void
+gbinder_servicemanager_get_cache_stats(
+    GBinderServiceManager* self,
+    GBinderServiceManagerCacheStats* stats) /* Since 1.1.43 */
+{
+    if (G_LIKELY(stats)) {
+        if (G_LIKELY(self)) {
+            *stats = self->priv->cache_stats;
+        } else {
+            memset(stats, 0, sizeof(*stats));
+        }
+    }
+}
+
 void
 gbinder_servicemanager_cancel(
     GBinderServiceManager* self,
     gulong id)
 {
-    if (G_LIKELY(self)) {
+    if (G_LIKELY(self) && !gbinder_servicemanager_get_services_cancel(self,
+        id)) {
         gbinder_ipc_cancel(gbinder_client_ipc(self->client), id);
     }
 }
@@ -1118,6 +1702,12 @@ gbinder_servicemanager_finalize(
     gbinder_remote_object_remove_handler(self->client->remote, priv->death_id);
     gbinder_idle_callback_destroy(priv->autorelease_cb);
     g_slist_free_full(priv->autorelease, g_object_unref);
+    if (priv->cache) {
+        g_hash_table_destroy(priv->cache);
+    }
+    if (priv->get_services) {
+        g_hash_table_destroy(priv->get_services);
+    }
     g_hash_table_destroy(priv->watch_table);
     gbinder_client_unref(self->client);
     G_OBJECT_CLASS(PARENT_CLASS)->finalize(object);
@@ -36,16 +36,33 @@
 #include "gbinder_client_p.h"
 #include "gbinder_log.h"
 
+#include <gbinder_local_object.h>
 #include <gbinder_local_request.h>
 #include <gbinder_remote_reply.h>
+#include <gbinder_remote_request.h>
+#include <gbinder_reader.h>
+#include <gbinder_writer.h>
+
+typedef struct gbinder_servicemanager_aidl_watch_call
+    GBinderServiceManagerAidlWatchCall;
 
 typedef struct gbinder_servicemanager_aidl_watch {
+    GBinderServiceManagerAidl* manager;
     GBinderServicePoll* poll;
     char* name;
     gulong handler_id;
     GBinderEventLoopTimeout* notify;
+    GBinderLocalObject* callback;
+    GBinderServiceManagerAidlWatchCall* call; /* Registration in progress */
 } GBinderServiceManagerAidlWatch;
 
+struct gbinder_servicemanager_aidl_watch_call {
+    const GBinderServiceManagerAidlClass* klass;
+    GBinderLocalObject* callback;
+    GBinderServiceManagerAidlWatch* watch; /* NULL if abandoned */
+    char* name; /* Only set when abandoned */
+};
+
 struct gbinder_servicemanager_aidl_priv {
     GBinderServicePoll* poll;
     GHashTable* watch_table;
@@ -61,6 +78,11 @@ G_DEFINE_TYPE(GBinderServiceManagerAidl,
     GBinderServiceManagerAidl)
 
 #define SERVICEMANAGER_AIDL_IFACE  "android.os.IServiceManager"
+#define SERVICEMANAGER_AIDL_CALLBACK_IFACE "android.os.IServiceCallback"
+
+enum gbinder_servicemanager_aidl_notifications {
+    ON_REGISTRATION_TRANSACTION = GBINDER_FIRST_CALL_TRANSACTION
+};
 
 static
 void
@@ -99,6 +121,87 @@ gbinder_servicemanager_aidl_watch_notify(
     return G_SOURCE_REMOVE;
 }
 
+static
+GBinderLocalReply*
+gbinder_servicemanager_aidl_notification(
+    GBinderLocalObject* obj,
+    GBinderRemoteRequest* req,
+    guint code,
+    guint flags,
+    int* status,
+    void* user_data)
+{
+    GBinderServiceManager* manager = user_data;
+    const char* iface = gbinder_remote_request_interface(req);
+
+    if (!g_strcmp0(iface, SERVICEMANAGER_AIDL_CALLBACK_IFACE) &&
+        code == ON_REGISTRATION_TRANSACTION) {
+        GBinderReader reader;
+        char* name;
+
+        /* oneway void onRegistration(String name, IBinder binder) */
+        gbinder_remote_request_init_reader(req, &reader);
+        name = gbinder_reader_read_string16(&reader);
+        if (name) {
+            GDEBUG(SERVICEMANAGER_AIDL_CALLBACK_IFACE " onRegistration %s",
+                name);
+            gbinder_servicemanager_service_registered(manager, name);
+            g_free(name);
+            *status = GBINDER_STATUS_OK;
+        } else {
+            GWARN("Failed to parse IServiceCallback::onRegistration payload");
+            *status = GBINDER_STATUS_FAILED;
+        }
+    } else {
+        GDEBUG("%s %u", iface, code);
+        *status = GBINDER_STATUS_FAILED;
+    }
+    return NULL;
+}
+
+static
+void
+gbinder_servicemanager_aidl_watch_poll(
+    GBinderServiceManagerAidlWatch* watch)
+{
+    GBinderServiceManagerAidl* self = watch->manager;
+    GBinderServiceManagerAidlPriv* priv = self->priv;
+
+    watch->poll = gbinder_servicepoll_new(&self->manager, &priv->poll);
+    watch->handler_id = gbinder_servicepoll_add_handler(priv->poll,
+        gbinder_servicemanager_aidl_watch_proc, watch);
+    if (gbinder_servicepoll_is_known_name(watch->poll, watch->name)) {
+        watch->notify = gbinder_idle_add
+            (gbinder_servicemanager_aidl_watch_notify, watch);
+    }
+}
+
+static
+void
+gbinder_servicemanager_aidl_unregister(
+    const GBinderServiceManagerAidlClass* klass,
+    GBinderClient* client,
+    const char* name,
+    GBinderLocalObject* cb)
+{
+    GBinderLocalObject* callback = gbinder_local_object_ref(cb);
+    GBinderLocalRequest* req = klass->notifications_req(client, name,
+        callback);
+
+    /*
+     * Unlike hwservicemanager, servicemanager doesn't drop the callback
+     * until it's explicitly unregistered (or dies). Nobody is interested
+     * in the result, the extra reference keeps the callback alive until
+     * the transaction completes.
+     */
+    if (!gbinder_client_transact(client,
+        UNREGISTER_FOR_NOTIFICATIONS_TRANSACTION, 0, req, NULL,
+        (GDestroyNotify) gbinder_local_object_unref, callback)) {
+        gbinder_local_object_unref(callback);
+    }
+    gbinder_local_request_unref(req);
+}
+
 static
 void
 gbinder_servicemanager_aidl_watch_free(
@@ -106,6 +209,27 @@ gbinder_servicemanager_aidl_watch_free(
 {
     GBinderServiceManagerAidlWatch* watch = user_data;
 
+    if (watch->callback) {
+        GBinderServiceManagerAidlWatchCall* call = watch->call;
+
+        if (call) {
+            /*
+             * The registration request may have already reached
+             * servicemanager. Unregistering right away could overtake
+             * it, so the unregistration is sent when the registration
+             * completes.
+             */
+            call->watch = NULL;
+            call->name = g_strdup(watch->name);
+        } else {
+            /* Registration has completed successfully */
+            gbinder_servicemanager_aidl_unregister
+                (GBINDER_SERVICEMANAGER_AIDL_GET_CLASS(watch->manager),
+                    watch->manager->manager.client, watch->name,
+                    watch->callback);
+        }
+        gbinder_local_object_drop(watch->callback);
+    }
     gbinder_timeout_remove(watch->notify);
     gbinder_servicepoll_remove_handler(watch->poll, watch->handler_id);
     gbinder_servicepoll_unref(watch->poll);
@@ -113,20 +237,107 @@ gbinder_servicemanager_aidl_watch_free(
     g_slice_free(GBinderServiceManagerAidlWatch, watch);
 }
 
+static
+void
+gbinder_servicemanager_aidl_watch_call_reply(
+    GBinderClient* client,
+    GBinderRemoteReply* reply,
+    int tx_status,
+    void* user_data)
+{
+    GBinderServiceManagerAidlWatchCall* call = user_data;
+    GBinderServiceManagerAidlWatch* watch = call->watch;
+    gint32 status;
+    const gboolean ok = tx_status == GBINDER_STATUS_OK &&
+        gbinder_remote_reply_read_int32(reply, &status) &&
+        status == GBINDER_STATUS_OK;
+
+    if (!watch) {
+        /* The watch is gone, undo the registration */
+        if (ok) {
+            gbinder_servicemanager_aidl_unregister(call->klass, client,
+                call->name, call->callback);
+        }
+        return;
+    }
+
+    watch->call = NULL;
+    if (ok) {
+        /* Successfully registered */
+        GDEBUG("Registered for %s notifications", watch->name);
+        return;
+    }
+
+    /* Fall back to polling, servicemanager may not let us register */
+    GWARN("registerForNotifications(%s) failed, polling", watch->name);
+    gbinder_local_object_drop(watch->callback);
+    watch->callback = NULL;
+    gbinder_servicemanager_aidl_watch_poll(watch);
+}
+
+static
+void
+gbinder_servicemanager_aidl_watch_call_destroy(
+    void* user_data)
+{
+    GBinderServiceManagerAidlWatchCall* call = user_data;
+
+    gbinder_local_object_unref(call->callback);
+    g_free(call->name);
+    g_slice_free(GBinderServiceManagerAidlWatchCall, call);
+}
+
+static
+void
+gbinder_servicemanager_aidl_watch_register(
+    GBinderServiceManagerAidlWatch* watch)
+{
+    GBinderServiceManager* manager = &watch->manager->manager;
+    GBinderClient* client = manager->client;
+    GBinderServiceManagerAidlWatchCall* call =
+        g_slice_new0(GBinderServiceManagerAidlWatchCall);
+    GBinderLocalRequest* req;
+
+    watch->callback = gbinder_servicemanager_new_local_object(manager,
+        SERVICEMANAGER_AIDL_CALLBACK_IFACE,
+        gbinder_servicemanager_aidl_notification, manager);
+    req = GBINDER_SERVICEMANAGER_AIDL_GET_CLASS(manager)->
+        notifications_req(client, watch->name, watch->callback);
+
+    /*
+     * The call keeps an additional reference to the callback object
+     * for the duration of the (asynchronous) transaction, to make sure
+     * that the object pointer passed to the kernel remains valid.
+     */
+    call->klass = GBINDER_SERVICEMANAGER_AIDL_GET_CLASS(manager);
+    call->watch = watch;
+    call->callback = gbinder_local_object_ref(watch->callback);
+    if (gbinder_client_transact(client,
+        REGISTER_FOR_NOTIFICATIONS_TRANSACTION, 0, req,
+        gbinder_servicemanager_aidl_watch_call_reply,
+        gbinder_servicemanager_aidl_watch_call_destroy, call)) {
+        watch->call = call;
+        gbinder_local_request_unref(req);
+    } else {
+        gbinder_local_request_unref(req);
+        gbinder_servicemanager_aidl_watch_call_destroy(call);
+        gbinder_local_object_drop(watch->callback);
+        watch->callback = NULL;
+        gbinder_servicemanager_aidl_watch_poll(watch);
+    }
+}
+
 static
 GBinderServiceManagerAidlWatch*
 gbinder_servicemanager_aidl_watch_new(
     GBinderServiceManagerAidl* self,
     const char* name)
 {
-    GBinderServiceManagerAidlPriv* priv = self->priv;
     GBinderServiceManagerAidlWatch* watch =
         g_slice_new0(GBinderServiceManagerAidlWatch);
 
+    watch->manager = self;
     watch->name = g_strdup(name);
-    watch->poll = gbinder_servicepoll_new(&self->manager, &priv->poll);
-    watch->handler_id = gbinder_servicepoll_add_handler(priv->poll,
-        gbinder_servicemanager_aidl_watch_proc, watch);
     return watch;
 }
 
@@ -134,11 +345,14 @@ static
 GBinderLocalRequest*
 gbinder_servicemanager_aidl_list_services_req(
     GBinderClient* client,
-    gint32 index)
+    gsize* index_offset)
 {
     GBinderLocalRequest* req = gbinder_client_new_request(client);
+    GBinderWriter writer;
 
-    gbinder_local_request_append_int32(req, index);
+    gbinder_local_request_init_writer(req, &writer);
+    *index_offset = gbinder_writer_bytes_written(&writer);
+    gbinder_writer_append_int32(&writer, 0);
     return req;
 }
 
@@ -167,9 +381,18 @@ gbinder_servicemanager_aidl_list(
     GBinderClient* client = manager->client;
     GBinderServiceManagerAidlClass* klass =
         GBINDER_SERVICEMANAGER_AIDL_GET_CLASS(manager);
-    GBinderLocalRequest* req = klass->list_services_req(client, 0);
     GBinderRemoteReply* reply;
-
+    GBinderWriter writer;
+    gsize index_offset;
+    GBinderLocalRequest* req = klass->list_services_req(client,
+        &index_offset);
+
+    /*
+     * The same request is sent over and over again (one name per
+     * round trip is all this servicemanager can do), only the index
+     * gets updated.
+     */
+    gbinder_local_request_init_writer(req, &writer);
     while ((reply = gbinder_client_transact_sync_reply2(client,
         LIST_SERVICES_TRANSACTION, req, NULL, api)) != NULL) {
         char* service = gbinder_remote_reply_read_string16(reply);
@@ -177,8 +400,7 @@ gbinder_servicemanager_aidl_list(
         gbinder_remote_reply_unref(reply);
         if (service) {
             g_ptr_array_add(list, service);
-            gbinder_local_request_unref(req);
-            req = klass->list_services_req(client, list->len);
+            gbinder_writer_overwrite_int32(&writer, index_offset, list->len);
         } else {
             break;
         }
@@ -252,9 +474,11 @@ gbinder_servicemanager_aidl_watch(
         gbinder_servicemanager_aidl_watch_new(self, name);
 
     g_hash_table_replace(priv->watch_table, watch->name, watch);
-    if (gbinder_servicepoll_is_known_name(watch->poll, name)) {
-        watch->notify = gbinder_idle_add
-            (gbinder_servicemanager_aidl_watch_notify, watch);
+    if (GBINDER_SERVICEMANAGER_AIDL_GET_CLASS(self)->notifications_req) {
+        /* Android 11+ pushes registration notifications to us */
+        gbinder_servicemanager_aidl_watch_register(watch);
+    } else {
+        gbinder_servicemanager_aidl_watch_poll(watch);
     }
     return TRUE;
 }
@@ -307,6 +531,7 @@ gbinder_servicemanager_aidl_class_init(
     g_type_class_add_private(klass, sizeof(GBinderServiceManagerAidlPriv));
     klass->list_services_req = gbinder_servicemanager_aidl_list_services_req;
     klass->add_service_req = gbinder_servicemanager_aidl_add_service_req;
+    /* notifications_req is NULL, registrations are polled */
 
     manager->iface = SERVICEMANAGER_AIDL_IFACE;
     manager->default_device = GBINDER_DEFAULT_BINDER;
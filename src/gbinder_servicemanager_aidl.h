@@ -43,10 +43,14 @@ typedef struct gbinder_servicemanager_aidl {
 
 typedef struct gbinder_servicemanager_aidl_class {
     GBinderServiceManagerClass parent;
+    /* Returns the offset of the int32 index, to be patched in place */
     GBinderLocalRequest* (*list_services_req)
-        (GBinderClient* client, gint32 index);
+        (GBinderClient* client, gsize* index_offset);
     GBinderLocalRequest* (*add_service_req)
         (GBinderClient* client, const char* name, GBinderLocalObject* obj);
+    /* Optional, NULL if registration notifications aren't supported */
+    GBinderLocalRequest* (*notifications_req)
+        (GBinderClient* client, const char* name, GBinderLocalObject* cb);
 } GBinderServiceManagerAidlClass;
 
 #define GBINDER_TYPE_SERVICEMANAGER_AIDL \
@@ -59,7 +63,10 @@ enum gbinder_servicemanager_aidl_calls {
     GET_SERVICE_TRANSACTION = GBINDER_FIRST_CALL_TRANSACTION,
     CHECK_SERVICE_TRANSACTION,
     ADD_SERVICE_TRANSACTION,
-    LIST_SERVICES_TRANSACTION
+    LIST_SERVICES_TRANSACTION,
+    /* Android 11+ */
+    REGISTER_FOR_NOTIFICATIONS_TRANSACTION,
+    UNREGISTER_FOR_NOTIFICATIONS_TRANSACTION
 };
 
 #define DUMP_FLAG_PRIORITY_DEFAULT (0x08)
@@ -34,6 +34,7 @@
 
 #include <gbinder_client.h>
 #include <gbinder_local_request.h>
+#include <gbinder_writer.h>
 
 /* Variant of AIDL servicemanager appeared in Android 9 (API level 28) */
 
@@ -50,12 +51,15 @@ static
 GBinderLocalRequest*
 gbinder_servicemanager_aidl2_list_services_req(
     GBinderClient* client,
-    gint32 index)
+    gsize* index_offset)
 {
     GBinderLocalRequest* req = gbinder_client_new_request(client);
+    GBinderWriter writer;
 
-    gbinder_local_request_append_int32(req, index);
-    gbinder_local_request_append_int32(req, DUMP_FLAG_PRIORITY_ALL);
+    gbinder_local_request_init_writer(req, &writer);
+    *index_offset = gbinder_writer_bytes_written(&writer);
+    gbinder_writer_append_int32(&writer, 0);
+    gbinder_writer_append_int32(&writer, DUMP_FLAG_PRIORITY_ALL);
     return req;
 }
 
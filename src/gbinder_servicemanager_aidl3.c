@@ -118,6 +118,23 @@ gbinder_servicemanager_aidl3_list(
     return (char**)g_ptr_array_free(list, FALSE);
 }
 
+GBinderLocalRequest*
+gbinder_servicemanager_aidl3_notifications_req(
+    GBinderClient* client,
+    const char* name,
+    GBinderLocalObject* cb)
+{
+    GBinderLocalRequest* req = gbinder_client_new_request(client);
+
+    /*
+     * Both registerForNotifications and unregisterForNotifications
+     * take (String name, IServiceCallback callback)
+     */
+    gbinder_local_request_append_string16(req, name);
+    gbinder_local_request_append_local_object(req, cb);
+    return req;
+}
+
 static
 GBinderLocalRequest*
 gbinder_servicemanager_aidl3_add_service_req(
@@ -149,6 +166,7 @@ gbinder_servicemanager_aidl3_class_init(
     GBinderServiceManagerClass* manager = GBINDER_SERVICEMANAGER_CLASS(klass);
 
     klass->add_service_req = gbinder_servicemanager_aidl3_add_service_req;
+    klass->notifications_req = gbinder_servicemanager_aidl3_notifications_req;
     manager->list = gbinder_servicemanager_aidl3_list;
     manager->get_service = gbinder_servicemanager_aidl3_get_service;
 }
@@ -101,6 +101,7 @@ gbinder_servicemanager_aidl4_class_init(
 {
     GBinderServiceManagerClass* manager = GBINDER_SERVICEMANAGER_CLASS(cls);
     cls->add_service_req = gbinder_servicemanager_aidl4_add_service_req;
+    cls->notifications_req = gbinder_servicemanager_aidl3_notifications_req;
     manager->list = gbinder_servicemanager_aidl3_list;
     manager->get_service = gbinder_servicemanager_aidl3_get_service;
 }
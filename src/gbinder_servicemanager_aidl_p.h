@@ -50,6 +50,13 @@ gbinder_servicemanager_aidl3_get_service(
     const GBinderIpcSyncApi* api)
     GBINDER_INTERNAL;
 
+GBinderLocalRequest*
+gbinder_servicemanager_aidl3_notifications_req(
+    GBinderClient* client,
+    const char* name,
+    GBinderLocalObject* cb)
+    GBINDER_INTERNAL;
+
 #endif /* GBINDER_SERVICEMANAGER_AIDL_PRIVATE_H */
 
 /*
@@ -99,6 +99,21 @@ gbinder_servicemanager_service_registered(
     const char* name)
     GBINDER_INTERNAL;
 
+guint
+gbinder_servicemanager_backoff_min(
+    void)
+    GBINDER_INTERNAL;
+
+guint
+gbinder_servicemanager_backoff_next(
+    guint interval_ms)
+    GBINDER_INTERNAL;
+
+guint
+gbinder_servicemanager_backoff_delay(
+    guint interval_ms)
+    GBINDER_INTERNAL;
+
 /* Declared for unit tests */
 void
 gbinder_servicemanager_exit(
@@ -35,6 +35,7 @@
 #include "gbinder_fmq_p.h"
 #include "gbinder_local_object.h"
 #include "gbinder_object_converter.h"
+#include "gbinder_remote_object.h"
 #include "gbinder_io.h"
 #include "gbinder_log.h"
 
@@ -83,6 +84,7 @@ gbinder_writer_data_set_contents(
     gutil_int_array_set_count(data->offsets, 0);
     data->buffers_size = 0;
     gbinder_cleanup_reset(data->cleanup);
+    gbinder_arena_reset(&data->arena);
     gbinder_writer_data_append_contents(data, buffer, 0, convert);
 }
 
@@ -320,6 +322,88 @@ gbinder_writer_overwrite_int32(
     }
 }
 
+void
+gbinder_writer_overwrite_int64(
+    GBinderWriter* self,
+    gsize offset,
+    gint64 value) /* Since 1.1.43 */
+{
+    GBinderWriterData* data = gbinder_writer_data(self);
+
+    if (G_LIKELY(data)) {
+        GByteArray* buf = data->bytes;
+
+        if (buf->len >= offset + sizeof(gint64)) {
+            *((gint64*)(buf->data + offset)) = value;
+        } else {
+            GWARN("Can't overwrite at %lu as buffer is only %u bytes long",
+                (gulong)offset, buf->len);
+        }
+    }
+}
+
+static
+gboolean
+gbinder_writer_data_has_object(
+    GBinderWriterData* data,
+    gsize offset)
+{
+    return data->offsets && offset < data->bytes->len &&
+        gutil_int_array_contains(data->offsets, (int)offset);
+}
+
+void
+gbinder_writer_overwrite_fd(
+    GBinderWriter* self,
+    gsize offset,
+    int fd) /* Since 1.1.43 */
+{
+    GBinderWriterData* data = gbinder_writer_data(self);
+
+    if (G_LIKELY(data)) {
+        GByteArray* buf = data->bytes;
+
+        if (gbinder_writer_data_has_object(data, offset) &&
+            data->io->decode_fd_object(buf->data + offset,
+                buf->len - offset, NULL)) {
+            /*
+             * Unlike gbinder_writer_append_fd(), the descriptor is not
+             * duplicated. The one originally appended remains owned by
+             * the writer and gets closed when the request is freed.
+             */
+            data->io->encode_fd_object(buf->data + offset, fd);
+        } else {
+            GWARN("No fd object at %lu", (gulong)offset);
+        }
+    }
+}
+
+void
+gbinder_writer_overwrite_remote_object(
+    GBinderWriter* self,
+    gsize offset,
+    GBinderRemoteObject* obj) /* Since 1.1.43 */
+{
+    GBinderWriterData* data = gbinder_writer_data(self);
+
+    /* NULL objects have no offset recorded, can't replace those */
+    if (G_LIKELY(data) && G_LIKELY(obj)) {
+        GByteArray* buf = data->bytes;
+
+        if (gbinder_writer_data_has_object(data, offset) &&
+            data->io->decode_binder_handle(buf->data + offset, NULL,
+                data->protocol)) {
+            data->io->encode_remote_object(buf->data + offset, obj);
+            /* Keep the object alive until the data is freed */
+            data->cleanup = gbinder_cleanup_add(data->cleanup,
+                (GDestroyNotify) gbinder_remote_object_unref,
+                gbinder_remote_object_ref(obj));
+        } else {
+            GWARN("No remote object at %lu", (gulong)offset);
+        }
+    }
+}
+
 void
 gbinder_writer_append_int64(
     GBinderWriter* self,
@@ -501,58 +585,170 @@ gbinder_writer_data_append_string16_empty(
     ptr16[0] = ptr16[1] = ptr16[2] = 0; ptr16[3] = 0xffff;
 }
 
+/*
+ * Decodes one multi-byte UTF-8 sequence and stores it as one or two
+ * UTF-16 code units. Overlong forms, surrogates and code points beyond
+ * U+10FFFF are rejected the same way g_utf8_validate() rejects them.
+ * Returns the number of bytes consumed, zero if the sequence is invalid.
+ */
+static
+guint
+gbinder_writer_utf8_decode_char(
+    const guint8* src,
+    const guint8* end,
+    gunichar2** out)
+{
+    const guint c = src[0];
+    gunichar ch;
+    guint n, i;
+
+    if (c < 0xc2) {
+        /* Continuation byte or overlong 2-byte sequence */
+        return 0;
+    } else if (c < 0xe0) {
+        ch = c & 0x1f;
+        n = 2;
+    } else if (c < 0xf0) {
+        ch = c & 0x0f;
+        n = 3;
+    } else if (c < 0xf5) {
+        ch = c & 0x07;
+        n = 4;
+    } else {
+        return 0;
+    }
+
+    if ((gsize)(end - src) < n) {
+        return 0;
+    }
+
+    for (i = 1; i < n; i++) {
+        if ((src[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+        ch = (ch << 6) | (src[i] & 0x3f);
+    }
+
+    if (n == 3) {
+        if (ch < 0x800 || (ch >= 0xd800 && ch < 0xe000)) {
+            return 0;
+        }
+    } else if (n == 4) {
+        if (ch < 0x10000 || ch > 0x10ffff) {
+            return 0;
+        }
+        /* Surrogate pair */
+        ch -= 0x10000;
+        *(*out)++ = 0xd800 + (ch >> 10);
+        ch = 0xdc00 + (ch & 0x3ff);
+    }
+    *(*out)++ = ch;
+    return n;
+}
+
+/*
+ * Converts UTF-8 to UTF-16 in a single pass, stopping at the first NUL
+ * character or invalid sequence. The output buffer must have room for
+ * at least num_bytes code units. Returns the number of code units.
+ */
+static
+gsize
+gbinder_writer_utf8_to_utf16(
+    gunichar2* dest,
+    const char* utf8,
+    gsize num_bytes)
+{
+    const guint64 ones = G_GUINT64_CONSTANT(0x0101010101010101);
+    const guint64 highs = G_GUINT64_CONSTANT(0x8080808080808080);
+    const guint8* src = (const guint8*)utf8;
+    const guint8* end = src + num_bytes;
+    gunichar2* out = dest;
+
+    while (src < end) {
+        /*
+         * ASCII fast path, eight bytes at a time. A high bit set in
+         * (w | (w - ones)) means either a non-ASCII or a zero byte.
+         * The widening loop is simple enough to be vectorized.
+         */
+        while ((gsize)(end - src) >= sizeof(guint64)) {
+            guint64 w;
+            guint i;
+
+            memcpy(&w, src, sizeof(w));
+            if ((w | (w - ones)) & highs) {
+                break;
+            }
+            for (i = 0; i < sizeof(w); i++) {
+                out[i] = src[i];
+            }
+            src += sizeof(w);
+            out += sizeof(w);
+        }
+
+        /* Slow path, one character at a time */
+        if (src < end) {
+            const guint8 c = *src;
+
+            if (c < 0x80) {
+                if (!c) {
+                    break;
+                }
+                *out++ = c;
+                src++;
+            } else {
+                const guint n = gbinder_writer_utf8_decode_char(src, end,
+                    &out);
+
+                if (!n) {
+                    break;
+                }
+                src += n;
+            }
+        }
+    }
+    return out - dest;
+}
+
 void
 gbinder_writer_data_append_string16_len(
     GBinderWriterData* data,
     const char* utf8,
     gssize num_bytes)
 {
-    if (utf8) {
-        const char* end = utf8;
-
-        g_utf8_validate(utf8, num_bytes, &end);
-        num_bytes = end - utf8;
-    } else {
-        num_bytes = 0;
+    if (utf8 && num_bytes < 0) {
+        num_bytes = strlen(utf8);
     }
 
-    if (num_bytes > 0) {
+    if (utf8 && num_bytes > 0) {
         GByteArray* buf = data->bytes;
         const gsize old_size = buf->len;
-        glong len = g_utf8_strlen(utf8, num_bytes);
-        gsize padded_len = G_ALIGN4((len+1)*2);
         guint32* len_ptr;
         gunichar2* utf16_ptr;
-        gunichar2* utf16 = NULL;
+        gsize len, padded_len;
 
-        /* Create utf-16 string to make sure of its size */
-        if (len > 0) {
-            glong utf16_len = 0;
-
-            utf16 = g_utf8_to_utf16(utf8, num_bytes, NULL, &utf16_len, NULL);
-            if (utf16) {
-                len = utf16_len;
-                padded_len = G_ALIGN4((len+1)*2);
-            }
-        }
-
-        /* Preallocate space */
-        g_byte_array_set_size(buf, old_size + padded_len + 4);
+        /*
+         * Each UTF-8 byte produces at most one UTF-16 code unit, reserve
+         * the worst case and convert directly into the buffer. That is
+         * the exact size for ASCII strings.
+         */
+        g_byte_array_set_size(buf, old_size + G_ALIGN4((num_bytes+1)*2) + 4);
         len_ptr = (guint32*)(buf->data + old_size);
         utf16_ptr = (gunichar2*)(len_ptr + 1);
+        len = gbinder_writer_utf8_to_utf16(utf16_ptr, utf8, num_bytes);
 
-        /* Copy string */
-        if (utf16) {
-            memcpy(utf16_ptr, utf16, len*2);
-            g_free(utf16);
-        }
+        if (len > 0) {
+            padded_len = G_ALIGN4((len+1)*2);
+            g_byte_array_set_size(buf, old_size + padded_len + 4);
 
-        /* Actual length */
-        *len_ptr = len;
+            /* Actual length */
+            *len_ptr = len;
 
-        /* Zero padding */
-        if (padded_len > len*2) {
+            /* Zero padding */
             memset(utf16_ptr + len, 0, padded_len - len*2);
+        } else {
+            /* Nothing valid in there */
+            g_byte_array_set_size(buf, old_size);
+            gbinder_writer_data_append_string16_empty(data);
         }
     } else if (utf8) {
         /* Empty string */
@@ -995,18 +1191,16 @@ gbinder_writer_data_append_hidl_vec(
     guint elemsize)
 {
     GBinderParent vec_parent;
-    GBinderHidlVec* vec = g_new0(GBinderHidlVec, 1);
+    GBinderHidlVec* vec = gbinder_arena_alloc0(&data->arena, sizeof(*vec));
     const gsize total = count * elemsize;
-    void* buf = gutil_memdup(base, total);
+    void* buf = gbinder_arena_memdup(&data->arena, base, total);
 
     /* Fill in the vector descriptor */
     if (buf) {
         vec->data.ptr = buf;
         vec->count = count;
-        data->cleanup = gbinder_cleanup_add(data->cleanup, g_free, buf);
     }
     vec->owns_buffer = TRUE;
-    data->cleanup = gbinder_cleanup_add(data->cleanup, g_free, vec);
 
     /* Every vector, even the one without data, requires two buffer objects */
     vec_parent.offset = GBINDER_HIDL_VEC_BUFFER_OFFSET;
@@ -1035,14 +1229,14 @@ gbinder_writer_data_append_hidl_string(
     const char* str)
 {
     GBinderParent str_parent;
-    GBinderHidlString* hidl_string = g_new0(GBinderHidlString, 1);
+    GBinderHidlString* hidl_string = gbinder_arena_alloc0(&data->arena,
+        sizeof(*hidl_string));
     const gsize len = str ? strlen(str) : 0;
 
-    /* Fill in the string descriptor and store it */
+    /* Fill in the string descriptor */
     hidl_string->data.str = str;
     hidl_string->len = len;
     hidl_string->owns_buffer = TRUE;
-    data->cleanup = gbinder_cleanup_add(data->cleanup, g_free, hidl_string);
 
     /* Write the buffer object pointing to the string descriptor */
     str_parent.offset = GBINDER_HIDL_STRING_BUFFER_OFFSET;
@@ -1080,7 +1274,7 @@ gbinder_writer_data_append_hidl_string_vec(
     gssize count)
 {
     GBinderParent vec_parent;
-    GBinderHidlVec* vec = g_new0(GBinderHidlVec, 1);
+    GBinderHidlVec* vec = gbinder_arena_alloc0(&data->arena, sizeof(*vec));
     GBinderHidlString* strings = NULL;
     int i;
 
@@ -1091,13 +1285,12 @@ gbinder_writer_data_append_hidl_string_vec(
 
     /* Fill in the vector descriptor */
     if (count > 0) {
-        strings = g_new0(GBinderHidlString, count);
+        strings = gbinder_arena_alloc0(&data->arena,
+            sizeof(GBinderHidlString) * count);
         vec->data.ptr = strings;
-        data->cleanup = gbinder_cleanup_add(data->cleanup, g_free, strings);
     }
     vec->count = count;
     vec->owns_buffer = TRUE;
-    data->cleanup = gbinder_cleanup_add(data->cleanup, g_free, vec);
 
     /* Fill in string descriptors */
     for (i = 0; i < count; i++) {
@@ -1245,28 +1438,27 @@ gbinder_writer_data_append_fmq_descriptor(
 {
     GBinderParent parent;
     GBinderMQDescriptor* desc = gbinder_fmq_get_descriptor(queue);
-    GBinderMQDescriptor* mqdesc = gutil_memdup(desc,
+    GBinderMQDescriptor* mqdesc = gbinder_arena_memdup(&data->arena, desc,
         sizeof(GBinderMQDescriptor));
 
     const gsize vec_total =
         desc->grantors.count * sizeof(GBinderFmqGrantorDescriptor);
-    void* vec_buf = gutil_memdup(desc->grantors.data.ptr, vec_total);
+    void* vec_buf = gbinder_arena_memdup(&data->arena,
+        desc->grantors.data.ptr, vec_total);
 
     const gsize fds_total = sizeof(GBinderFds) +
         sizeof(int) * (desc->data.fds->num_fds + desc->data.fds->num_ints);
-    GBinderFds* fds = gutil_memdup(desc->data.fds, fds_total);
+    GBinderFds* fds = gbinder_arena_memdup(&data->arena, desc->data.fds,
+        fds_total);
 
     mqdesc->data.fds = fds;
-    data->cleanup = gbinder_cleanup_add(data->cleanup, g_free, fds);
 
     /* Fill in the grantor vector descriptor */
     if (vec_buf) {
         mqdesc->grantors.count = desc->grantors.count;
         mqdesc->grantors.data.ptr = vec_buf;
         mqdesc->grantors.owns_buffer = TRUE;
-        data->cleanup = gbinder_cleanup_add(data->cleanup, g_free, vec_buf);
     }
-    data->cleanup = gbinder_cleanup_add(data->cleanup, g_free, mqdesc);
 
     /* Write the FMQ descriptor object */
     parent.index = gbinder_writer_data_append_buffer_object(data,
@@ -1318,31 +1510,14 @@ gbinder_writer_data_append_remote_object(
     }
 }
 
-static
-void*
-gbinder_writer_alloc(
-    GBinderWriter* self,
-    gsize size,
-    gpointer (*alloc)(gsize),
-    void (*dealloc)(gpointer))
-{
-    GBinderWriterData* data = gbinder_writer_data(self);
-
-    if (G_LIKELY(data)) {
-        void* ptr = alloc(size);
-
-        data->cleanup = gbinder_cleanup_add(data->cleanup, dealloc, ptr);
-        return ptr;
-    }
-    return NULL;
-}
-
 void*
 gbinder_writer_malloc(
     GBinderWriter* self,
     gsize size) /* since 1.0.19 */
 {
-    return gbinder_writer_alloc(self, size, g_malloc, g_free);
+    GBinderWriterData* data = gbinder_writer_data(self);
+
+    return G_LIKELY(data) ? gbinder_arena_alloc(&data->arena, size) : NULL;
 }
 
 void*
@@ -1350,7 +1525,9 @@ gbinder_writer_malloc0(
     GBinderWriter* self,
     gsize size) /* since 1.0.19 */
 {
-    return gbinder_writer_alloc(self, size, g_malloc0, g_free);
+    GBinderWriterData* data = gbinder_writer_data(self);
+
+    return G_LIKELY(data) ? gbinder_arena_alloc0(&data->arena, size) : NULL;
 }
 
 char*
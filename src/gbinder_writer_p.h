@@ -35,6 +35,7 @@
 
 #include <gbinder_writer.h>
 
+#include "gbinder_arena.h"
 #include "gbinder_cleanup.h"
 
 typedef struct gbinder_writer_data {
@@ -44,6 +45,7 @@ typedef struct gbinder_writer_data {
     GUtilIntArray* offsets;
     gsize buffers_size;
     GBinderCleanup* cleanup;
+    GBinderArena arena;
 } GBinderWriterData;
 
 void
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <gbinder.h>
+
+#include <gutil_log.h>
+
+#define RET_OK          (0)
+#define RET_INVARG      (2)
+#define RET_ERR         (3)
+
+#define DEFAULT_COUNT   (10000000)
+#define DEFAULT_ITEMS   (1024)
+#define DEFAULT_SIZE    (8)
+#define DEFAULT_BATCH   (1)
+
+/*
+ * Producer and consumer running on two threads, busy-polling the queue.
+ * This is the worst case for the read and write counters sitting next
+ * to each other, which is what GBINDER_FMQ_FLAG_CACHE_LINE_ALIGN fixes.
+ */
+
+typedef struct app_options {
+    gint count;
+    gint items;
+    gint size;
+    gint batch;
+    gboolean aligned;
+    gboolean compare;
+} AppOptions;
+
+typedef struct app_bench {
+    const AppOptions* opt;
+    GBinderFmq* fmq;
+} AppBench;
+
+static
+gpointer
+app_producer(
+    gpointer user_data)
+{
+    const AppBench* bench = user_data;
+    const AppOptions* opt = bench->opt;
+    guint8* data = g_malloc0(opt->size * opt->batch);
+    gint left = opt->count;
+
+    while (left > 0) {
+        const gint n = MIN(left, opt->batch);
+
+        if (gbinder_fmq_write(bench->fmq, data, n)) {
+            left -= n;
+        }
+    }
+    g_free(data);
+    return NULL;
+}
+
+static
+double
+app_bench_run(
+    const AppOptions* opt,
+    gboolean aligned)
+{
+    AppBench bench;
+    GThread* producer;
+    guint8* data = g_malloc(opt->size * opt->batch);
+    gint left = opt->count;
+    gint64 start;
+    double sec;
+
+    bench.opt = opt;
+    bench.fmq = gbinder_fmq_new(opt->size, opt->items,
+        GBINDER_FMQ_TYPE_SYNC_READ_WRITE, aligned ?
+        GBINDER_FMQ_FLAG_CACHE_LINE_ALIGN : 0, -1, 0);
+    if (!bench.fmq) {
+        g_free(data);
+        return 0;
+    }
+
+    start = g_get_monotonic_time();
+    producer = g_thread_new("producer", app_producer, &bench);
+    while (left > 0) {
+        const gint n = MIN(left, opt->batch);
+
+        if (gbinder_fmq_read(bench.fmq, data, n)) {
+            left -= n;
+        }
+    }
+    g_thread_join(producer);
+    sec = (g_get_monotonic_time() - start) / 1000000.0;
+
+    GINFO("%s: %d items in %.3f sec, %.0f items/sec, %.1f MB/sec",
+        aligned ? "Aligned" : "Compact", opt->count, sec,
+        opt->count / sec, ((double)opt->count) * opt->size / sec / 1e6);
+
+    gbinder_fmq_unref(bench.fmq);
+    g_free(data);
+    return opt->count / sec;
+}
+
+static
+int
+app_run(
+    const AppOptions* opt)
+{
+    if (opt->compare) {
+        const double compact = app_bench_run(opt, FALSE);
+        const double aligned = app_bench_run(opt, TRUE);
+
+        if (compact > 0 && aligned > 0) {
+            GINFO("Speedup: %.2fx", aligned / compact);
+            return RET_OK;
+        }
+    } else if (app_bench_run(opt, opt->aligned) > 0) {
+        return RET_OK;
+    }
+    GERR("Failed to create the queue");
+    return RET_ERR;
+}
+
+static
+gboolean
+app_log_verbose(
+    const gchar* name,
+    const gchar* value,
+    gpointer data,
+    GError** error)
+{
+    gutil_log_default.level = GLOG_LEVEL_VERBOSE;
+    return TRUE;
+}
+
+static
+gboolean
+app_init(
+    AppOptions* opt,
+    int argc,
+    char* argv[])
+{
+    gboolean ok = FALSE;
+    GOptionEntry entries[] = {
+        { "verbose", 'v', G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK,
+          app_log_verbose, "Enable verbose output", NULL },
+        { "count", 'n', 0, G_OPTION_ARG_INT, &opt->count,
+          "Number of items to transfer [10000000]", "N" },
+        { "items", 'i', 0, G_OPTION_ARG_INT, &opt->items,
+          "Queue size in items [1024]", "N" },
+        { "size", 's', 0, G_OPTION_ARG_INT, &opt->size,
+          "Item size in bytes [8]", "BYTES" },
+        { "batch", 'b', 0, G_OPTION_ARG_INT, &opt->batch,
+          "Items per read/write call [1]", "N" },
+        { "aligned", 'a', 0, G_OPTION_ARG_NONE, &opt->aligned,
+          "Put each grantor on its own cache line", NULL },
+        { "compare", 'c', 0, G_OPTION_ARG_NONE, &opt->compare,
+          "Run both compact and aligned layouts", NULL },
+        { NULL }
+    };
+
+    GError* error = NULL;
+    GOptionContext* options = g_option_context_new(NULL);
+
+    gutil_log_timestamp = FALSE;
+    gutil_log_default.level = GLOG_LEVEL_DEFAULT;
+
+    opt->count = DEFAULT_COUNT;
+    opt->items = DEFAULT_ITEMS;
+    opt->size = DEFAULT_SIZE;
+    opt->batch = DEFAULT_BATCH;
+    g_option_context_add_main_entries(options, entries, NULL);
+    if (g_option_context_parse(options, &argc, &argv, &error)) {
+        if (argc == 1 && opt->count > 0 && opt->items > 0 &&
+            opt->size > 0 && opt->batch > 0 && opt->batch <= opt->items) {
+            ok = TRUE;
+        } else {
+            char* help = g_option_context_get_help(options, TRUE, NULL);
+
+            fprintf(stderr, "%s", help);
+            g_free(help);
+        }
+    } else {
+        GERR("%s", error->message);
+        g_error_free(error);
+    }
+    g_option_context_free(options);
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    AppOptions opt;
+    int ret = RET_INVARG;
+
+    memset(&opt, 0, sizeof(opt));
+    if (app_init(&opt, argc, argv)) {
+        ret = app_run(&opt);
+    }
+    return ret;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
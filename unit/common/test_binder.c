@@ -105,6 +105,7 @@ struct test_binder_node {
     int fd[2];
     char* path;
     gint ignore_dead_object;
+    gint max_threads;
     const char* name;
     const TestBinderIo* io;
     GMutex mutex;
@@ -196,6 +197,7 @@ typedef  struct binder_buffer_64 {
 #define BC_RELEASE              _IOW('c', 6, guint32)
 #define BC_DECREFS              _IOW('c', 7, guint32)
 #define BC_ACQUIRE_DONE_64      _IOW('c', 9, BinderPtrCookie64)
+#define BC_REGISTER_LOOPER       _IO('c', 11)
 #define BC_ENTER_LOOPER          _IO('c', 12)
 #define BC_EXIT_LOOPER           _IO('c', 13)
 #define BC_REQUEST_DEATH_NOTIFICATION_64 _IOW('c', 14, BinderHandleCookie64)
@@ -213,6 +215,7 @@ typedef  struct binder_buffer_64 {
 #define BR_RELEASE_64           _IOR('r', 9, BinderPtrCookie64)
 #define BR_DECREFS_64           _IOR('r', 10, BinderPtrCookie64)
 #define BR_NOOP                  _IO('r', 12)
+#define BR_SPAWN_LOOPER          _IO('r', 13)
 #define BR_DEAD_BINDER_64       _IOR('r', 15, guint64)
 #define BR_CLEAR_DEATH_NOTIFICATION_DONE_64 _IOR('r', 16, guint64)
 #define BR_FAILED_REPLY          _IO('r', 17)
@@ -1034,6 +1037,7 @@ test_binder_node_handle_cmd_64(
     const int tid = gettid();
 
     switch (code) {
+    case BC_REGISTER_LOOPER:
     case BC_ENTER_LOOPER:
 
         /* Lock */
@@ -1281,6 +1285,16 @@ test_binder_br_noop(
     test_binder_push_data(fd, dest, &cmd);
 }
 
+void
+test_binder_br_spawn_looper(
+    int fd,
+    TEST_BR_THREAD dest)
+{
+    guint32 cmd = BR_SPAWN_LOOPER;
+
+    test_binder_push_data(fd, dest, &cmd);
+}
+
 void
 test_binder_br_increfs(
     int fd,
@@ -1563,6 +1577,19 @@ test_binder_ignore_dead_object(
     test_binder_node_unref(node);
 }
 
+guint
+test_binder_max_threads(
+    int fd)
+{
+    TestBinderNode* node = test_binder_node_ref_from_fd(fd);
+    guint max_threads;
+
+    g_assert(node);
+    max_threads = g_atomic_int_get(&node->max_threads);
+    test_binder_node_unref(node);
+    return max_threads;
+}
+
 static
 void
 test_binder_node_unregister_objects(
@@ -1718,6 +1745,7 @@ gbinder_system_ioctl(
             ret = test_binder_ioctl_version(node, data);
             break;
         case BINDER_SET_MAX_THREADS:
+            g_atomic_int_set(&node->max_threads, *(guint32*)data);
             ret = 0;
             break;
         default:
@@ -57,6 +57,11 @@ test_binder_br_noop(
     int fd,
     TEST_BR_THREAD dest);
 
+void
+test_binder_br_spawn_looper(
+    int fd,
+    TEST_BR_THREAD dest);
+
 void
 test_binder_br_increfs(
     int fd,
@@ -133,6 +138,10 @@ void
 test_binder_ignore_dead_object(
     int fd);
 
+guint
+test_binder_max_threads(
+    int fd);
+
 int
 test_binder_handle(
     int fd,
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test_common.h"
+
+#include "gbinder_arena.h"
+
+static TestOpt test_opt;
+
+/*==========================================================================*
+ * basic
+ *==========================================================================*/
+
+static
+void
+test_basic(
+    void)
+{
+    GBinderArena arena;
+    guint8* p1;
+    guint8* p2;
+    guint i;
+
+    memset(&arena, 0, sizeof(arena));
+    g_assert(!gbinder_arena_alloc(&arena, 0));
+    g_assert(!gbinder_arena_alloc0(&arena, 0));
+    g_assert(!gbinder_arena_memdup(&arena, NULL, 1));
+    g_assert(!gbinder_arena_memdup(&arena, &arena, 0));
+    g_assert(!arena.chunks);
+
+    /* Blocks are 8-byte aligned and don't overlap */
+    p1 = gbinder_arena_alloc(&arena, 1);
+    p2 = gbinder_arena_alloc0(&arena, 3);
+    g_assert(p1);
+    g_assert(p2);
+    g_assert(!(((gsize)p1) & 7));
+    g_assert(!(((gsize)p2) & 7));
+    g_assert(p2 >= p1 + 8);
+    for (i = 0; i < 3; i++) {
+        g_assert(!p2[i]);
+    }
+
+    p1 = gbinder_arena_memdup(&arena, "foo", 4);
+    g_assert_cmpstr((char*)p1, == ,"foo");
+
+    /* Lots of small blocks */
+    for (i = 0; i < 1000; i++) {
+        guint32* ptr = gbinder_arena_alloc(&arena, sizeof(*ptr));
+
+        g_assert(ptr);
+        *ptr = i;
+    }
+    gbinder_arena_free(&arena);
+    g_assert(!arena.chunks);
+    g_assert(!arena.used);
+}
+
+/*==========================================================================*
+ * large
+ *==========================================================================*/
+
+static
+void
+test_large(
+    void)
+{
+    static const guint8 data[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    GBinderArena arena;
+    guint8* small1;
+    guint8* small2;
+    guint8* large;
+
+    memset(&arena, 0, sizeof(arena));
+
+    /* Large block in the empty arena */
+    large = gbinder_arena_alloc0(&arena, 10000);
+    g_assert(large);
+    g_assert(!large[9999]);
+
+    /* Large block doesn't break the current chunk */
+    small1 = gbinder_arena_memdup(&arena, TEST_ARRAY_AND_SIZE(data));
+    large = gbinder_arena_alloc(&arena, 4096);
+    small2 = gbinder_arena_memdup(&arena, TEST_ARRAY_AND_SIZE(data));
+    g_assert(large);
+    g_assert(small2 == small1 + 16);
+    g_assert(!memcmp(small1, data, sizeof(data)));
+    g_assert(!memcmp(small2, data, sizeof(data)));
+    memset(large, 0xff, 4096);
+    g_assert(!memcmp(small1, data, sizeof(data)));
+    g_assert(!memcmp(small2, data, sizeof(data)));
+
+    gbinder_arena_free(&arena);
+}
+
+/*==========================================================================*
+ * reset
+ *==========================================================================*/
+
+static
+void
+test_reset(
+    void)
+{
+    GBinderArena arena;
+    void* p1;
+    void* p2;
+    guint i;
+
+    memset(&arena, 0, sizeof(arena));
+    gbinder_arena_reset(&arena);
+    g_assert(!arena.chunks);
+
+    /* Large chunk alone is not kept */
+    g_assert(gbinder_arena_alloc(&arena, 10000));
+    gbinder_arena_reset(&arena);
+    g_assert(!arena.chunks);
+
+    /* One standard chunk survives the reset and gets reused */
+    for (i = 0; i < 1000; i++) {
+        g_assert(gbinder_arena_alloc(&arena, 16));
+    }
+    g_assert(gbinder_arena_alloc(&arena, 10000));
+    gbinder_arena_reset(&arena);
+    g_assert(arena.chunks);
+    g_assert(!arena.used);
+
+    p1 = gbinder_arena_alloc(&arena, 1);
+    gbinder_arena_reset(&arena);
+    p2 = gbinder_arena_alloc(&arena, 1);
+    g_assert(p1 == p2);
+
+    gbinder_arena_free(&arena);
+    g_assert(!arena.chunks);
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_PREFIX "/arena/"
+#define TEST_(t) TEST_PREFIX t
+
+int main(int argc, char* argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("basic"), test_basic);
+    g_test_add_func(TEST_("large"), test_large);
+    g_test_add_func(TEST_("reset"), test_reset);
+    test_init(&test_opt, argc, argv);
+    return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
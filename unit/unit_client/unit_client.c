@@ -86,6 +86,7 @@ test_null(
     g_assert(!gbinder_client_new_request2(NULL, 0));
     g_assert(!gbinder_client_transact_sync_reply(NULL, 0, NULL, NULL));
     g_assert(gbinder_client_transact_sync_oneway(NULL, 0, NULL) == (-EINVAL));
+    g_assert(gbinder_client_transact_oneway_batch(NULL, NULL, 0) == (-EINVAL));
     g_assert(!gbinder_client_transact(NULL, 0, 0, NULL, NULL, NULL, NULL));
     gbinder_client_cancel(NULL, 0);
 }
@@ -266,6 +267,48 @@ test_sync_oneway(
     test_binder_exit_wait(&test_opt, NULL);
 }
 
+/*==========================================================================*
+ * oneway_batch
+ *==========================================================================*/
+
+static
+void
+test_oneway_batch(
+    void)
+{
+    GBinderClient* client = test_client_new(0, "foo");
+    GBinderLocalRequest* req = gbinder_client_new_request(client);
+    int fd = gbinder_driver_fd(gbinder_client_ipc(client)->driver);
+    GBinderClientOnewayTx txs[40];
+    guint i;
+
+    g_assert(req);
+    for (i = 0; i < G_N_ELEMENTS(txs); i++) {
+        txs[i].code = i;
+        /* Every other transaction uses the internal (empty) request */
+        txs[i].req = (i & 1) ? NULL : req;
+    }
+
+    /* Empty batch is a no-op */
+    g_assert(gbinder_client_transact_oneway_batch(client, txs, 0) ==
+        GBINDER_STATUS_OK);
+    g_assert(gbinder_client_transact_oneway_batch(client, NULL, 0) ==
+        GBINDER_STATUS_OK);
+    g_assert(gbinder_client_transact_oneway_batch(client, NULL, 1) ==
+        (-EINVAL));
+
+    /* More than one chunk */
+    for (i = 0; i < G_N_ELEMENTS(txs); i++) {
+        test_binder_br_transaction_complete(fd, THIS_THREAD);
+    }
+    g_assert(gbinder_client_transact_oneway_batch(client, txs,
+        G_N_ELEMENTS(txs)) == GBINDER_STATUS_OK);
+
+    gbinder_local_request_unref(req);
+    gbinder_client_unref(client);
+    test_binder_exit_wait(&test_opt, NULL);
+}
+
 /*==========================================================================*
  * sync_reply
  *==========================================================================*/
@@ -475,6 +518,7 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("dead"), test_dead);
     g_test_add_func(TEST_("no_header"), test_no_header);
     g_test_add_func(TEST_("sync_oneway"), test_sync_oneway);
+    g_test_add_func(TEST_("oneway_batch"), test_oneway_batch);
     g_test_add_func(TEST_("sync_reply"), test_sync_reply);
     g_test_add_func(TEST_("reply/ok1"), test_reply_ok1);
     g_test_add_func(TEST_("reply/ok2"), test_reply_ok2);
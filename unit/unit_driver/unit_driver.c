@@ -32,12 +32,16 @@
 
 #include "test_binder.h"
 
+#include "gbinder_buffer_p.h"
 #include "gbinder_driver.h"
 #include "gbinder_handler.h"
+#include "gbinder_io.h"
 #include "gbinder_local_request_p.h"
 #include "gbinder_output_data.h"
 #include "gbinder_rpc_protocol.h"
 
+#include <gutil_intarray.h>
+
 #include <poll.h>
 
 static TestOpt test_opt;
@@ -107,6 +111,168 @@ test_noop(
     test_binder_exit_wait(&test_opt, NULL);
 }
 
+/*==========================================================================*
+ * stats
+ *==========================================================================*/
+
+static
+void
+test_stats(
+    void)
+{
+    GBinderDriver* driver = gbinder_driver_new(GBINDER_DEFAULT_BINDER, NULL);
+    const int fd = gbinder_driver_fd(driver);
+    GBinderDriverStats stats;
+
+    gbinder_driver_stats(driver, &stats);
+    g_assert_cmpuint(stats.ioctls, == ,0);
+    g_assert_cmpuint(stats.reads, == ,0);
+    g_assert_cmpuint(stats.commands, == ,0);
+    g_assert_cmpuint(stats.max_commands, == ,0);
+
+    /* All three commands get drained by a single read */
+    test_binder_br_noop(fd, THIS_THREAD);
+    test_binder_br_noop(fd, THIS_THREAD);
+    test_binder_br_noop(fd, THIS_THREAD);
+    g_assert(gbinder_driver_read(driver, NULL, NULL) == 0);
+    gbinder_driver_stats(driver, &stats);
+    g_assert_cmpuint(stats.ioctls, == ,1);
+    g_assert_cmpuint(stats.reads, == ,1);
+    g_assert_cmpuint(stats.commands, == ,3);
+    g_assert_cmpuint(stats.max_commands, == ,3);
+
+    /* The read buffer is reused */
+    test_binder_br_noop(fd, THIS_THREAD);
+    g_assert(gbinder_driver_read(driver, NULL, NULL) == 0);
+    gbinder_driver_stats(driver, &stats);
+    g_assert_cmpuint(stats.ioctls, == ,2);
+    g_assert_cmpuint(stats.reads, == ,2);
+    g_assert_cmpuint(stats.commands, == ,4);
+    g_assert_cmpuint(stats.max_commands, == ,3);
+
+    /* Write-only calls are counted too */
+    g_assert(gbinder_driver_enter_looper(driver));
+    gbinder_driver_stats(driver, &stats);
+    g_assert_cmpuint(stats.ioctls, == ,3);
+    g_assert_cmpuint(stats.reads, == ,2);
+
+    gbinder_driver_unref(driver);
+    test_binder_exit_wait(&test_opt, NULL);
+}
+
+/*==========================================================================*
+ * free_buffer
+ *==========================================================================*/
+
+typedef struct test_free_buffer_data {
+    GMainLoop* loop;
+    int destroyed;
+} TestFreeBufferData;
+
+static
+void
+test_free_buffer_destroy(
+    gpointer data)
+{
+    TestFreeBufferData* test = data;
+
+    test->destroyed++;
+    if (test->loop) {
+        g_main_loop_quit(test->loop);
+    }
+}
+
+static
+void
+test_free_buffer(
+    void)
+{
+    GBinderDriver* driver = gbinder_driver_new(GBINDER_DEFAULT_BINDER, NULL);
+    const int fd = gbinder_driver_fd(driver);
+    GBinderDriverStats stats;
+    TestFreeBufferData test;
+
+    memset(&test, 0, sizeof(test));
+    test_binder_set_destroy(fd, &test, test_free_buffer_destroy);
+
+    /* BC_FREE_BUFFER gets queued and submitted with the next command */
+    gbinder_driver_free_buffer(driver, &test);
+    gbinder_driver_stats(driver, &stats);
+    g_assert_cmpuint(stats.ioctls, == ,0);
+    g_assert_cmpint(test.destroyed, == ,0);
+    g_assert(gbinder_driver_enter_looper(driver));
+    gbinder_driver_stats(driver, &stats);
+    g_assert_cmpuint(stats.ioctls, == ,1);
+    g_assert_cmpint(test.destroyed, == ,1);
+
+    /* Or on idle if there's nothing else to do */
+    test.loop = g_main_loop_new(NULL, FALSE);
+    test_binder_set_destroy(fd, &test, test_free_buffer_destroy);
+    gbinder_driver_release(driver, 0);
+    gbinder_driver_free_buffer(driver, &test);
+    g_assert_cmpint(test.destroyed, == ,1);
+    test_run(&test_opt, test.loop);
+    g_assert_cmpint(test.destroyed, == ,2);
+    gbinder_driver_stats(driver, &stats);
+    g_assert_cmpuint(stats.ioctls, == ,2);
+
+    gbinder_driver_unref(driver);
+    test_binder_exit_wait(&test_opt, test.loop);
+    g_main_loop_unref(test.loop);
+}
+
+static
+void
+test_free_buffer_unref(
+    void)
+{
+    GBinderDriver* driver = gbinder_driver_new(GBINDER_DEFAULT_BINDER, NULL);
+    const int fd = gbinder_driver_fd(driver);
+    GMainLoop* loop = g_main_loop_new(NULL, FALSE);
+    TestFreeBufferData test;
+
+    memset(&test, 0, sizeof(test));
+    test_binder_set_destroy(fd, &test, test_free_buffer_destroy);
+
+    /* The queue gets flushed when the driver is freed, without idle */
+    gbinder_driver_free_buffer(driver, &test);
+    g_assert_cmpint(test.destroyed, == ,0);
+    gbinder_driver_unref(driver);
+    g_assert_cmpint(test.destroyed, == ,1);
+
+    /* The cancelled idle callback doesn't fire */
+    test_binder_exit_wait(&test_opt, loop);
+    g_assert_cmpint(test.destroyed, == ,1);
+    g_main_loop_unref(loop);
+}
+
+/*==========================================================================*
+ * reply
+ *==========================================================================*/
+
+static
+void
+test_reply(
+    void)
+{
+    GBinderDriver* driver = gbinder_driver_new(GBINDER_DEFAULT_BINDER, NULL);
+    const int fd = gbinder_driver_fd(driver);
+    GBinderDriverStats stats;
+
+    /*
+     * Incoming transaction for a non-existent object gets replied with
+     * a status. BC_REPLY is submitted together with the read which picks
+     * up BR_TRANSACTION_COMPLETE, i.e. the whole thing takes 2 calls.
+     */
+    test_binder_br_transaction(fd, THIS_THREAD, NULL, 1, NULL);
+    g_assert(gbinder_driver_read(driver, NULL, NULL) == 0);
+    gbinder_driver_stats(driver, &stats);
+    g_assert_cmpuint(stats.ioctls, == ,2);
+
+    gbinder_driver_unref(driver);
+    test_binder_exit_wait(&test_opt, NULL);
+}
+
 /*==========================================================================*
  * local_request
  *==========================================================================*/
@@ -136,6 +302,98 @@ test_local_request(
     test_binder_exit_wait(&test_opt, NULL);
 }
 
+/*==========================================================================*
+ * encode_reply
+ *==========================================================================*/
+
+typedef struct test_encode_reply_data {
+    const char* name;
+    const GBinderIo* io;
+    guint count;
+    gboolean heap;
+} TestEncodeReplyData;
+
+static const TestEncodeReplyData test_encode_reply_data[] = {
+    /* 32-bit offsets are passed to the driver as is */
+    { "32/1", &gbinder_io_32, 1, FALSE },
+    { "32/8", &gbinder_io_32, 8, FALSE },
+    { "32/9", &gbinder_io_32, 9, FALSE },
+    { "32/16", &gbinder_io_32, 16, FALSE },
+    /* 64-bit ones are converted, in place or on the heap */
+    { "64/1", &gbinder_io_64, 1, FALSE },
+    { "64/8", &gbinder_io_64, 8, FALSE },
+    { "64/9", &gbinder_io_64, 9, TRUE },
+    { "64/16", &gbinder_io_64, 16, TRUE }
+};
+
+static
+void
+test_encode_reply_check(
+    const TestEncodeReplyData* test,
+    const void* out,
+    const GByteArray* bytes,
+    const GUtilIntArray* offsets,
+    GBinderIoOffsetsBuf* offsets_buf)
+{
+    GBinderIoTxData tx;
+    guint i;
+
+    if (test->heap) {
+        g_assert(offsets_buf->heap);
+    } else {
+        g_assert(!offsets_buf->heap);
+    }
+
+    /* Decode it back as if it came from the driver */
+    memset(&tx, 0, sizeof(tx));
+    test->io->decode_transaction_data(out, &tx);
+    g_assert(tx.data == bytes->data);
+    g_assert_cmpuint(tx.size, == ,bytes->len);
+    g_assert(tx.objects);
+    for (i = 0; i < test->count; i++) {
+        g_assert(tx.objects[i] == bytes->data + offsets->data[i]);
+    }
+    g_assert(!tx.objects[i]);
+    gbinder_buffer_objects_free(tx.objects);
+    g_free(offsets_buf->heap);
+}
+
+static
+void
+test_encode_reply(
+    gconstpointer test_data)
+{
+    const TestEncodeReplyData* test = test_data;
+    const GBinderIo* io = test->io;
+    /* Large enough for the 64-bit flat_binder_object */
+    const guint objsize = BINDER_OBJECT_SIZE_64;
+    GByteArray* bytes = g_byte_array_new();
+    GUtilIntArray* offsets = gutil_int_array_new();
+    GBinderIoOffsetsBuf offsets_buf;
+    guint64 out[GBINDER_MAX_BC_REPLY_SG_SIZE / sizeof(guint64)];
+    guint i;
+
+    g_byte_array_set_size(bytes, test->count * objsize);
+    memset(bytes->data, 0, bytes->len);
+    for (i = 0; i < test->count; i++) {
+        gutil_int_array_append(offsets, i * objsize);
+    }
+
+    /* BC_REPLY */
+    memset(&offsets_buf, 0, sizeof(offsets_buf));
+    g_assert(io->encode_reply(out, 0, 0, bytes, offsets, &offsets_buf));
+    test_encode_reply_check(test, out, bytes, offsets, &offsets_buf);
+
+    /* BC_REPLY_SG */
+    memset(&offsets_buf, 0, sizeof(offsets_buf));
+    g_assert(io->encode_reply_sg(out, 0, 0, bytes, offsets, &offsets_buf,
+        0));
+    test_encode_reply_check(test, out, bytes, offsets, &offsets_buf);
+
+    gutil_int_array_free(offsets, TRUE);
+    g_byte_array_free(bytes, TRUE);
+}
+
 /*==========================================================================*
  * Common
  *==========================================================================*/
@@ -146,11 +404,24 @@ int main(int argc, char* argv[])
 {
     TestConfig test_config;
     int result;
+    guint i;
 
     g_test_init(&argc, &argv, NULL);
     g_test_add_func(TEST_PREFIX "basic", test_basic);
     g_test_add_func(TEST_PREFIX "noop", test_noop);
+    g_test_add_func(TEST_PREFIX "stats", test_stats);
+    g_test_add_func(TEST_PREFIX "free_buffer", test_free_buffer);
+    g_test_add_func(TEST_PREFIX "free_buffer_unref", test_free_buffer_unref);
+    g_test_add_func(TEST_PREFIX "reply", test_reply);
     g_test_add_func(TEST_PREFIX "local_request", test_local_request);
+    for (i = 0; i < G_N_ELEMENTS(test_encode_reply_data); i++) {
+        const TestEncodeReplyData* test = test_encode_reply_data + i;
+        char* path = g_strconcat(TEST_PREFIX "encode_reply/", test->name,
+            NULL);
+
+        g_test_add_data_func(path, test, test_encode_reply);
+        g_free(path);
+    }
     test_init(&test_opt, argc, argv);
     test_config_init(&test_config, TMP_DIR_TEMPLATE);
     result = g_test_run();
@@ -40,6 +40,7 @@
 #include <errno.h>
 #include <sys/mman.h>
 #include <sys/syscall.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 static TestOpt test_opt;
@@ -348,6 +349,74 @@ test_read_write_counters(
     gbinder_fmq_unref(fmq);
 }
 
+/*==========================================================================*
+ * cache_line_align
+ *==========================================================================*/
+
+static
+void
+test_cache_line_align(
+    void)
+{
+    const gsize max_num_items = 5;
+    const gsize line = 64;
+    guint8 in_data[5] = { 1, 2, 3, 4, 5 };
+    guint8 out_data[5];
+    GBinderFmq* fmq = gbinder_fmq_new(sizeof(guint8), max_num_items,
+        GBINDER_FMQ_TYPE_SYNC_READ_WRITE,
+        GBINDER_FMQ_FLAG_CONFIGURE_EVENT_FLAG |
+        GBINDER_FMQ_FLAG_CACHE_LINE_ALIGN, -1, 0);
+    const GBinderMQDescriptor* desc;
+    const GBinderFmqGrantorDescriptor* grantors;
+    guint i;
+
+    g_assert(fmq);
+    desc = gbinder_fmq_get_descriptor(fmq);
+    grantors = desc->grantors.data.ptr;
+    g_assert_cmpuint(desc->grantors.count, == ,4);
+
+    /* Each grantor starts at its own cache line */
+    for (i = 0; i < desc->grantors.count; i++) {
+        g_assert_cmpuint(grantors[i].fd_index, == ,0);
+        g_assert_cmpuint(grantors[i].offset % line, == ,0);
+        if (i > 0) {
+            g_assert_cmpuint(grantors[i].offset, >= ,
+                grantors[i - 1].offset + grantors[i - 1].extent);
+        }
+    }
+    g_assert_cmpuint(grantors[0].offset, == ,0);
+    g_assert_cmpuint(grantors[1].offset, == ,line);
+    g_assert_cmpuint(grantors[2].offset, == ,2 * line);
+    g_assert_cmpuint(grantors[2].extent, == ,max_num_items);
+    g_assert_cmpuint(grantors[3].offset, == ,3 * line);
+
+    /* And the queue works as usual */
+    for (i = 0; i < 3; i++) {
+        memset(out_data, 0, sizeof(out_data));
+        g_assert(gbinder_fmq_write(fmq, in_data, 3));
+        g_assert(gbinder_fmq_read(fmq, out_data, 3));
+        g_assert(!memcmp(in_data, out_data, 3));
+    }
+    g_assert(gbinder_fmq_write(fmq, in_data, max_num_items));
+    g_assert(!gbinder_fmq_write(fmq, in_data, 1));
+    g_assert(gbinder_fmq_read(fmq, out_data, max_num_items));
+    g_assert(!memcmp(in_data, out_data, max_num_items));
+    gbinder_fmq_unref(fmq);
+
+    /* Default layout is as compact as before */
+    fmq = gbinder_fmq_new(sizeof(guint8), max_num_items,
+        GBINDER_FMQ_TYPE_SYNC_READ_WRITE,
+        GBINDER_FMQ_FLAG_CONFIGURE_EVENT_FLAG, -1, 0);
+    g_assert(fmq);
+    desc = gbinder_fmq_get_descriptor(fmq);
+    grantors = desc->grantors.data.ptr;
+    g_assert_cmpuint(grantors[0].offset, == ,0);
+    g_assert_cmpuint(grantors[1].offset, == ,8);
+    g_assert_cmpuint(grantors[2].offset, == ,16);
+    g_assert_cmpuint(grantors[3].offset, == ,24);
+    gbinder_fmq_unref(fmq);
+}
+
 /*==========================================================================*
  * read/write external fd
  *==========================================================================*/
@@ -418,6 +487,253 @@ test_ref(
     gbinder_fmq_unref(fmq);
 }
 
+/*==========================================================================*
+ * tx
+ *==========================================================================*/
+
+static
+void
+test_tx(
+    void)
+{
+    const gsize max_num_items = 8;
+    guint32 in_data[8];
+    guint32 out_data[8];
+    GBinderFmqTx tx;
+    guint i;
+    GBinderFmq* fmq = gbinder_fmq_new(sizeof(guint32), max_num_items,
+        GBINDER_FMQ_TYPE_SYNC_READ_WRITE, 0, -1, 0);
+
+    g_assert(fmq);
+    for (i = 0; i < max_num_items; i++) {
+        in_data[i] = g_random_int();
+    }
+
+    /* Invalid parameters */
+    g_assert(!gbinder_fmq_begin_read_tx(NULL, 1, &tx));
+    g_assert(!gbinder_fmq_begin_write_tx(NULL, 1, &tx));
+    g_assert(!gbinder_fmq_begin_read_tx(fmq, 1, NULL));
+    g_assert(!gbinder_fmq_begin_write_tx(fmq, 1, NULL));
+    g_assert(!gbinder_fmq_begin_read_tx(fmq, 0, &tx));
+    g_assert(!gbinder_fmq_begin_write_tx(fmq, 0, &tx));
+    g_assert(!gbinder_fmq_begin_write_tx(fmq, max_num_items + 1, &tx));
+
+    /* Nothing to read */
+    g_assert(!gbinder_fmq_begin_read_tx(fmq, 1, &tx));
+
+    /* No wrap-around */
+    g_assert(gbinder_fmq_begin_write_tx(fmq, 6, &tx));
+    g_assert(tx.first.data);
+    g_assert_cmpuint(tx.first.items, == ,6);
+    g_assert(!tx.second.data);
+    g_assert_cmpuint(tx.second.items, == ,0);
+    memcpy(tx.first.data, in_data, 6 * sizeof(guint32));
+    gbinder_fmq_end_write(fmq, 6);
+
+    g_assert(gbinder_fmq_begin_read_tx(fmq, 6, &tx));
+    g_assert_cmpuint(tx.first.items, == ,6);
+    g_assert(!tx.second.data);
+    g_assert(!memcmp(tx.first.data, in_data, 6 * sizeof(guint32)));
+    gbinder_fmq_end_read(fmq, 6);
+
+    /* The next 5 items wrap around */
+    g_assert(gbinder_fmq_begin_write_tx(fmq, 5, &tx));
+    g_assert_cmpuint(tx.first.items, == ,2);
+    g_assert_cmpuint(tx.second.items, == ,3);
+    g_assert(tx.second.data);
+    g_assert((guint8*)tx.first.data == (guint8*)tx.second.data +
+        6 * sizeof(guint32));
+    memcpy(tx.first.data, in_data, 2 * sizeof(guint32));
+    memcpy(tx.second.data, in_data + 2, 3 * sizeof(guint32));
+    gbinder_fmq_end_write(fmq, 5);
+
+    /* Not enough room for more than 3 */
+    g_assert(!gbinder_fmq_begin_write_tx(fmq, 4, &tx));
+
+    /* Not that much to read either */
+    g_assert(!gbinder_fmq_begin_read_tx(fmq, 6, &tx));
+    g_assert(gbinder_fmq_begin_read_tx(fmq, 5, &tx));
+    g_assert_cmpuint(tx.first.items, == ,2);
+    g_assert_cmpuint(tx.second.items, == ,3);
+    memcpy(out_data, tx.first.data, 2 * sizeof(guint32));
+    memcpy(out_data + 2, tx.second.data, 3 * sizeof(guint32));
+    g_assert(!memcmp(out_data, in_data, 5 * sizeof(guint32)));
+    gbinder_fmq_end_read(fmq, 5);
+    g_assert_cmpuint(gbinder_fmq_available_to_read(fmq), == ,0);
+
+    gbinder_fmq_unref(fmq);
+}
+
+/*==========================================================================*
+ * readv/writev
+ *==========================================================================*/
+
+static
+void
+test_readv_writev(
+    void)
+{
+    const gsize max_num_items = 8;
+    guint32 in_data[5];
+    guint32 out_data[5];
+    struct iovec iov[3];
+    guint i;
+    GBinderFmq* fmq = gbinder_fmq_new(sizeof(guint32), max_num_items,
+        GBINDER_FMQ_TYPE_SYNC_READ_WRITE, 0, -1, 0);
+
+    g_assert(fmq);
+    for (i = 0; i < G_N_ELEMENTS(in_data); i++) {
+        in_data[i] = g_random_int();
+    }
+
+    /* Invalid parameters */
+    iov[0].iov_base = in_data;
+    iov[0].iov_len = sizeof(in_data);
+    g_assert(!gbinder_fmq_writev(NULL, iov, 1));
+    g_assert(!gbinder_fmq_readv(NULL, iov, 1));
+    g_assert(!gbinder_fmq_writev(fmq, NULL, 1));
+    g_assert(!gbinder_fmq_readv(fmq, NULL, 1));
+    g_assert(!gbinder_fmq_writev(fmq, iov, 0));
+
+    /* Not a multiple of the item size */
+    iov[0].iov_len = 3;
+    g_assert(!gbinder_fmq_writev(fmq, iov, 1));
+
+    /* NULL data */
+    iov[0].iov_base = NULL;
+    iov[0].iov_len = 4;
+    g_assert(!gbinder_fmq_writev(fmq, iov, 1));
+
+    /* Buffers don't have to be split at item boundaries */
+    for (i = 0; i < 4; i++) {
+        iov[0].iov_base = in_data;
+        iov[0].iov_len = 3;
+        iov[1].iov_base = (guint8*)in_data + 3;
+        iov[1].iov_len = 0;
+        iov[2].iov_base = (guint8*)in_data + 3;
+        iov[2].iov_len = sizeof(in_data) - 3;
+        g_assert(gbinder_fmq_writev(fmq, iov, 3));
+        g_assert_cmpuint(gbinder_fmq_available_to_read(fmq), == ,5);
+
+        /* Too much */
+        g_assert(!gbinder_fmq_writev(fmq, iov, 3));
+
+        memset(out_data, 0, sizeof(out_data));
+        iov[0].iov_base = out_data;
+        iov[0].iov_len = 9;
+        iov[1].iov_base = (guint8*)out_data + 9;
+        iov[1].iov_len = sizeof(out_data) - 9;
+        g_assert(gbinder_fmq_readv(fmq, iov, 2));
+        g_assert(!memcmp(out_data, in_data, sizeof(in_data)));
+        g_assert_cmpuint(gbinder_fmq_available_to_read(fmq), == ,0);
+
+        /* Nothing left */
+        g_assert(!gbinder_fmq_readv(fmq, iov, 2));
+    }
+
+    gbinder_fmq_unref(fmq);
+}
+
+/*==========================================================================*
+ * readers
+ *==========================================================================*/
+
+static
+void
+test_readers(
+    void)
+{
+    const gsize max_num_items = 8;
+    guint32 in_data[8];
+    guint32 out_data[8];
+    GBinderFmqOverruns overruns;
+    GBinderFmqReader* r1;
+    GBinderFmqReader* r2;
+    GBinderFmqTx tx;
+    guint i;
+    GBinderFmq* fmq = gbinder_fmq_new(sizeof(guint32), max_num_items,
+        GBINDER_FMQ_TYPE_SYNC_READ_WRITE, 0, -1, 0);
+
+    /* Synchronized queue can't have additional readers */
+    g_assert(fmq);
+    g_assert(!gbinder_fmq_reader_new(fmq));
+    gbinder_fmq_unref(fmq);
+
+    /* NULL resistance */
+    g_assert(!gbinder_fmq_reader_new(NULL));
+    gbinder_fmq_reader_free(NULL);
+    g_assert_cmpuint(gbinder_fmq_reader_available(NULL), == ,0);
+    g_assert(!gbinder_fmq_reader_begin_tx(NULL, 1, &tx));
+    g_assert(!gbinder_fmq_reader_end_read(NULL, 1));
+    g_assert(!gbinder_fmq_reader_read(NULL, out_data, 1));
+    gbinder_fmq_reader_get_overruns(NULL, NULL);
+    gbinder_fmq_get_overruns(NULL, NULL);
+    memset(&overruns, 0xff, sizeof(overruns));
+    gbinder_fmq_reader_get_overruns(NULL, &overruns);
+    g_assert_cmpuint(overruns.lost, == ,0);
+    g_assert_cmpuint(overruns.resyncs, == ,0);
+    memset(&overruns, 0xff, sizeof(overruns));
+    gbinder_fmq_get_overruns(NULL, &overruns);
+    g_assert_cmpuint(overruns.lost, == ,0);
+    g_assert_cmpuint(overruns.resyncs, == ,0);
+
+    fmq = gbinder_fmq_new(sizeof(guint32), max_num_items,
+        GBINDER_FMQ_TYPE_UNSYNC_WRITE, 0, -1, 0);
+    g_assert(fmq);
+    for (i = 0; i < max_num_items; i++) {
+        in_data[i] = i + 1;
+    }
+
+    /* Readers only see what's been written after they were created */
+    g_assert(gbinder_fmq_write(fmq, in_data, 3));
+    r1 = gbinder_fmq_reader_new(fmq);
+    g_assert(r1);
+    g_assert_cmpuint(gbinder_fmq_reader_available(r1), == ,0);
+    g_assert(gbinder_fmq_write(fmq, in_data + 3, 5));
+    r2 = gbinder_fmq_reader_new(fmq);
+    g_assert(r2);
+    g_assert_cmpuint(gbinder_fmq_reader_available(r1), == ,5);
+    g_assert_cmpuint(gbinder_fmq_reader_available(r2), == ,0);
+    g_assert_cmpuint(gbinder_fmq_available_to_read(fmq), == ,8);
+    g_assert(!gbinder_fmq_reader_read(r1, NULL, 1));
+    g_assert(!gbinder_fmq_reader_read(r1, out_data, 0));
+    g_assert(gbinder_fmq_reader_read(r1, out_data, 5));
+    g_assert(!memcmp(out_data, in_data + 3, 5 * sizeof(guint32)));
+
+    /* The writer laps the queue's own reader */
+    g_assert(gbinder_fmq_write(fmq, in_data, max_num_items));
+    g_assert(!gbinder_fmq_read(fmq, out_data, 1));
+    gbinder_fmq_get_overruns(fmq, &overruns);
+    g_assert_cmpuint(overruns.lost, == ,16);
+    g_assert_cmpuint(overruns.resyncs, == ,1);
+
+    /* But not the second one */
+    g_assert(gbinder_fmq_reader_read(r2, out_data, max_num_items));
+    g_assert(!memcmp(out_data, in_data, sizeof(in_data)));
+    gbinder_fmq_reader_get_overruns(r2, &overruns);
+    g_assert_cmpuint(overruns.lost, == ,0);
+    g_assert_cmpuint(overruns.resyncs, == ,0);
+
+    /* Data overwritten while the first one was reading it */
+    g_assert_cmpuint(gbinder_fmq_reader_available(r1), == ,8);
+    g_assert(gbinder_fmq_reader_begin_tx(r1, 2, &tx));
+    g_assert(gbinder_fmq_write(fmq, in_data, 2));
+    g_assert(!gbinder_fmq_reader_end_read(r1, 2));
+    gbinder_fmq_reader_get_overruns(r1, &overruns);
+    g_assert_cmpuint(overruns.lost, == ,10);
+    g_assert_cmpuint(overruns.resyncs, == ,1);
+    g_assert_cmpuint(gbinder_fmq_reader_available(r1), == ,0);
+    g_assert_cmpuint(gbinder_fmq_reader_available(r2), == ,2);
+
+    /* Readers keep the queue alive */
+    gbinder_fmq_unref(fmq);
+    g_assert(gbinder_fmq_reader_begin_tx(r2, 2, &tx));
+    g_assert(!memcmp(tx.first.data, in_data, 2 * sizeof(guint32)));
+    g_assert(gbinder_fmq_reader_end_read(r2, 2));
+    gbinder_fmq_reader_free(r1);
+    gbinder_fmq_reader_free(r2);
+}
+
 /*==========================================================================*
  * wait/wake
  *==========================================================================*/
@@ -480,6 +796,139 @@ test_wait_wake(
     gbinder_fmq_unref(fmq);
 }
 
+/*==========================================================================*
+ * blocking
+ *==========================================================================*/
+
+#define TEST_BLOCKING_COUNT (3000)
+
+static
+gpointer
+test_blocking_reader(
+    gpointer fmq)
+{
+    guint32 expected = 0;
+    guint i;
+
+    for (i = 0; i < TEST_BLOCKING_COUNT; i++) {
+        guint32 data[3];
+
+        g_assert(gbinder_fmq_read_blocking(fmq, data, 3,
+            GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, -1));
+        g_assert_cmpuint(data[0], == ,expected);
+        g_assert_cmpuint(data[1], == ,expected + 1);
+        g_assert_cmpuint(data[2], == ,expected + 2);
+        expected += 3;
+    }
+    return NULL;
+}
+
+static
+void
+test_blocking_run(
+    GBINDER_FMQ_FLAGS flags)
+{
+    const gsize max_num_items = 8;
+    const int ms = 10;
+    guint32 data[9];
+    guint i;
+    GBinderFmq* fmq = gbinder_fmq_new(sizeof(guint32), max_num_items,
+        GBINDER_FMQ_TYPE_SYNC_READ_WRITE, flags |
+        GBINDER_FMQ_FLAG_CONFIGURE_EVENT_FLAG, -1, 0);
+    int result;
+
+    g_assert(fmq);
+    memset(data, 0, sizeof(data));
+
+    /* Invalid parameters */
+    g_assert(!gbinder_fmq_read_blocking(NULL, data, 1,
+        GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, ms));
+    g_assert(!gbinder_fmq_write_blocking(NULL, data, 1,
+        GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, ms));
+    g_assert(!gbinder_fmq_read_blocking(fmq, NULL, 1,
+        GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, ms));
+    g_assert(!gbinder_fmq_write_blocking(fmq, NULL, 1,
+        GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, ms));
+    g_assert(!gbinder_fmq_read_blocking(fmq, data, 0,
+        GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, ms));
+    g_assert(!gbinder_fmq_read_blocking(fmq, data, 1,
+        0, GBINDER_FMQ_NOT_EMPTY, ms));
+    g_assert(!gbinder_fmq_write_blocking(fmq, data, 1,
+        GBINDER_FMQ_NOT_FULL, 0, ms));
+
+    /* More than would ever fit */
+    g_assert(!gbinder_fmq_write_blocking(fmq, data, max_num_items + 1,
+        GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, -1));
+    g_assert(!gbinder_fmq_read_blocking(fmq, data, max_num_items + 1,
+        GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, -1));
+
+    /* Nothing to read */
+    g_assert(!gbinder_fmq_read_blocking(fmq, data, 1,
+        GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, 0));
+
+    /* Only run the timed tests if FUTEX_WAKE_BITSET is supported */
+    result = gbinder_fmq_wake(fmq, 0x4);
+    g_assert(result == 0 || result == -ENOSYS);
+    if (result == 0) {
+        GThread* reader;
+
+        g_assert(!gbinder_fmq_read_blocking(fmq, data, 1,
+            GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, ms));
+
+        /* Fill it up */
+        g_assert(gbinder_fmq_write_blocking(fmq, data, max_num_items,
+            GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, 0));
+        g_assert(!gbinder_fmq_write_blocking(fmq, data, 1,
+            GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, ms));
+        g_assert(gbinder_fmq_read_blocking(fmq, data, max_num_items,
+            GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, ms));
+
+        /* Producer and consumer */
+        reader = g_thread_new("reader", test_blocking_reader, fmq);
+        for (i = 0; i < TEST_BLOCKING_COUNT; i++) {
+            data[0] = 3 * i;
+            data[1] = 3 * i + 1;
+            data[2] = 3 * i + 2;
+            g_assert(gbinder_fmq_write_blocking(fmq, data, 3,
+                GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, -1));
+        }
+        g_thread_join(reader);
+        g_assert_cmpuint(gbinder_fmq_available_to_read(fmq), == ,0);
+    }
+    gbinder_fmq_unref(fmq);
+
+    /* No event flag */
+    fmq = gbinder_fmq_new(sizeof(guint32), max_num_items,
+        GBINDER_FMQ_TYPE_SYNC_READ_WRITE, flags, -1, 0);
+    g_assert(!gbinder_fmq_write_blocking(fmq, data, 1,
+        GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, ms));
+    gbinder_fmq_unref(fmq);
+
+    /* Unsynchronized queue */
+    fmq = gbinder_fmq_new(sizeof(guint32), max_num_items,
+        GBINDER_FMQ_TYPE_UNSYNC_WRITE, flags |
+        GBINDER_FMQ_FLAG_CONFIGURE_EVENT_FLAG, -1, 0);
+    g_assert(!gbinder_fmq_write_blocking(fmq, data, 1,
+        GBINDER_FMQ_NOT_FULL, GBINDER_FMQ_NOT_EMPTY, ms));
+    gbinder_fmq_unref(fmq);
+}
+
+static
+void
+test_blocking(
+    void)
+{
+    test_blocking_run(0);
+}
+
+static
+void
+test_blocking_spin(
+    void)
+{
+    test_blocking_run(GBINDER_FMQ_FLAG_SPIN_WAIT);
+}
+
 /*==========================================================================*
  * zero copy
  *==========================================================================*/
@@ -576,10 +1025,16 @@ int main(int argc, char* argv[])
             g_free(path);
         }
         g_test_add_func(TEST_("read_write_counters"), test_read_write_counters);
+        g_test_add_func(TEST_("cache_line_align"), test_cache_line_align);
         g_test_add_func(TEST_("read_write_external_fd"),
             test_read_write_external_fd);
         g_test_add_func(TEST_("ref"), test_ref);
+        g_test_add_func(TEST_("tx"), test_tx);
+        g_test_add_func(TEST_("readv_writev"), test_readv_writev);
+        g_test_add_func(TEST_("readers"), test_readers);
         g_test_add_func(TEST_("wait_wake"), test_wait_wake);
+        g_test_add_func(TEST_("blocking"), test_blocking);
+        g_test_add_func(TEST_("blocking_spin"), test_blocking_spin);
         g_test_add_func(TEST_("zero_copy"), test_zero_copy);
     }
 #else /* GBINDER_FMQ_SUPPORTED */
@@ -33,6 +33,7 @@
 #include "test_binder.h"
 
 #include "gbinder_ipc.h"
+#include "gbinder_config.h"
 #include "gbinder_driver.h"
 #include "gbinder_local_object_p.h"
 #include "gbinder_local_reply_p.h"
@@ -116,6 +117,7 @@ test_null(
     g_assert(!gbinder_ipc_transact_custom(NULL, NULL, NULL, NULL, NULL));
     g_assert(!gbinder_ipc_object_registry(NULL));
     gbinder_ipc_looper_check(NULL);
+    g_assert(!gbinder_ipc_set_looper_limits(NULL, 1, 1));
     gbinder_ipc_cancel(NULL, 0);
 
     g_assert(!gbinder_object_registry_ref(NULL));
@@ -245,6 +247,71 @@ test_async_oneway(
     g_main_loop_unref(loop);
 }
 
+/*==========================================================================*
+ * async_oneway_order
+ *==========================================================================*/
+
+#define TEST_ASYNC_ONEWAY_ORDER_COUNT (10)
+
+typedef struct test_async_oneway_order_data {
+    GMainLoop* loop;
+    int done;
+} TestAsyncOnewayOrderData;
+
+typedef struct test_async_oneway_order_tx {
+    TestAsyncOnewayOrderData* test;
+    int index;
+} TestAsyncOnewayOrderTx;
+
+static
+void
+test_async_oneway_order_done(
+    GBinderIpc* ipc,
+    GBinderRemoteReply* reply,
+    int status,
+    void* user_data)
+{
+    TestAsyncOnewayOrderTx* tx = user_data;
+    TestAsyncOnewayOrderData* test = tx->test;
+
+    /* Transactions are completed in the order they were issued */
+    g_assert(!status);
+    g_assert(!reply);
+    g_assert_cmpint(tx->index, == ,test->done);
+    if (++test->done == TEST_ASYNC_ONEWAY_ORDER_COUNT) {
+        test_quit_later(test->loop);
+    }
+}
+
+static
+void
+test_async_oneway_order(
+    void)
+{
+    GBinderIpc* ipc = gbinder_ipc_new(GBINDER_DEFAULT_BINDER, NULL);
+    GBinderLocalRequest* req = test_local_request_new(ipc);
+    const int fd = gbinder_driver_fd(ipc->driver);
+    TestAsyncOnewayOrderTx tx[TEST_ASYNC_ONEWAY_ORDER_COUNT];
+    TestAsyncOnewayOrderData test;
+    int i;
+
+    memset(&test, 0, sizeof(test));
+    test.loop = g_main_loop_new(NULL, FALSE);
+    for (i = 0; i < TEST_ASYNC_ONEWAY_ORDER_COUNT; i++) {
+        tx[i].test = &test;
+        tx[i].index = i;
+        test_binder_br_transaction_complete(fd, TX_THREAD);
+        g_assert(gbinder_ipc_transact(ipc, 0, 1, GBINDER_TX_FLAG_ONEWAY,
+            req, test_async_oneway_order_done, NULL, tx + i));
+    }
+    test_run(&test_opt, test.loop);
+    g_assert_cmpint(test.done, == ,TEST_ASYNC_ONEWAY_ORDER_COUNT);
+
+    gbinder_local_request_unref(req);
+    gbinder_ipc_unref(ipc);
+    g_main_loop_unref(test.loop);
+}
+
 /*==========================================================================*
  * sync_oneway
  *==========================================================================*/
@@ -986,6 +1053,254 @@ test_transact_incoming(
     test_run_in_context(&test_opt, test_transact_incoming_run);
 }
 
+/*==========================================================================*
+ * spawn_looper
+ *==========================================================================*/
+
+static
+void
+test_spawn_looper_run(
+    void)
+{
+    GBinderIpc* ipc = gbinder_ipc_new(GBINDER_DEFAULT_BINDER, NULL);
+    const int fd = gbinder_driver_fd(ipc->driver);
+    const char* dev = gbinder_driver_dev(ipc->driver);
+    const GBinderRpcProtocol* prot = gbinder_rpc_protocol_for_device(dev);
+    const char* const ifaces[] = { "test", NULL };
+    GMainLoop* loop = g_main_loop_new(NULL, FALSE);
+    GBinderLocalObject* obj;
+    GBinderLocalRequest* req = test_local_request_new(ipc);
+    GBinderWriter writer;
+
+    /* Invalid limits */
+    g_assert(!gbinder_ipc_set_looper_limits(ipc, 0, 1));
+    g_assert(!gbinder_ipc_set_looper_limits(ipc, 3, 2));
+    g_assert(gbinder_ipc_set_looper_limits(ipc, 1, 3));
+
+    /* Registering the object starts the primary looper */
+    obj = gbinder_local_object_new(ipc, ifaces,
+        test_transact_incoming_proc, loop);
+    g_assert_cmpuint(gbinder_ipc_looper_count(ipc), == ,1);
+
+    /* Two loopers need to be started now */
+    g_assert(gbinder_ipc_set_looper_limits(ipc, 2, 3));
+    g_assert_cmpuint(gbinder_ipc_looper_count(ipc), == ,2);
+
+    gbinder_local_request_init_writer(req, &writer);
+    prot->write_rpc_header(&writer, "test");
+    gbinder_writer_append_string8(&writer, "message");
+
+    /* And one more is requested by the driver */
+    test_binder_br_spawn_looper(fd, LOOPER_THREAD);
+    test_binder_br_transaction(fd, LOOPER_THREAD, obj, 1,
+        gbinder_local_request_data(req)->bytes);
+    test_binder_br_transaction_complete(fd, LOOPER_THREAD); /* For reply */
+    test_run(&test_opt, loop);
+
+    /* BR_SPAWN_LOOPER may be handled by the other looper thread */
+    while (gbinder_ipc_looper_count(ipc) < 3) {
+        g_usleep(1000);
+    }
+    g_assert_cmpuint(gbinder_ipc_looper_count(ipc), == ,3);
+
+    /* Now we need to wait until GBinderIpc is destroyed */
+    GDEBUG("waiting for GBinderIpc to get destroyed");
+    g_object_weak_ref(G_OBJECT(ipc), test_quit_when_destroyed, loop);
+    gbinder_local_object_unref(obj);
+    gbinder_local_request_unref(req);
+    g_idle_add(test_unref_ipc, ipc);
+    test_run(&test_opt, loop);
+
+    test_binder_exit_wait(&test_opt, loop);
+    g_main_loop_unref(loop);
+}
+
+static
+void
+test_spawn_looper(
+    void)
+{
+    test_run_in_context(&test_opt, test_spawn_looper_run);
+}
+
+/*==========================================================================*
+ * spawned_looper_exit
+ *==========================================================================*/
+
+typedef struct test_spawned_looper_exit {
+    GMainLoop* loop;
+    GBinderRemoteRequest* req[2];
+    guint count;
+} TestSpawnedLooperExit;
+
+static
+GBinderLocalReply*
+test_spawned_looper_exit_proc(
+    GBinderLocalObject* obj,
+    GBinderRemoteRequest* req,
+    guint code,
+    guint flags,
+    int* status,
+    void* user_data)
+{
+    TestSpawnedLooperExit* test = user_data;
+
+    GVERBOSE_("\"%s\" %u", gbinder_remote_request_interface(req), code);
+    g_assert_cmpuint(test->count, < ,G_N_ELEMENTS(test->req));
+
+    /* Keep both loopers busy until both requests have arrived */
+    gbinder_remote_request_block(req);
+    test->req[test->count++] = gbinder_remote_request_ref(req);
+    if (test->count == G_N_ELEMENTS(test->req)) {
+        test_quit_later(test->loop);
+    }
+    return NULL;
+}
+
+static
+void
+test_spawned_looper_exit_run(
+    void)
+{
+    GBinderIpc* ipc = gbinder_ipc_new(GBINDER_DEFAULT_BINDER, NULL);
+    const int fd = gbinder_driver_fd(ipc->driver);
+    const char* dev = gbinder_driver_dev(ipc->driver);
+    const GBinderRpcProtocol* prot = gbinder_rpc_protocol_for_device(dev);
+    const char* const ifaces[] = { "test", NULL };
+    GMainLoop* loop = g_main_loop_new(NULL, FALSE);
+    GBinderLocalRequest* req = test_local_request_new(ipc);
+    GBinderLocalObject* obj;
+    TestSpawnedLooperExit test;
+    GBinderWriter writer;
+    guint i;
+
+    memset(&test, 0, sizeof(test));
+    test.loop = loop;
+
+    /* No room for spawned loopers */
+    g_assert(gbinder_ipc_set_looper_limits(ipc, 1, 1));
+    g_assert_cmpuint(test_binder_max_threads(fd), == ,0);
+    obj = gbinder_local_object_new(ipc, ifaces,
+        test_spawned_looper_exit_proc, &test);
+    g_assert_cmpuint(gbinder_ipc_looper_count(ipc), == ,1);
+
+    /* But the kernel requests one anyway */
+    test_binder_br_spawn_looper(fd, LOOPER_THREAD);
+    while (gbinder_ipc_looper_count(ipc) < 2) {
+        g_usleep(1000);
+    }
+
+    /*
+     * Block both loopers. Once the requests are completed, there are
+     * too many primary loopers and both blocked ones exit.
+     */
+    gbinder_local_request_init_writer(req, &writer);
+    prot->write_rpc_header(&writer, "test");
+    gbinder_writer_append_string8(&writer, "message");
+    for (i = 0; i < G_N_ELEMENTS(test.req); i++) {
+        test_binder_br_transaction(fd, LOOPER_THREAD, obj, 1,
+            gbinder_local_request_data(req)->bytes);
+        test_binder_br_transaction_complete(fd, LOOPER_THREAD); /* Reply */
+    }
+    test_run(&test_opt, loop);
+
+    for (i = 0; i < G_N_ELEMENTS(test.req); i++) {
+        GBinderLocalReply* reply = gbinder_local_object_new_reply(obj);
+
+        gbinder_remote_request_complete(test.req[i], reply, 0);
+        gbinder_remote_request_unref(test.req[i]);
+        gbinder_local_reply_unref(reply);
+    }
+
+    /* The kernel has to be allowed to spawn another looper */
+    while (test_binder_max_threads(fd) < 1) {
+        g_usleep(1000);
+    }
+    g_assert_cmpuint(test_binder_max_threads(fd), == ,1);
+
+    /* Now we need to wait until GBinderIpc is destroyed */
+    GDEBUG("waiting for GBinderIpc to get destroyed");
+    g_object_weak_ref(G_OBJECT(ipc), test_quit_when_destroyed, loop);
+    gbinder_local_object_unref(obj);
+    gbinder_local_request_unref(req);
+    g_idle_add(test_unref_ipc, ipc);
+    test_run(&test_opt, loop);
+
+    test_binder_exit_wait(&test_opt, loop);
+    g_main_loop_unref(loop);
+}
+
+static
+void
+test_spawned_looper_exit(
+    void)
+{
+    test_run_in_context(&test_opt, test_spawned_looper_exit_run);
+}
+
+/*==========================================================================*
+ * looper_config
+ *==========================================================================*/
+
+static
+void
+test_looper_config(
+    void)
+{
+    static const char config[] =
+        "[Loopers]\n"
+        "Default = 2,7\n"
+        "/dev/binder = 3,4\n"
+        "/dev/hwbinder = 0,4\n"
+        "/dev/vndbinder = 5,3\n"
+        "/dev/foo = 2,\n";
+    const char* default_config = gbinder_config_file;
+    char* dir = g_dir_make_tmp(TMP_DIR_TEMPLATE, NULL);
+    char* file = g_build_filename(dir, "test.conf", NULL);
+    GMainLoop* loop = g_main_loop_new(NULL, FALSE);
+    GBinderIpc* ipc;
+    GBinderIpc* hw;
+    GBinderIpc* vnd;
+    guint min, max;
+
+    g_assert(g_file_set_contents(file, config, -1, NULL));
+    gbinder_config_exit();
+    gbinder_config_file = file;
+
+    /* Per-device entry */
+    ipc = gbinder_ipc_new(GBINDER_DEFAULT_BINDER, NULL);
+    gbinder_ipc_get_looper_limits(ipc, &min, &max);
+    g_assert_cmpuint(min, == ,3);
+    g_assert_cmpuint(max, == ,4);
+
+    /* Invalid values fall back to the default entry */
+    hw = gbinder_ipc_new(GBINDER_DEFAULT_HWBINDER, NULL);
+    gbinder_ipc_get_looper_limits(hw, &min, &max);
+    g_assert_cmpuint(min, == ,2);
+    g_assert_cmpuint(max, == ,7);
+
+    vnd = gbinder_ipc_new("/dev/vndbinder", NULL);
+    gbinder_ipc_get_looper_limits(vnd, &min, &max);
+    g_assert_cmpuint(min, == ,2);
+    g_assert_cmpuint(max, == ,7);
+
+    /* Nothing is started until the first local object is registered */
+    g_assert_cmpuint(gbinder_ipc_looper_count(ipc), == ,0);
+
+    gbinder_ipc_unref(ipc);
+    gbinder_ipc_unref(hw);
+    gbinder_ipc_unref(vnd);
+    test_binder_exit_wait(&test_opt, loop);
+    g_main_loop_unref(loop);
+
+    gbinder_config_exit();
+    gbinder_config_file = default_config;
+    remove(file);
+    g_free(file);
+    remove(dir);
+    g_free(dir);
+}
+
 /*==========================================================================*
  * transact_status_reply
  *==========================================================================*/
@@ -1358,6 +1673,7 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("basic"), test_basic);
     g_test_add_func(TEST_("protocol"), test_protocol);
     g_test_add_func(TEST_("async_oneway"), test_async_oneway);
+    g_test_add_func(TEST_("async_oneway_order"), test_async_oneway_order);
     g_test_add_func(TEST_("sync_oneway"), test_sync_oneway);
     g_test_add_func(TEST_("sync_reply_ok"), test_sync_reply_ok);
     g_test_add_func(TEST_("sync_reply_error"), test_sync_reply_error);
@@ -1373,6 +1689,9 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("transact_2way"), test_transact_2way);
     g_test_add_func(TEST_("transact_incoming"), test_transact_incoming);
     g_test_add_func(TEST_("transact_unhandled"), test_transact_unhandled);
+    g_test_add_func(TEST_("spawn_looper"), test_spawn_looper);
+    g_test_add_func(TEST_("spawned_looper_exit"), test_spawned_looper_exit);
+    g_test_add_func(TEST_("looper_config"), test_looper_config);
     g_test_add_func(TEST_("transact_status_reply"), test_transact_status_reply);
     g_test_add_func(TEST_("transact_async"), test_transact_async);
     g_test_add_func(TEST_("transact_async_sync"), test_transact_async_sync);
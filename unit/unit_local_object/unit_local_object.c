@@ -116,6 +116,8 @@ test_null(
     int status = 0;
 
     g_assert(!gbinder_local_object_new(NULL, NULL, NULL, NULL));
+    g_assert(!gbinder_local_object_new_concurrent(NULL, NULL, NULL, NULL,
+        NULL));
     g_assert(!gbinder_local_object_ref(NULL));
     gbinder_local_object_unref(NULL);
     gbinder_local_object_drop(NULL);
@@ -615,6 +617,240 @@ test_reply_status(
     test_binder_exit_wait(&test_opt, NULL);
 }
 
+/*==========================================================================*
+ * concurrent
+ *==========================================================================*/
+
+typedef struct test_concurrent_data {
+    int count;
+    int destroyed;
+    guint code;
+    gboolean drop;
+} TestConcurrentData;
+
+static
+void
+test_concurrent_destroy(
+    gpointer user_data)
+{
+    TestConcurrentData* test = user_data;
+
+    test->destroyed++;
+}
+
+static
+GBinderLocalReply*
+test_concurrent_handler(
+    GBinderLocalObject* obj,
+    GBinderRemoteRequest* req,
+    guint code,
+    guint flags,
+    int* status,
+    void* user_data)
+{
+    TestConcurrentData* test = user_data;
+
+    g_assert(!g_strcmp0(gbinder_remote_request_interface(req), custom_iface));
+    g_assert_cmpuint(code, == ,test->code);
+    if (test->drop) {
+        /* Dropping the object from its own handler must not deadlock */
+        gbinder_local_object_drop(obj);
+        /* And user_data must stay alive until the call completes */
+        g_assert_cmpint(test->destroyed, == ,0);
+    }
+    *status = GBINDER_STATUS_OK;
+    test->count++;
+    return gbinder_local_object_new_reply(obj);
+}
+
+static
+void
+test_concurrent(
+    void)
+{
+    static const guint8 req_data [] = { CUSTOM_INTERFACE_HEADER_BYTES };
+    const char* const ifaces[] = { custom_iface, NULL };
+    int status = INT_MAX;
+    const char* dev = GBINDER_DEFAULT_HWBINDER;
+    const GBinderRpcProtocol* prot = gbinder_rpc_protocol_for_device(dev);
+    GBinderIpc* ipc = gbinder_ipc_new(dev, NULL);
+    GBinderObjectRegistry* reg = gbinder_ipc_object_registry(ipc);
+    GBinderRemoteRequest* req = gbinder_remote_request_new(reg, prot, 0, 0);
+    TestConcurrentData test;
+    GBinderLocalObject* obj;
+    GBinderLocalReply* reply;
+
+    memset(&test, 0, sizeof(test));
+    test.code = CUSTOM_TRANSACTION;
+    obj = gbinder_local_object_new_concurrent(ipc, ifaces,
+        test_concurrent_handler, &test, test_concurrent_destroy);
+    gbinder_remote_request_set_data(req, HIDL_PING_TRANSACTION,
+        gbinder_buffer_new(ipc->driver, g_memdup(req_data, sizeof(req_data)),
+        sizeof(req_data), NULL));
+
+    /* Everything is handled on the looper thread */
+    g_assert(gbinder_local_object_can_handle_transaction(obj, custom_iface,
+        CUSTOM_TRANSACTION) == GBINDER_LOCAL_TRANSACTION_LOOPER);
+    reply = gbinder_local_object_handle_looper_transaction(obj, req,
+        CUSTOM_TRANSACTION, 0, &status);
+    g_assert(reply);
+    g_assert(status == GBINDER_STATUS_OK);
+    g_assert(test.count == 1);
+    gbinder_local_reply_unref(reply);
+
+    /* No calls in progress, user_data is released right away */
+    gbinder_local_object_ref(obj);
+    gbinder_local_object_drop(obj);
+    g_assert(test.destroyed == 1);
+
+    /* Not after the object has been dropped */
+    status = INT_MAX;
+    g_assert(!gbinder_local_object_handle_looper_transaction(obj, req,
+        CUSTOM_TRANSACTION, 0, &status));
+    g_assert(status == (-EBADMSG));
+    g_assert(test.count == 1);
+
+    gbinder_ipc_unref(ipc);
+    gbinder_local_object_unref(obj);
+    gbinder_remote_request_unref(req);
+    g_assert(test.destroyed == 1);
+    test_binder_exit_wait(&test_opt, NULL);
+}
+
+/*==========================================================================*
+ * concurrent_drop
+ *==========================================================================*/
+
+static
+void
+test_concurrent_drop(
+    void)
+{
+    static const guint8 req_data [] = { CUSTOM_INTERFACE_HEADER_BYTES };
+    const char* const ifaces[] = { custom_iface, NULL };
+    int status = INT_MAX;
+    const char* dev = GBINDER_DEFAULT_HWBINDER;
+    const GBinderRpcProtocol* prot = gbinder_rpc_protocol_for_device(dev);
+    GBinderIpc* ipc = gbinder_ipc_new(dev, NULL);
+    GBinderObjectRegistry* reg = gbinder_ipc_object_registry(ipc);
+    GBinderRemoteRequest* req = gbinder_remote_request_new(reg, prot, 0, 0);
+    TestConcurrentData test;
+    GBinderLocalObject* obj;
+    GBinderLocalReply* reply;
+
+    memset(&test, 0, sizeof(test));
+    test.code = CUSTOM_TRANSACTION;
+    test.drop = TRUE;
+    obj = gbinder_local_object_new_concurrent(ipc, ifaces,
+        test_concurrent_handler, &test, test_concurrent_destroy);
+    gbinder_remote_request_set_data(req, HIDL_PING_TRANSACTION,
+        gbinder_buffer_new(ipc->driver, g_memdup(req_data, sizeof(req_data)),
+        sizeof(req_data), NULL));
+
+    /* The reference is released by the handler */
+    gbinder_local_object_ref(obj);
+    reply = gbinder_local_object_handle_looper_transaction(obj, req,
+        CUSTOM_TRANSACTION, 0, &status);
+    g_assert(reply);
+    g_assert(status == GBINDER_STATUS_OK);
+    g_assert(test.count == 1);
+    gbinder_local_reply_unref(reply);
+
+    /* user_data is released when the call completes */
+    g_assert(test.destroyed == 1);
+
+    /* The handler is not invoked anymore */
+    status = INT_MAX;
+    g_assert(!gbinder_local_object_handle_looper_transaction(obj, req,
+        CUSTOM_TRANSACTION, 0, &status));
+    g_assert(status == (-EBADMSG));
+    g_assert(test.count == 1);
+
+    gbinder_ipc_unref(ipc);
+    gbinder_local_object_unref(obj);
+    gbinder_remote_request_unref(req);
+    g_assert(test.destroyed == 1);
+    test_binder_exit_wait(&test_opt, NULL);
+}
+
+/*==========================================================================*
+ * concurrent_hidl
+ *==========================================================================*/
+
+static
+void
+test_concurrent_hidl(
+    void)
+{
+    static const guint8 req_data [] = { CUSTOM_INTERFACE_HEADER_BYTES };
+    static const guint8 base_req_data [] = {
+        TEST_BASE_INTERFACE_HEADER_BYTES
+    };
+    static const guint codes[] = {
+        HIDL_PING_TRANSACTION,
+        HIDL_GET_DESCRIPTOR_TRANSACTION,
+        HIDL_DESCRIPTOR_CHAIN_TRANSACTION
+    };
+    const char* const ifaces[] = { custom_iface, NULL };
+    const char* dev = GBINDER_DEFAULT_HWBINDER;
+    const GBinderRpcProtocol* prot = gbinder_rpc_protocol_for_device(dev);
+    GBinderIpc* ipc = gbinder_ipc_new(dev, NULL);
+    GBinderObjectRegistry* reg = gbinder_ipc_object_registry(ipc);
+    GBinderRemoteRequest* req = gbinder_remote_request_new(reg, prot, 0, 0);
+    GBinderRemoteRequest* base_req = gbinder_remote_request_new(reg, prot,
+        0, 0);
+    TestConcurrentData test;
+    GBinderLocalObject* obj;
+    guint i;
+
+    memset(&test, 0, sizeof(test));
+    obj = gbinder_local_object_new_concurrent(ipc, ifaces,
+        test_concurrent_handler, &test, test_concurrent_destroy);
+    gbinder_remote_request_set_data(req, HIDL_PING_TRANSACTION,
+        gbinder_buffer_new(ipc->driver, g_memdup(req_data, sizeof(req_data)),
+        sizeof(req_data), NULL));
+    gbinder_remote_request_set_data(base_req, HIDL_PING_TRANSACTION,
+        gbinder_buffer_new(ipc->driver, g_memdup(base_req_data,
+        sizeof(base_req_data)), sizeof(base_req_data), NULL));
+
+    for (i = 0; i < G_N_ELEMENTS(codes); i++) {
+        GBinderLocalReply* reply;
+        int status = INT_MAX;
+
+        /* Not IBase, these go to the handler (even if they are oneway) */
+        test.code = codes[i];
+        test.count = 0;
+        g_assert(gbinder_local_object_can_handle_transaction(obj,
+            custom_iface, codes[i]) == GBINDER_LOCAL_TRANSACTION_LOOPER);
+        reply = gbinder_local_object_handle_looper_transaction(obj, req,
+            codes[i], GBINDER_TX_FLAG_ONEWAY, &status);
+        g_assert(reply);
+        g_assert(status == GBINDER_STATUS_OK);
+        g_assert(test.count == 1);
+        gbinder_local_reply_unref(reply);
+
+        /* IBase calls are still handled internally */
+        status = INT_MAX;
+        g_assert(gbinder_local_object_can_handle_transaction(obj,
+            base_interface, codes[i]) == GBINDER_LOCAL_TRANSACTION_LOOPER);
+        reply = gbinder_local_object_handle_looper_transaction(obj, base_req,
+            codes[i], 0, &status);
+        g_assert(reply);
+        g_assert(status == GBINDER_STATUS_OK);
+        g_assert(test.count == 1);
+        gbinder_local_reply_unref(reply);
+    }
+
+    /* user_data is released on finalize if the object was never dropped */
+    gbinder_ipc_unref(ipc);
+    g_assert(!test.destroyed);
+    gbinder_local_object_unref(obj);
+    g_assert(test.destroyed == 1);
+    gbinder_remote_request_unref(req);
+    gbinder_remote_request_unref(base_req);
+    test_binder_exit_wait(&test_opt, NULL);
+}
+
 /*==========================================================================*
  * increfs
  *==========================================================================*/
@@ -838,6 +1074,9 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_PREFIX "descriptor_chain", test_descriptor_chain);
     g_test_add_func(TEST_PREFIX "custom_iface", test_custom_iface);
     g_test_add_func(TEST_PREFIX "reply_status", test_reply_status);
+    g_test_add_func(TEST_PREFIX "concurrent", test_concurrent);
+    g_test_add_func(TEST_PREFIX "concurrent_drop", test_concurrent_drop);
+    g_test_add_func(TEST_PREFIX "concurrent_hidl", test_concurrent_hidl);
     g_test_add_func(TEST_PREFIX "increfs", test_increfs);
     g_test_add_func(TEST_PREFIX "decrefs", test_decrefs);
     g_test_add_func(TEST_PREFIX "acquire", test_acquire);
@@ -0,0 +1,455 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * You may use this file under the terms of BSD license as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. Neither the names of the copyright holders nor the names of its
+ *      contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "test_common.h"
+#include "test_binder.h"
+
+#include "gbinder_buffer_p.h"
+#include "gbinder_driver.h"
+#include "gbinder_ipc.h"
+#include "gbinder_local_object_p.h"
+#include "gbinder_local_request_p.h"
+#include "gbinder_output_data.h"
+#include "gbinder_pool.h"
+#include "gbinder_remote_request_p.h"
+#include "gbinder_rpc_protocol.h"
+#include "gbinder_writer.h"
+
+static TestOpt test_opt;
+static const char TMP_DIR_TEMPLATE[] = "gbinder-test-pool-XXXXXX";
+
+#define TEST_BLOCK_SIZE (32)
+
+typedef struct test_pool_stats {
+    GBinderPoolStats start;
+    GBinderPoolStats now;
+} TestPoolStats;
+
+static
+void
+test_pool_stats_start(
+    TestPoolStats* stats)
+{
+    gbinder_pool_stats(&stats->start);
+}
+
+static
+guint
+test_pool_hits(
+    TestPoolStats* stats)
+{
+    gbinder_pool_stats(&stats->now);
+    return stats->now.hits - stats->start.hits;
+}
+
+static
+guint
+test_pool_misses(
+    TestPoolStats* stats)
+{
+    gbinder_pool_stats(&stats->now);
+    return stats->now.misses - stats->start.misses;
+}
+
+/*==========================================================================*
+ * basic
+ *==========================================================================*/
+
+static
+void
+test_basic(
+    void)
+{
+    TestPoolStats stats;
+    guint8* p1;
+    guint8* p2;
+    guint i;
+
+    gbinder_pool_set_max_size(2);
+    g_assert_cmpuint(gbinder_pool_max_size(), == ,2);
+    gbinder_pool_trim();
+    test_pool_stats_start(&stats);
+
+    /* NULL is ignored */
+    gbinder_pool_free(GBINDER_POOL_BUFFER, NULL);
+
+    /* Nothing cached yet */
+    p1 = gbinder_pool_alloc0(GBINDER_POOL_BUFFER, TEST_BLOCK_SIZE);
+    g_assert(p1);
+    g_assert_cmpuint(test_pool_hits(&stats), == ,0);
+    g_assert_cmpuint(test_pool_misses(&stats), == ,1);
+    memset(p1, 0xaa, TEST_BLOCK_SIZE);
+    gbinder_pool_free(GBINDER_POOL_BUFFER, p1);
+
+    /* The same block comes back zeroed */
+    p2 = gbinder_pool_alloc0(GBINDER_POOL_BUFFER, TEST_BLOCK_SIZE);
+    g_assert(p2 == p1);
+    for (i = 0; i < TEST_BLOCK_SIZE; i++) {
+        g_assert(!p2[i]);
+    }
+    g_assert_cmpuint(test_pool_hits(&stats), == ,1);
+    g_assert_cmpuint(test_pool_misses(&stats), == ,1);
+
+    /* Different types don't share blocks */
+    gbinder_pool_free(GBINDER_POOL_BUFFER, p2);
+    p1 = gbinder_pool_alloc0(GBINDER_POOL_REMOTE_REPLY, TEST_BLOCK_SIZE);
+    g_assert(p1 != p2);
+    g_assert_cmpuint(test_pool_misses(&stats), == ,2);
+    gbinder_pool_free(GBINDER_POOL_REMOTE_REPLY, p1);
+
+    gbinder_pool_trim();
+    gbinder_pool_trim(); /* Second time does nothing */
+    gbinder_pool_free(GBINDER_POOL_BUFFER, gbinder_pool_alloc0
+        (GBINDER_POOL_BUFFER, TEST_BLOCK_SIZE));
+    g_assert_cmpuint(test_pool_hits(&stats), == ,1);
+    g_assert_cmpuint(test_pool_misses(&stats), == ,3);
+    gbinder_pool_trim();
+}
+
+/*==========================================================================*
+ * limit
+ *==========================================================================*/
+
+static
+void
+test_limit(
+    void)
+{
+    TestPoolStats stats;
+    void* p[3];
+    guint i;
+
+    gbinder_pool_set_max_size(2);
+    gbinder_pool_trim();
+    test_pool_stats_start(&stats);
+
+    for (i = 0; i < G_N_ELEMENTS(p); i++) {
+        p[i] = gbinder_pool_alloc0(GBINDER_POOL_REMOTE_REQUEST,
+            TEST_BLOCK_SIZE);
+    }
+    g_assert_cmpuint(test_pool_misses(&stats), == ,3);
+
+    /* Only two out of three get cached */
+    for (i = 0; i < G_N_ELEMENTS(p); i++) {
+        gbinder_pool_free(GBINDER_POOL_REMOTE_REQUEST, p[i]);
+    }
+    for (i = 0; i < G_N_ELEMENTS(p); i++) {
+        p[i] = gbinder_pool_alloc0(GBINDER_POOL_REMOTE_REQUEST,
+            TEST_BLOCK_SIZE);
+    }
+    g_assert_cmpuint(test_pool_hits(&stats), == ,2);
+    g_assert_cmpuint(test_pool_misses(&stats), == ,4);
+
+    /* Zero disables caching */
+    gbinder_pool_set_max_size(0);
+    g_assert_cmpuint(gbinder_pool_max_size(), == ,0);
+    for (i = 0; i < G_N_ELEMENTS(p); i++) {
+        gbinder_pool_free(GBINDER_POOL_REMOTE_REQUEST, p[i]);
+    }
+    gbinder_pool_free(GBINDER_POOL_REMOTE_REQUEST, gbinder_pool_alloc0
+        (GBINDER_POOL_REMOTE_REQUEST, TEST_BLOCK_SIZE));
+    g_assert_cmpuint(test_pool_hits(&stats), == ,2);
+    g_assert_cmpuint(test_pool_misses(&stats), == ,5);
+
+    /* The limit is capped */
+    gbinder_pool_set_max_size(G_MAXINT);
+    g_assert_cmpuint(gbinder_pool_max_size(), < ,G_MAXINT);
+    gbinder_pool_trim();
+}
+
+/*==========================================================================*
+ * thread
+ *==========================================================================*/
+
+static
+gpointer
+test_thread_proc(
+    gpointer data)
+{
+    guint i;
+
+    /* The cache gets freed when the thread exits */
+    for (i = 0; i < 3; i++) {
+        gbinder_pool_free(GBINDER_POOL_BUFFER_CONTENTS, gbinder_pool_alloc0
+            (GBINDER_POOL_BUFFER_CONTENTS, TEST_BLOCK_SIZE));
+    }
+    /* Block allocated by the main thread */
+    gbinder_pool_free(GBINDER_POOL_BUFFER_CONTENTS, data);
+    return NULL;
+}
+
+static
+void
+test_thread(
+    void)
+{
+    TestPoolStats stats;
+    GThread* thread;
+
+    gbinder_pool_set_max_size(4);
+    gbinder_pool_trim();
+    test_pool_stats_start(&stats);
+    thread = g_thread_new("test", test_thread_proc, gbinder_pool_alloc0
+        (GBINDER_POOL_BUFFER_CONTENTS, TEST_BLOCK_SIZE));
+    g_thread_join(thread);
+    g_assert_cmpuint(test_pool_hits(&stats), == ,2);
+    g_assert_cmpuint(test_pool_misses(&stats), == ,2);
+
+    /* The block freed by the other thread has come back to this one */
+    gbinder_pool_free(GBINDER_POOL_BUFFER_CONTENTS, gbinder_pool_alloc0
+        (GBINDER_POOL_BUFFER_CONTENTS, TEST_BLOCK_SIZE));
+    g_assert_cmpuint(test_pool_hits(&stats), == ,3);
+    g_assert_cmpuint(test_pool_misses(&stats), == ,2);
+    gbinder_pool_trim();
+}
+
+/*==========================================================================*
+ * exited
+ *==========================================================================*/
+
+static
+gpointer
+test_exited_proc(
+    gpointer data)
+{
+    return gbinder_pool_alloc0(GBINDER_POOL_REMOTE_REPLY, TEST_BLOCK_SIZE);
+}
+
+static
+void
+test_exited(
+    void)
+{
+    TestPoolStats stats;
+    GThread* thread;
+
+    gbinder_pool_set_max_size(4);
+    gbinder_pool_trim();
+    test_pool_stats_start(&stats);
+
+    /* The block outlives the thread (and its cache) */
+    thread = g_thread_new("test", test_exited_proc, NULL);
+    gbinder_pool_free(GBINDER_POOL_REMOTE_REPLY, g_thread_join(thread));
+    g_assert_cmpuint(test_pool_misses(&stats), == ,1);
+
+    /* And doesn't end up in this thread's cache */
+    gbinder_pool_free(GBINDER_POOL_REMOTE_REPLY, gbinder_pool_alloc0
+        (GBINDER_POOL_REMOTE_REPLY, TEST_BLOCK_SIZE));
+    g_assert_cmpuint(test_pool_hits(&stats), == ,0);
+    g_assert_cmpuint(test_pool_misses(&stats), == ,2);
+    gbinder_pool_trim();
+}
+
+/*==========================================================================*
+ * incoming
+ *==========================================================================*/
+
+typedef struct test_incoming {
+    GMainLoop* loop;
+    GBinderRemoteRequest* req;
+} TestIncoming;
+
+static
+GBinderLocalReply*
+test_incoming_proc(
+    GBinderLocalObject* obj,
+    GBinderRemoteRequest* req,
+    guint code,
+    guint flags,
+    int* status,
+    void* user_data)
+{
+    TestIncoming* test = user_data;
+
+    /* Keep the request, it gets freed on the main thread */
+    g_assert(!test->req);
+    test->req = gbinder_remote_request_ref(req);
+    test_quit_later(test->loop);
+    *status = GBINDER_STATUS_OK;
+    return gbinder_local_object_new_reply(obj);
+}
+
+static
+void
+test_incoming_transact(
+    GBinderLocalObject* obj,
+    GBinderLocalRequest* req,
+    TestIncoming* test)
+{
+    const int fd = gbinder_driver_fd(obj->ipc->driver);
+
+    test_binder_br_transaction(fd, LOOPER_THREAD, obj, 1,
+        gbinder_local_request_data(req)->bytes);
+    test_binder_br_transaction_complete(fd, LOOPER_THREAD); /* For reply */
+    test_run(&test_opt, test->loop);
+    g_assert(test->req);
+    gbinder_remote_request_unref(test->req);
+    test->req = NULL;
+}
+
+static
+void
+test_incoming_run(
+    void)
+{
+    GBinderIpc* ipc = gbinder_ipc_new(GBINDER_DEFAULT_BINDER, NULL);
+    const char* dev = gbinder_driver_dev(ipc->driver);
+    const GBinderRpcProtocol* prot = gbinder_rpc_protocol_for_device(dev);
+    const char* const ifaces[] = { "test", NULL };
+    GBinderLocalRequest* req = gbinder_local_request_new
+        (gbinder_driver_io(ipc->driver), prot, NULL);
+    GBinderLocalObject* obj;
+    GBinderWriter writer;
+    TestPoolStats stats;
+    TestIncoming test;
+
+    memset(&test, 0, sizeof(test));
+    test.loop = g_main_loop_new(NULL, FALSE);
+    gbinder_pool_set_max_size(4);
+
+    /* Single looper thread allocates all remote requests */
+    g_assert(gbinder_ipc_set_looper_limits(ipc, 1, 1));
+    obj = gbinder_local_object_new(ipc, ifaces, test_incoming_proc, &test);
+    gbinder_local_request_init_writer(req, &writer);
+    prot->write_rpc_header(&writer, "test");
+    gbinder_writer_append_int32(&writer, 0);
+
+    /* The first transaction fills the looper's cache */
+    test_incoming_transact(obj, req, &test);
+
+    /*
+     * The blocks freed by the main thread have been returned to the
+     * looper, the second transaction doesn't need malloc.
+     */
+    test_pool_stats_start(&stats);
+    test_incoming_transact(obj, req, &test);
+    g_assert_cmpuint(test_pool_hits(&stats), >= ,3);
+    g_assert_cmpuint(test_pool_misses(&stats), == ,0);
+
+    gbinder_local_object_unref(obj);
+    gbinder_local_request_unref(req);
+    gbinder_ipc_unref(ipc);
+    test_binder_exit_wait(&test_opt, test.loop);
+    g_main_loop_unref(test.loop);
+    gbinder_pool_trim();
+}
+
+static
+void
+test_incoming(
+    void)
+{
+    test_run_in_context(&test_opt, test_incoming_run);
+}
+
+/*==========================================================================*
+ * objects
+ *==========================================================================*/
+
+static
+void
+test_objects(
+    void)
+{
+    TestPoolStats stats;
+    void** objects;
+    void** objects2;
+    guint i;
+
+    gbinder_pool_set_max_size(4);
+    gbinder_pool_trim();
+    test_pool_stats_start(&stats);
+
+    /* NULL is ignored */
+    gbinder_buffer_objects_free(NULL);
+
+    /* Small arrays are recycled */
+    objects = gbinder_buffer_objects_new(2);
+    objects[0] = objects[1] = &stats;
+    objects[2] = NULL;
+    gbinder_buffer_objects_free(objects);
+    objects2 = gbinder_buffer_objects_new(1);
+    g_assert(objects2 == objects);
+    objects2[0] = &stats;
+    objects2[1] = NULL;
+    gbinder_buffer_objects_free(objects2);
+    g_assert_cmpuint(test_pool_hits(&stats), == ,1);
+    g_assert_cmpuint(test_pool_misses(&stats), == ,1);
+
+    /* Large ones are not */
+    objects = gbinder_buffer_objects_new(100);
+    for (i = 0; i < 100; i++) {
+        objects[i] = &stats;
+    }
+    objects[i] = NULL;
+    gbinder_buffer_objects_free(objects);
+    g_assert_cmpuint(test_pool_hits(&stats), == ,1);
+    g_assert_cmpuint(test_pool_misses(&stats), == ,1);
+    gbinder_pool_trim();
+}
+
+/*==========================================================================*
+ * Common
+ *==========================================================================*/
+
+#define TEST_PREFIX "/pool/"
+#define TEST_(t) TEST_PREFIX t
+
+int main(int argc, char* argv[])
+{
+    TestConfig test_config;
+    int result;
+
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+    g_type_init();
+    G_GNUC_END_IGNORE_DEPRECATIONS;
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func(TEST_("basic"), test_basic);
+    g_test_add_func(TEST_("limit"), test_limit);
+    g_test_add_func(TEST_("thread"), test_thread);
+    g_test_add_func(TEST_("exited"), test_exited);
+    g_test_add_func(TEST_("objects"), test_objects);
+    g_test_add_func(TEST_("incoming"), test_incoming);
+    test_init(&test_opt, argc, argv);
+    test_config_init(&test_config, TMP_DIR_TEMPLATE);
+    result = g_test_run();
+    test_config_cleanup(&test_config);
+    return result;
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -709,6 +709,14 @@ static const guint8 test_string16_in_basic2 [] = {
     TEST_INT16_BYTES('o'), 0x00, 0x00, 0x00
 };
 
+static const guint8 test_string16_in_basic3 [] = {
+    TEST_INT32_BYTES(9),
+    TEST_INT16_BYTES('f'), TEST_INT16_BYTES('o'), TEST_INT16_BYTES('o'),
+    TEST_INT16_BYTES('b'), TEST_INT16_BYTES('a'), TEST_INT16_BYTES('r'),
+    TEST_INT16_BYTES('b'), TEST_INT16_BYTES('a'), TEST_INT16_BYTES('z'),
+    0x00, 0x00
+};
+
 static const TestStringData test_string16_tests [] = {
     { "invalid", TEST_ARRAY_AND_SIZE(test_string16_in_invalid), NULL,
         sizeof(test_string16_in_invalid) },
@@ -717,7 +725,8 @@ static const TestStringData test_string16_tests [] = {
     { "noterm", TEST_ARRAY_AND_SIZE(test_string16_in_noterm), NULL,
         sizeof(test_string16_in_noterm) },
     { "ok1", TEST_ARRAY_AND_SIZE(test_string16_in_basic1), "foo", 0 },
-    { "ok2", TEST_ARRAY_AND_SIZE(test_string16_in_basic2), "foo", 1 }
+    { "ok2", TEST_ARRAY_AND_SIZE(test_string16_in_basic2), "foo", 1 },
+    { "ok3", TEST_ARRAY_AND_SIZE(test_string16_in_basic3), "foobarbaz", 0 }
 };
 
 static
@@ -805,6 +814,7 @@ test_string16(
         out2 = gbinder_reader_read_string16_utf16(&reader, &len);
         g_assert(out2);
         g_assert((gsize)len == strlen(test->out));
+        g_assert(gbinder_reader_string16_equal(out2, len, test->out));
         g_assert(gbinder_reader_at_end(&reader) == (!test->remaining));
     } else {
         g_assert(!gbinder_reader_read_string16_utf16(&reader, NULL));
@@ -856,6 +866,56 @@ test_string16(
     gbinder_driver_unref(driver);
 }
 
+static
+void
+test_string16_utf8(
+    void)
+{
+    static const gunichar2 foo[] = { 'f', 'o', 'o' };
+    static const gunichar2 mixed[] = { 'x', 0xe9, 0xd83d, 0xde00, 'y' };
+    static const char mixed_utf8[] = "x\xC3\xA9\xF0\x9F\x98\x80y";
+    static const guint8 in[] = {
+        TEST_INT32_BYTES(5),
+        TEST_INT16_BYTES('x'), TEST_INT16_BYTES(0xe9),
+        TEST_INT16_BYTES(0xd83d), TEST_INT16_BYTES(0xde00),
+        TEST_INT16_BYTES('y'), 0x00, 0x00
+    };
+    GBinderDriver* driver = gbinder_driver_new(GBINDER_DEFAULT_BINDER, NULL);
+    GBinderReader reader;
+    GBinderReaderData data;
+    char* str;
+
+    g_assert(gbinder_reader_string16_equal(NULL, 0, NULL));
+    g_assert(!gbinder_reader_string16_equal(NULL, 0, "foo"));
+    g_assert(!gbinder_reader_string16_equal(foo, 3, NULL));
+    g_assert(gbinder_reader_string16_equal(foo, 0, ""));
+    g_assert(gbinder_reader_string16_equal(foo, 3, "foo"));
+    g_assert(!gbinder_reader_string16_equal(foo, 2, "foo"));
+    g_assert(!gbinder_reader_string16_equal(foo, 3, "fo"));
+    g_assert(!gbinder_reader_string16_equal(foo, 3, "fop"));
+    g_assert(!gbinder_reader_string16_equal(foo, 3, "\xFF"));
+    g_assert(gbinder_reader_string16_equal(mixed, 5, mixed_utf8));
+    g_assert(!gbinder_reader_string16_equal(mixed, 3, mixed_utf8));
+    g_assert(!gbinder_reader_string16_equal(mixed, 4, mixed_utf8));
+    g_assert(!gbinder_reader_string16_equal(mixed, 5,
+        "x\xC3\xA9\xF0\x9F\x98\x81y"));
+    g_assert(!gbinder_reader_string16_equal(mixed, 5, "x\xC3\xA8"));
+
+    /* Non-ASCII string goes through the slow path */
+    g_assert(driver);
+    memset(&data, 0, sizeof(data));
+    data.buffer = gbinder_buffer_new(driver, g_memdup(TEST_ARRAY_AND_SIZE(in)),
+        sizeof(in), NULL);
+    gbinder_reader_init(&reader, &data, 0, sizeof(in));
+    str = gbinder_reader_read_string16(&reader);
+    g_assert_cmpstr(str, == ,mixed_utf8);
+    g_assert(gbinder_reader_at_end(&reader));
+    g_free(str);
+
+    gbinder_buffer_free(data.buffer);
+    gbinder_driver_unref(driver);
+}
+
 /*==========================================================================*
  * hidl_struct
  *==========================================================================*/
@@ -2584,6 +2644,7 @@ int main(int argc, char* argv[])
     }
 
     g_test_add_func(TEST_("string16/null"), test_string16_null);
+    g_test_add_func(TEST_("string16/utf8"), test_string16_utf8);
     for (i = 0; i < G_N_ELEMENTS(test_string16_tests); i++) {
         const TestStringData* test = test_string16_tests + i;
         char* path = g_strconcat(TEST_("string16/"), test->name, NULL);
@@ -250,6 +250,84 @@ test_string16(
     gbinder_driver_unref(driver);
 }
 
+/*==========================================================================*
+ * iface
+ *==========================================================================*/
+
+static
+void
+test_iface_set_data(
+    GBinderRemoteRequest* req,
+    GBinderDriver* driver,
+    const char* iface)
+{
+    GBinderLocalRequest* local = gbinder_local_request_new_iface
+        (gbinder_driver_io(driver), gbinder_driver_protocol(driver), iface);
+    const GByteArray* bytes = gbinder_local_request_data(local)->bytes;
+
+    gbinder_remote_request_set_data(req, GBINDER_FIRST_CALL_TRANSACTION,
+        gbinder_buffer_new(driver, g_memdup(bytes->data, bytes->len),
+        bytes->len, NULL));
+    gbinder_local_request_unref(local);
+}
+
+static
+void
+test_iface(
+    void)
+{
+    static const char* ifaces[] = {
+        "android.hardware.radio.network.IRadioNetworkIndication/default",
+        "android.hardware.radio.network.IRadioNetworkIndication/default12",
+        "f\xC3\xB6\xC3\xB6",
+        TEST_RPC_IFACE
+    };
+    const char* dev = GBINDER_DEFAULT_BINDER;
+    GBinderDriver* driver = gbinder_driver_new(dev, NULL);
+    GBinderRemoteRequest* req = gbinder_remote_request_new(NULL,
+        gbinder_rpc_protocol_for_device(dev), 0, 0);
+    guint i;
+
+    /* Start with the empty table */
+    gbinder_rpc_protocol_exit();
+
+    /* Names not implemented by any local object are decoded every time */
+    for (i = 0; i < G_N_ELEMENTS(ifaces); i++) {
+        test_iface_set_data(req, driver, ifaces[i]);
+        g_assert_cmpstr(gbinder_remote_request_interface(req), == ,ifaces[i]);
+        g_assert(gbinder_remote_request_interface(req) !=
+            g_intern_string(ifaces[i]));
+    }
+
+    /* Registered names resolve to the same interned string */
+    for (i = 0; i < G_N_ELEMENTS(ifaces); i++) {
+        const char* iface;
+
+        gbinder_rpc_protocol_register_iface(ifaces[i]);
+        gbinder_rpc_protocol_register_iface(ifaces[i]); /* No effect */
+        test_iface_set_data(req, driver, ifaces[i]);
+        iface = gbinder_remote_request_interface(req);
+        g_assert_cmpstr(iface, == ,ifaces[i]);
+        g_assert(iface == g_intern_string(ifaces[i]));
+        test_iface_set_data(req, driver, ifaces[i]);
+        g_assert(gbinder_remote_request_interface(req) == iface);
+    }
+
+    /* The others are still decoded */
+    for (i = 0; i < 200; i++) {
+        char* iface = g_strdup_printf("test.IFoo%u/%s", i,
+            ifaces[i % G_N_ELEMENTS(ifaces)]);
+
+        test_iface_set_data(req, driver, iface);
+        g_assert_cmpstr(gbinder_remote_request_interface(req), == ,iface);
+        g_free(iface);
+    }
+
+    gbinder_remote_request_unref(req);
+    gbinder_driver_unref(driver);
+    gbinder_rpc_protocol_exit();
+}
+
 /*==========================================================================*
  * to_local
  *==========================================================================*/
@@ -378,6 +456,7 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_PREFIX "int64", test_int64);
     g_test_add_func(TEST_PREFIX "string8", test_string8);
     g_test_add_func(TEST_PREFIX "string16", test_string16);
+    g_test_add_func(TEST_PREFIX "iface", test_iface);
     g_test_add_func(TEST_PREFIX "to_local", test_to_local);
     test_init(&test_opt, argc, argv);
     test_config_init(&test_config, TMP_DIR_TEMPLATE);
@@ -147,8 +147,12 @@ typedef struct test_servicemanager {
     GBinderRemoteObject* remote;
     char** services;
     gboolean reject_name;
+    int get_count;
 } TestServiceManager;
 
+/* get_service() may be invoked by several worker threads at once */
+G_LOCK_DEFINE_STATIC(test_servicemanager);
+
 #define TEST_SERVICEMANAGER(obj) \
     G_CAST(obj, TestServiceManager, manager.parent)
 #define TEST_SERVICEMANAGER2(obj, type) \
@@ -174,7 +178,10 @@ test_servicemanager_get_service(
     const GBinderIpcSyncApi* api)
 {
     TestServiceManager* self = TEST_SERVICEMANAGER(sm);
+    GBinderRemoteObject* obj = NULL;
 
+    G_LOCK(test_servicemanager);
+    self->get_count++;
     if (gutil_strv_contains(self->services, name)) {
         if (!self->remote) {
             self->remote = gbinder_object_registry_get_remote
@@ -182,11 +189,12 @@ test_servicemanager_get_service(
                      1, TRUE);
         }
         *status = GBINDER_STATUS_OK;
-        return gbinder_remote_object_ref(self->remote);
+        obj = gbinder_remote_object_ref(self->remote);
     } else {
         *status = (-ENOENT);
-        return NULL;
     }
+    G_UNLOCK(test_servicemanager);
+    return obj;
 }
 
 static
@@ -418,10 +426,13 @@ test_null(
     g_assert(!gbinder_servicemanager_new(NULL));
     g_assert(!gbinder_servicemanager_new_with_type(0, NULL, NULL));
     g_assert(!gbinder_servicemanager_new_local_object(NULL, NULL, NULL, NULL));
+    g_assert(!gbinder_servicemanager_new_local_object_concurrent(NULL, NULL,
+        NULL, NULL, NULL));
     g_assert(!gbinder_servicemanager_ref(NULL));
     g_assert(!gbinder_servicemanager_device(NULL));
     g_assert(!gbinder_servicemanager_is_present(NULL));
     g_assert(!gbinder_servicemanager_wait(NULL, 0));
+    g_assert(!gbinder_servicemanager_set_looper_limits(NULL, 1, 1));
     g_assert(!gbinder_servicemanager_list(NULL, NULL, NULL));
     g_assert(!gbinder_servicemanager_list_sync(NULL));
     g_assert(!gbinder_servicemanager_get_service(NULL, NULL, NULL, NULL));
@@ -645,6 +656,136 @@ test_config(
     test_config_cleanup(&test);
 }
 
+/*==========================================================================*
+ * backoff
+ *==========================================================================*/
+
+typedef struct test_backoff_data {
+    const char* name;
+    const char* config;
+    guint min_ms;
+    guint max_ms;
+    guint jitter;
+    const guint* steps;
+    guint nsteps;
+} TestBackoffData;
+
+static const guint test_backoff_steps_default[] = {
+    100, 200, 400, 800, 1000, 1000
+};
+static const guint test_backoff_steps_custom[] = {
+    50, 100, 200, 400, 500, 500
+};
+static const guint test_backoff_steps_odd[] = {
+    2, 4, 7, 7
+};
+static const guint test_backoff_steps_flat[] = {
+    300, 300
+};
+
+static const TestBackoffData test_backoff_data[] = {
+    {
+        "default", NULL, 100, 1000, 20,
+        TEST_ARRAY_AND_COUNT(test_backoff_steps_default)
+    },{
+        "custom",
+        "[General]\n"
+        "PresenceCheckMin = 50\n"
+        "PresenceCheckMax = 500\n"
+        "PresenceCheckJitter = 0\n",
+        50, 500, 0,
+        TEST_ARRAY_AND_COUNT(test_backoff_steps_custom)
+    },{
+        "odd",
+        "[General]\n"
+        "PresenceCheckMin = 2\n"
+        "PresenceCheckMax = 7\n"
+        "PresenceCheckJitter = 50\n",
+        2, 7, 50,
+        TEST_ARRAY_AND_COUNT(test_backoff_steps_odd)
+    },{
+        "clamp",
+        "[General]\n"
+        "PresenceCheckMin = 0\n"
+        "PresenceCheckMax = 100000\n"
+        "PresenceCheckJitter = 200\n",
+        1, 60000, 100, NULL, 0
+    },{
+        "max_below_min",
+        "[General]\n"
+        "PresenceCheckMin = 300\n"
+        "PresenceCheckMax = 200\n"
+        "PresenceCheckJitter = -5\n",
+        300, 300, 0,
+        TEST_ARRAY_AND_COUNT(test_backoff_steps_flat)
+    },{
+        "min_above_default_max",
+        "[General]\n"
+        "PresenceCheckMin = 2000\n",
+        2000, 2000, 20, NULL, 0
+    },{
+        "invalid",
+        "[General]\n"
+        "PresenceCheckMin = foo\n"
+        "PresenceCheckMax = \n"
+        "PresenceCheckJitter = bar\n",
+        100, 1000, 20,
+        TEST_ARRAY_AND_COUNT(test_backoff_steps_default)
+    }
+};
+
+static
+void
+test_backoff(
+    gconstpointer test_data)
+{
+    const TestBackoffData* data = test_data;
+    const guint interval = 1000;
+    const guint spread = interval * data->jitter / 100;
+    TestConfig test;
+    char* file = NULL;
+    guint i;
+
+    test_config_init(&test, TMP_DIR_TEMPLATE);
+    if (data->config) {
+        file = g_build_filename(test.config_dir, "test.conf", NULL);
+        g_assert(g_file_set_contents(file, data->config, -1, NULL));
+        GDEBUG("Config file %s", file);
+        gbinder_config_file = file;
+    }
+
+    /* Make sure that the configuration gets reloaded */
+    gbinder_servicemanager_exit();
+    g_assert_cmpuint(gbinder_servicemanager_backoff_min(), ==, data->min_ms);
+    g_assert_cmpuint(gbinder_servicemanager_backoff_next(data->max_ms), ==,
+        data->max_ms);
+    g_assert_cmpuint(gbinder_servicemanager_backoff_next(G_MAXUINT), ==,
+        data->max_ms);
+
+    /* The interval doubles until it hits the maximum */
+    for (i = 1; i < data->nsteps; i++) {
+        g_assert_cmpuint(gbinder_servicemanager_backoff_next
+            (data->steps[i - 1]), ==, data->steps[i]);
+    }
+
+    /* And the delay is randomly shifted by no more than the jitter */
+    for (i = 0; i < 1000; i++) {
+        const guint delay = gbinder_servicemanager_backoff_delay(interval);
+
+        g_assert_cmpuint(delay, >=, MAX(interval - spread, 1));
+        g_assert_cmpuint(delay, <=, interval + spread);
+    }
+    g_assert_cmpuint(gbinder_servicemanager_backoff_delay(1), >=, 1);
+
+    /* Clear the state */
+    gbinder_servicemanager_exit();
+    if (file) {
+        remove(file);
+        g_free(file);
+    }
+    test_config_cleanup(&test);
+}
+
 /*==========================================================================*
  * not_present
  *==========================================================================*/
@@ -834,6 +975,121 @@ test_wait_async(
     g_main_loop_unref(loop);
 }
 
+/*==========================================================================*
+ * wait_async_api
+ *==========================================================================*/
+
+typedef struct test_wait_async_api {
+    GMainLoop* loop;
+    gboolean present;
+    int count;
+} TestWaitAsyncApi;
+
+static
+void
+test_wait_async_api_never(
+    GBinderServiceManager* sm,
+    gboolean present,
+    void* user_data)
+{
+    g_assert_not_reached();
+}
+
+static
+void
+test_wait_async_api_done(
+    GBinderServiceManager* sm,
+    gboolean present,
+    void* user_data)
+{
+    TestWaitAsyncApi* test = user_data;
+
+    GDEBUG("Servicemanager is %spresent", present ? "" : "not ");
+    test->present = present;
+    test->count++;
+    test_quit_later(test->loop);
+}
+
+static
+void
+test_wait_async_api(
+    void)
+{
+    const char* dev = GBINDER_DEFAULT_HWBINDER;
+    GBinderIpc* ipc;
+    GBinderServiceManager* sm;
+    TestWaitAsyncApi test;
+    TestConfig config;
+    gulong id;
+    int fd;
+
+    memset(&test, 0, sizeof(test));
+    test.loop = g_main_loop_new(NULL, FALSE);
+    test_config_init(&config, TMP_DIR_TEMPLATE);
+    ipc = gbinder_ipc_new(dev, NULL);
+    fd = gbinder_driver_fd(ipc->driver);
+
+    /* This makes presence detection PING fail */
+    test_binder_br_reply_status(fd, THIS_THREAD, -1);
+
+    sm = gbinder_servicemanager_new(dev);
+    g_assert(sm);
+    g_assert(!gbinder_servicemanager_is_present(sm));
+
+    /* Invalid parameters */
+    g_assert(!gbinder_servicemanager_wait_async(NULL, -1,
+        test_wait_async_api_done, &test));
+    g_assert(!gbinder_servicemanager_wait_async(sm, -1, NULL, NULL));
+
+    /* Cancelled wait never completes */
+    id = gbinder_servicemanager_wait_async(sm, 0,
+        test_wait_async_api_never, NULL);
+    g_assert(id);
+    gbinder_servicemanager_remove_handler(sm, id);
+
+    /* Zero timeout just reports the current state (asynchronously) */
+    g_assert(gbinder_servicemanager_wait_async(sm, 0,
+        test_wait_async_api_done, &test));
+    g_assert_cmpint(test.count, == ,0);
+    test_run(&test_opt, test.loop);
+    g_assert_cmpint(test.count, == ,1);
+    g_assert(!test.present);
+
+    /* Short timeout expires before the first presence check */
+    g_assert(gbinder_servicemanager_wait_async(sm, 10,
+        test_wait_async_api_done, &test));
+    test_run(&test_opt, test.loop);
+    g_assert_cmpint(test.count, == ,2);
+    g_assert(!test.present);
+
+    /* Make the next presence detection PING fail and the one after succeed */
+    test_binder_br_reply_status(fd, THIS_THREAD, -1);
+    test_binder_br_transaction_complete(fd, TX_THREAD);
+    test_binder_br_reply(fd, TX_THREAD, 0, 0, NULL);
+    g_assert(gbinder_servicemanager_wait_async(sm, -1,
+        test_wait_async_api_done, &test));
+    test_run(&test_opt, test.loop);
+    g_assert_cmpint(test.count, == ,3);
+    g_assert(test.present);
+    g_assert(gbinder_servicemanager_is_present(sm));
+
+    /* Now it completes right away (well, on idle) */
+    g_assert(gbinder_servicemanager_wait_async(sm, -1,
+        test_wait_async_api_done, &test));
+    test_run(&test_opt, test.loop);
+    g_assert_cmpint(test.count, == ,4);
+    g_assert(test.present);
+
+    /* Pending wait gets dropped together with the servicemanager */
+    g_assert(gbinder_servicemanager_wait_async(sm, -1,
+        test_wait_async_api_never, NULL));
+    gbinder_servicemanager_unref(sm);
+    gbinder_ipc_unref(ipc);
+    test_binder_exit_wait(&test_opt, test.loop);
+    test_config_cleanup(&config);
+    g_main_loop_unref(test.loop);
+}
+
 /*==========================================================================*
  * death
  *==========================================================================*/
@@ -1264,6 +1520,253 @@ test_add(
     g_main_loop_unref(loop);
 }
 
+/*==========================================================================*
+ * cache
+ *==========================================================================*/
+
+static
+void
+test_cache_dead(
+    GBinderRemoteObject* obj,
+    void* user_data)
+{
+    test_quit_later((GMainLoop*)user_data);
+}
+
+static
+void
+test_cache_run()
+{
+    const char* dev = GBINDER_DEFAULT_BINDER;
+    GMainLoop* loop = g_main_loop_new(NULL, FALSE);
+    GBinderServiceManagerCacheStats stats;
+    GBinderRemoteObject* obj;
+    GBinderServiceManager* sm;
+    TestServiceManager* test;
+    GBinderIpc* ipc;
+    TestConfig config;
+    int status = -1;
+    gulong id;
+    int fd;
+
+    test_config_init(&config, TMP_DIR_TEMPLATE);
+    ipc = gbinder_ipc_new(dev, NULL);
+    fd = gbinder_driver_fd(ipc->driver);
+    test_setup_ping(ipc);
+    sm = gbinder_servicemanager_new(dev);
+    test = TEST_SERVICEMANAGER(sm);
+    test->services = gutil_strv_add(test->services, "foo");
+
+    /* Invalid parameters */
+    gbinder_servicemanager_set_cache_enabled(NULL, TRUE);
+    gbinder_servicemanager_get_cache_stats(sm, NULL);
+    gbinder_servicemanager_get_cache_stats(NULL, &stats);
+    g_assert_cmpuint(stats.hits, == ,0);
+    g_assert_cmpuint(stats.misses, == ,0);
+
+    /* The cache is disabled by default */
+    g_assert(gbinder_servicemanager_get_service_sync(sm, "foo", &status));
+    g_assert(gbinder_servicemanager_get_service_sync(sm, "foo", &status));
+    g_assert_cmpint(test->get_count, == ,2);
+    gbinder_servicemanager_get_cache_stats(sm, &stats);
+    g_assert_cmpuint(stats.hits, == ,0);
+    g_assert_cmpuint(stats.misses, == ,0);
+
+    /* Second lookup hits the cache */
+    gbinder_servicemanager_set_cache_enabled(sm, TRUE);
+    gbinder_servicemanager_set_cache_enabled(sm, TRUE); /* No effect */
+    obj = gbinder_servicemanager_get_service_sync(sm, "foo", &status);
+    g_assert(obj);
+    g_assert_cmpint(status, == ,GBINDER_STATUS_OK);
+    status = -1;
+    g_assert(gbinder_servicemanager_get_service_sync(sm, "foo", &status) ==
+        obj);
+    g_assert_cmpint(status, == ,GBINDER_STATUS_OK);
+    g_assert_cmpint(test->get_count, == ,3);
+    gbinder_servicemanager_get_cache_stats(sm, &stats);
+    g_assert_cmpuint(stats.hits, == ,1);
+    g_assert_cmpuint(stats.misses, == ,1);
+
+    /* Negative results are not cached */
+    g_assert(!gbinder_servicemanager_get_service_sync(sm, "bar", &status));
+    g_assert_cmpint(status, == ,-ENOENT);
+    g_assert(!gbinder_servicemanager_get_service_sync(sm, "bar", &status));
+    g_assert_cmpint(test->get_count, == ,5);
+
+    /* Asynchronous lookup uses the cache too */
+    id = gbinder_servicemanager_get_service(sm, "foo", test_get_func, loop);
+    g_assert(id);
+    test_run(&test_opt, loop);
+    g_assert_cmpint(test->get_count, == ,5);
+    gbinder_servicemanager_get_cache_stats(sm, &stats);
+    g_assert_cmpuint(stats.hits, == ,2);
+    g_assert_cmpuint(stats.misses, == ,3);
+
+    /* Registration invalidates the entry */
+    gbinder_servicemanager_service_registered(sm, "foo");
+    g_assert(gbinder_servicemanager_get_service_sync(sm, "foo", &status) ==
+        obj);
+    g_assert_cmpint(test->get_count, == ,6);
+    g_assert(gbinder_servicemanager_get_service_sync(sm, "foo", &status) ==
+        obj);
+    g_assert_cmpint(test->get_count, == ,6);
+
+    /* And so does the death of the object */
+    id = gbinder_remote_object_add_death_handler(obj, test_cache_dead, loop);
+    test_binder_br_dead_binder(fd, ANY_THREAD, 1);
+    test_run(&test_opt, loop);
+    gbinder_remote_object_remove_handler(obj, id);
+    g_assert(gbinder_remote_object_is_dead(obj));
+    g_assert(gbinder_servicemanager_get_service_sync(sm, "foo", &status));
+    g_assert_cmpint(test->get_count, == ,7);
+
+    /* Dead objects don't get cached */
+    g_assert(gbinder_servicemanager_get_service_sync(sm, "foo", &status));
+    g_assert_cmpint(test->get_count, == ,8);
+    gbinder_servicemanager_get_cache_stats(sm, &stats);
+    g_assert_cmpuint(stats.hits, == ,3);
+    g_assert_cmpuint(stats.misses, == ,6);
+
+    /* Disabling the cache stops the counters */
+    gbinder_servicemanager_set_cache_enabled(sm, FALSE);
+    gbinder_servicemanager_set_cache_enabled(sm, FALSE); /* No effect */
+    g_assert(gbinder_servicemanager_get_service_sync(sm, "foo", &status));
+    g_assert_cmpint(test->get_count, == ,9);
+    gbinder_servicemanager_get_cache_stats(sm, &stats);
+    g_assert_cmpuint(stats.hits, == ,3);
+    g_assert_cmpuint(stats.misses, == ,6);
+
+    /* Let finalize destroy the cache */
+    gbinder_servicemanager_set_cache_enabled(sm, TRUE);
+
+    gbinder_servicemanager_unref(sm);
+    gbinder_ipc_unref(ipc);
+    test_binder_exit_wait(&test_opt, loop);
+    test_config_cleanup(&config);
+    g_main_loop_unref(loop);
+}
+
+static
+void
+test_cache()
+{
+    test_run_in_context(&test_opt, test_cache_run);
+}
+
+/*==========================================================================*
+ * get_services
+ *==========================================================================*/
+
+static
+void
+test_get_services_func(
+    GBinderServiceManager* sm,
+    const char* const* names,
+    GBinderRemoteObject* const* objects,
+    guint count,
+    void* user_data)
+{
+    g_assert_cmpuint(count, == ,3);
+    g_assert_cmpstr(names[0], == ,"foo");
+    g_assert_cmpstr(names[1], == ,"bar");
+    g_assert_cmpstr(names[2], == ,"foo");
+    g_assert(!names[3]);
+    g_assert(objects[0]);
+    g_assert(!objects[1]);
+    g_assert(objects[2] == objects[0]);
+    test_quit_later((GMainLoop*)user_data);
+}
+
+static
+void
+test_get_services_not_reached(
+    GBinderServiceManager* sm,
+    const char* const* names,
+    GBinderRemoteObject* const* objects,
+    guint count,
+    void* user_data)
+{
+    g_assert_not_reached();
+}
+
+static
+void
+test_get_services_run()
+{
+    const char* dev = GBINDER_DEFAULT_BINDER;
+    const char* names[] = { "foo", "bar", "foo", NULL };
+    const char* none[] = { NULL };
+    GMainLoop* loop = g_main_loop_new(NULL, FALSE);
+    GBinderServiceManagerCacheStats stats;
+    GBinderServiceManager* sm;
+    TestServiceManager* test;
+    GBinderIpc* ipc;
+    TestConfig config;
+    gulong id;
+
+    test_config_init(&config, TMP_DIR_TEMPLATE);
+    ipc = gbinder_ipc_new(dev, NULL);
+    test_setup_ping(ipc);
+    sm = gbinder_servicemanager_new(dev);
+    test = TEST_SERVICEMANAGER(sm);
+    test->services = gutil_strv_add(test->services, "foo");
+
+    /* Invalid parameters */
+    g_assert(!gbinder_servicemanager_get_services(NULL, names,
+        test_get_services_func, loop));
+    g_assert(!gbinder_servicemanager_get_services(sm, NULL,
+        test_get_services_func, loop));
+    g_assert(!gbinder_servicemanager_get_services(sm, none,
+        test_get_services_func, loop));
+    g_assert(!gbinder_servicemanager_get_services(sm, names, NULL, NULL));
+
+    /* Each name is looked up by a separate job */
+    id = gbinder_servicemanager_get_services(sm, names,
+        test_get_services_func, loop);
+    g_assert(id);
+    test_run(&test_opt, loop);
+    g_assert_cmpint(test->get_count, == ,3);
+
+    /* With the cache, only the missing names are looked up */
+    gbinder_servicemanager_set_cache_enabled(sm, TRUE);
+    test->get_count = 0;
+    id = gbinder_servicemanager_get_services(sm, names,
+        test_get_services_func, loop);
+    g_assert(id);
+    test_run(&test_opt, loop);
+    g_assert_cmpint(test->get_count, == ,3);
+    id = gbinder_servicemanager_get_services(sm, names,
+        test_get_services_func, loop);
+    g_assert(id);
+    test_run(&test_opt, loop);
+    g_assert_cmpint(test->get_count, == ,4);
+    gbinder_servicemanager_get_cache_stats(sm, &stats);
+    g_assert_cmpuint(stats.hits, == ,2);
+    g_assert_cmpuint(stats.misses, == ,4);
+
+    /* Cancelled request doesn't complete (neither do its other jobs) */
+    gbinder_servicemanager_set_cache_enabled(sm, FALSE);
+    id = gbinder_servicemanager_get_services(sm, names,
+        test_get_services_not_reached, NULL);
+    g_assert(id);
+    gbinder_servicemanager_cancel(sm, id);
+    test_quit_later(loop);
+    test_run(&test_opt, loop);
+
+    gbinder_servicemanager_unref(sm);
+    gbinder_ipc_unref(ipc);
+    test_binder_exit_wait(&test_opt, loop);
+    test_config_cleanup(&config);
+    g_main_loop_unref(loop);
+}
+
+static
+void
+test_get_services()
+{
+    test_run_in_context(&test_opt, test_get_services_run);
+}
+
 /*==========================================================================*
  * Common
  *==========================================================================*/
@@ -1272,6 +1775,8 @@ test_add(
 
 int main(int argc, char* argv[])
 {
+    guint i;
+
     G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
     g_type_init();
     G_GNUC_END_IGNORE_DEPRECATIONS;
@@ -1281,10 +1786,18 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("basic"), test_basic);
     g_test_add_func(TEST_("legacy"), test_legacy);
     g_test_add_func(TEST_("config"), test_config);
+    for (i = 0; i < G_N_ELEMENTS(test_backoff_data); i++) {
+        const TestBackoffData* test = test_backoff_data + i;
+        char* path = g_strconcat(TEST_("backoff/"), test->name, NULL);
+
+        g_test_add_data_func(path, test, test_backoff);
+        g_free(path);
+    }
     g_test_add_func(TEST_("not_present"), test_not_present);
     g_test_add_func(TEST_("wait"), test_wait);
     g_test_add_func(TEST_("wait_long"), test_wait_long);
     g_test_add_func(TEST_("wait_async"), test_wait_async);
+    g_test_add_func(TEST_("wait_async_api"), test_wait_async_api);
     g_test_add_func(TEST_("death"), test_death);
     g_test_add_func(TEST_("reanimate"), test_reanimate);
     g_test_add_func(TEST_("reuse"), test_reuse);
@@ -1292,6 +1805,8 @@ int main(int argc, char* argv[])
     g_test_add_func(TEST_("list"), test_list);
     g_test_add_func(TEST_("get"), test_get);
     g_test_add_func(TEST_("add"), test_add);
+    g_test_add_func(TEST_("cache"), test_cache);
+    g_test_add_func(TEST_("get_services"), test_get_services);
     test_init(&test_opt, argc, argv);
     return g_test_run();
 }
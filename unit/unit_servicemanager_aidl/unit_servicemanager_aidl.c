@@ -449,6 +449,67 @@ test_list()
     test_run_in_context(&test_opt, test_list_run);
 }
 
+/*==========================================================================*
+ * list_many
+ *==========================================================================*/
+
+#define TEST_LIST_MANY_COUNT (300)
+
+static
+void
+test_list_many_run()
+{
+    const char* dev = GBINDER_DEFAULT_BINDER;
+    GBinderIpc* ipc = gbinder_ipc_new(dev, NULL);
+    ServiceManagerAidl* smsvc = servicemanager_aidl_new(dev);
+    GBinderLocalObject* obj = gbinder_local_object_new(ipc, NULL, NULL, NULL);
+    const int fd = gbinder_driver_fd(ipc->driver);
+    GMainLoop* loop = g_main_loop_new(NULL, FALSE);
+    GBinderServiceManager* sm;
+    char** list;
+    int i;
+
+    /* Set up binder simulator */
+    test_binder_register_object(fd, obj, AUTO_HANDLE);
+    sm = gbinder_servicemanager_new(dev);
+
+    /* Register the same object under many names */
+    for (i = 0; i < TEST_LIST_MANY_COUNT; i++) {
+        char* name = g_strdup_printf("name%d", i);
+
+        g_assert_cmpint(gbinder_servicemanager_add_service_sync(sm, name,
+            obj), == ,GBINDER_STATUS_OK);
+        g_free(name);
+    }
+
+    /* The list is fetched with one (reused) request */
+    list = gbinder_servicemanager_list_sync(sm);
+    g_assert_cmpuint(gutil_strv_length(list), == ,TEST_LIST_MANY_COUNT);
+    for (i = 0; i < TEST_LIST_MANY_COUNT; i++) {
+        char* name = g_strdup_printf("name%d", i);
+
+        g_assert(gutil_strv_contains(list, name));
+        g_free(name);
+    }
+    g_strfreev(list);
+
+    test_binder_unregister_objects(fd);
+    gbinder_local_object_unref(obj);
+    gbinder_local_object_unref(GBINDER_LOCAL_OBJECT(smsvc));
+    gbinder_servicemanager_unref(sm);
+    gbinder_ipc_unref(ipc);
+
+    test_binder_exit_wait(&test_opt, loop);
+    g_main_loop_unref(loop);
+}
+
+static
+void
+test_list_many()
+{
+    test_run_in_context(&test_opt, test_list_many_run);
+}
+
 /*==========================================================================*
  * notify
  *==========================================================================*/
@@ -596,6 +657,7 @@ int main(int argc, char* argv[])
     g_test_init(&argc, &argv, NULL);
     g_test_add_func(TEST_("get"), test_get);
     g_test_add_func(TEST_("list"), test_list);
+    g_test_add_func(TEST_("list_many"), test_list_many);
     g_test_add_func(TEST_("notify"), test_notify);
     g_test_add_func(TEST_("notify2"), test_notify2);
     test_init(&test_opt, argc, argv);
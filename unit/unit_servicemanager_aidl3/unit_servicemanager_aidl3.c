@@ -32,11 +32,14 @@
 
 #include "test_binder.h"
 
+#include "gbinder_client.h"
 #include "gbinder_driver.h"
 #include "gbinder_config.h"
 #include "gbinder_ipc.h"
+#include "gbinder_local_request.h"
 #include "gbinder_reader.h"
 #include "gbinder_servicemanager_p.h"
+#include "gbinder_servicepoll.h"
 #include "gbinder_local_object_p.h"
 #include "gbinder_local_reply.h"
 #include "gbinder_remote_request.h"
@@ -84,24 +87,157 @@ enum servicemanager_aidl_tx {
     GET_SERVICE_TRANSACTION = GBINDER_FIRST_CALL_TRANSACTION,
     CHECK_SERVICE_TRANSACTION,
     ADD_SERVICE_TRANSACTION,
-    LIST_SERVICES_TRANSACTION
+    LIST_SERVICES_TRANSACTION,
+    REGISTER_FOR_NOTIFICATIONS_TRANSACTION,
+    UNREGISTER_FOR_NOTIFICATIONS_TRANSACTION
 };
 
+static const char SVCMGR_CALLBACK_IFACE[] = "android.os.IServiceCallback";
+enum servicemanager_aidl_callback_tx {
+    ON_REGISTRATION_TRANSACTION = GBINDER_FIRST_CALL_TRANSACTION
+};
+
+#define EX_SECURITY (-1)
+
 const char* const servicemanager_aidl_ifaces[] = { SVCMGR_IFACE, NULL };
 
 typedef GBinderLocalObjectClass ServiceManagerAidl3Class;
 typedef struct service_manager_aidl3 {
     GBinderLocalObject parent;
     GHashTable* objects;
+    GPtrArray* watchers;
+    guint registrations;
+    gboolean reject_notifications;
     GMutex mutex;
 } ServiceManagerAidl3;
 
+typedef struct service_manager_aidl3_watcher {
+    char* name;
+    GBinderRemoteObject* object;
+    GBinderClient* client;
+} ServiceManagerAidl3Watcher;
+
 #define SERVICE_MANAGER_AIDL3_TYPE (service_manager_aidl3_get_type())
 #define SERVICE_MANAGER_AIDL3(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), \
         SERVICE_MANAGER_AIDL3_TYPE, ServiceManagerAidl3))
 G_DEFINE_TYPE(ServiceManagerAidl3, service_manager_aidl3, \
         GBINDER_TYPE_LOCAL_OBJECT)
 
+static
+void
+servicemanager_aidl3_watcher_free(
+    gpointer data)
+{
+    ServiceManagerAidl3Watcher* watcher = data;
+
+    gbinder_client_unref(watcher->client);
+    gbinder_remote_object_unref(watcher->object);
+    g_free(watcher->name);
+    g_free(watcher);
+}
+
+static
+void
+servicemanager_aidl3_notify(
+    ServiceManagerAidl3* self,
+    const char* name,
+    GBinderRemoteObject* obj)
+{
+    GPtrArray* watchers = self->watchers;
+    guint i;
+
+    for (i = 0; i < watchers->len; i++) {
+        ServiceManagerAidl3Watcher* watcher = watchers->pdata[i];
+
+        if (!g_strcmp0(watcher->name, name)) {
+            GBinderLocalRequest* req =
+                gbinder_client_new_request(watcher->client);
+            GBinderWriter writer;
+
+            gbinder_local_request_init_writer(req, &writer);
+            gbinder_writer_append_string16(&writer, name);
+            gbinder_writer_append_remote_object(&writer, obj);
+            gbinder_client_transact(watcher->client,
+                ON_REGISTRATION_TRANSACTION, GBINDER_TX_FLAG_ONEWAY, req,
+                NULL, NULL, NULL);
+            gbinder_local_request_unref(req);
+        }
+    }
+}
+
+static
+GBinderLocalReply*
+servicemanager_aidl3_register_for_notifications(
+    ServiceManagerAidl3* self,
+    GBinderRemoteRequest* req)
+{
+    GBinderLocalReply* reply =
+        gbinder_local_object_new_reply(&self->parent);
+    GBinderReader reader;
+    GBinderRemoteObject* callback;
+    char* name;
+
+    gbinder_remote_request_init_reader(req, &reader);
+    name = gbinder_reader_read_string16(&reader);
+    callback = gbinder_reader_read_object(&reader);
+    if (name && callback && !self->reject_notifications) {
+        ServiceManagerAidl3Watcher* watcher = g_new(ServiceManagerAidl3Watcher, 1);
+        GBinderRemoteObject* obj;
+
+        GDEBUG("Registering watcher for '%s'", name);
+        watcher->name = name;
+        watcher->object = callback;
+        watcher->client = gbinder_client_new(callback, SVCMGR_CALLBACK_IFACE);
+        g_ptr_array_add(self->watchers, watcher);
+        self->registrations++;
+
+        /* Notify the watcher if the service is already there */
+        obj = g_hash_table_lookup(self->objects, name);
+        if (obj) {
+            servicemanager_aidl3_notify(self, name, obj);
+        }
+        gbinder_local_reply_append_int32(reply, GBINDER_STATUS_OK);
+    } else {
+        GDEBUG("Rejecting watcher for '%s'", name);
+        gbinder_local_reply_append_int32(reply, EX_SECURITY);
+        gbinder_remote_object_unref(callback);
+        g_free(name);
+    }
+    return reply;
+}
+
+static
+GBinderLocalReply*
+servicemanager_aidl3_unregister_for_notifications(
+    ServiceManagerAidl3* self,
+    GBinderRemoteRequest* req)
+{
+    GBinderLocalReply* reply =
+        gbinder_local_object_new_reply(&self->parent);
+    GPtrArray* watchers = self->watchers;
+    GBinderReader reader;
+    GBinderRemoteObject* callback;
+    char* name;
+    guint i;
+
+    gbinder_remote_request_init_reader(req, &reader);
+    name = gbinder_reader_read_string16(&reader);
+    callback = gbinder_reader_read_object(&reader);
+    for (i = 0; i < watchers->len; i++) {
+        ServiceManagerAidl3Watcher* watcher = watchers->pdata[i];
+
+        if (watcher->object == callback && !g_strcmp0(watcher->name, name)) {
+            GDEBUG("Unregistering watcher for '%s'", name);
+            g_ptr_array_remove_index(watchers, i);
+            break;
+        }
+    }
+    gbinder_local_reply_append_int32(reply, GBINDER_STATUS_OK);
+    gbinder_remote_object_unref(callback);
+    g_free(name);
+    return reply;
+}
+
 static
 GBinderLocalReply*
 servicemanager_aidl3_handler(
@@ -153,6 +289,7 @@ servicemanager_aidl3_handler(
             gbinder_reader_read_uint32(&reader, &dumpsys_priority)) {
             GDEBUG("Adding '%s'", str);
             g_hash_table_replace(self->objects, str, remote_obj);
+            servicemanager_aidl3_notify(self, str, remote_obj);
             remote_obj = NULL;
             str = NULL;
             reply = gbinder_local_object_new_reply(obj);
@@ -183,6 +320,14 @@ servicemanager_aidl3_handler(
             }
         }
         break;
+    case REGISTER_FOR_NOTIFICATIONS_TRANSACTION:
+        reply = servicemanager_aidl3_register_for_notifications(self, req);
+        *status = GBINDER_STATUS_OK;
+        break;
+    case UNREGISTER_FOR_NOTIFICATIONS_TRANSACTION:
+        reply = servicemanager_aidl3_unregister_for_notifications(self, req);
+        *status = GBINDER_STATUS_OK;
+        break;
     default:
         GDEBUG("Unhandled command %u", code);
         break;
@@ -230,6 +375,7 @@ service_manager_aidl3_finalize(
     ServiceManagerAidl3* self = SERVICE_MANAGER_AIDL3(object);
 
     g_mutex_clear(&self->mutex);
+    g_ptr_array_free(self->watchers, TRUE);
     g_hash_table_destroy(self->objects);
     G_OBJECT_CLASS(service_manager_aidl3_parent_class)->finalize(object);
 }
@@ -242,6 +388,8 @@ service_manager_aidl3_init(
     g_mutex_init(&self->mutex);
     self->objects = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
         (GDestroyNotify) gbinder_remote_object_unref);
+    self->watchers = g_ptr_array_new_with_free_func
+        (servicemanager_aidl3_watcher_free);
 }
 
 static
@@ -459,6 +607,157 @@ test_list()
     test_run_in_context(&test_opt, test_list_run);
 }
 
+/*==========================================================================*
+ * notify
+ *==========================================================================*/
+
+typedef struct test_notify_wait {
+    TestContext* test;
+    guint registrations;
+} TestNotifyWait;
+
+static
+gboolean
+test_notify_wait_check(
+    gpointer user_data)
+{
+    TestNotifyWait* wait = user_data;
+    ServiceManagerAidl3* service = wait->test->service;
+    gboolean done;
+
+    /* Lock */
+    g_mutex_lock(&service->mutex);
+    done = service->registrations == wait->registrations &&
+        !service->watchers->len;
+    g_mutex_unlock(&service->mutex);
+    /* Unlock */
+
+    if (done) {
+        g_main_loop_quit(wait->test->loop);
+        return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+static
+void
+test_notify_wait_unregistered(
+    TestContext* test,
+    guint registrations)
+{
+    TestNotifyWait wait;
+
+    /* Wait until all registered callbacks get unregistered */
+    wait.test = test;
+    wait.registrations = registrations;
+    g_timeout_add(10, test_notify_wait_check, &wait);
+    test_run(&test_opt, test->loop);
+}
+
+static
+void
+test_notify_cb(
+    GBinderServiceManager* sm,
+    const char* name,
+    void* user_data)
+{
+    g_assert(name);
+    GDEBUG("'%s' is registered", name);
+    g_main_loop_quit(user_data);
+}
+
+static
+void
+test_notify_run()
+{
+    TestContext test;
+    const char* name = "name";
+    gulong id;
+
+    test_context_init(&test);
+
+    /* Start watching */
+    id = gbinder_servicemanager_add_registration_handler(test.client, name,
+        test_notify_cb, test.loop);
+    g_assert(id);
+
+    /* Register the object, test_notify_cb will stop the loop */
+    GDEBUG("Registering object '%s' => %p", name, test.object);
+    g_assert_cmpint(gbinder_servicemanager_add_service_sync(test.client,
+        name, test.object), == ,GBINDER_STATUS_OK);
+    test_run(&test_opt, test.loop);
+
+    /* The notification was pushed, not polled */
+    g_assert_cmpuint(test.service->watchers->len, == ,1);
+    gbinder_servicemanager_remove_handler(test.client, id);
+
+    /* Removing the handler unregisters the callback */
+    test_notify_wait_unregistered(&test, 1);
+
+    /* Watch a name which is already registered */
+    id = gbinder_servicemanager_add_registration_handler(test.client, name,
+        test_notify_cb, test.loop);
+    g_assert(id);
+    test_run(&test_opt, test.loop);
+    gbinder_servicemanager_remove_handler(test.client, id);
+    test_notify_wait_unregistered(&test, 2);
+
+    /* The handler is removed before the registration completes */
+    id = gbinder_servicemanager_add_registration_handler(test.client,
+        "other", test_notify_cb, test.loop);
+    g_assert(id);
+    gbinder_servicemanager_remove_handler(test.client, id);
+    test_notify_wait_unregistered(&test, 3);
+
+    test_context_deinit(&test);
+}
+
+static
+void
+test_notify()
+{
+    test_run_in_context(&test_opt, test_notify_run);
+}
+
+/*==========================================================================*
+ * notify_poll
+ *==========================================================================*/
+
+static
+void
+test_notify_poll_run()
+{
+    TestContext test;
+    const char* name = "name";
+    gulong id;
+
+    gbinder_servicepoll_interval_ms = 100;
+    test_context_init(&test);
+
+    /* Registration gets rejected, servicemanager falls back to polling */
+    test.service->reject_notifications = TRUE;
+    id = gbinder_servicemanager_add_registration_handler(test.client, name,
+        test_notify_cb, test.loop);
+    g_assert(id);
+
+    /* Register the object, test_notify_cb will stop the loop */
+    GDEBUG("Registering object '%s' => %p", name, test.object);
+    g_assert_cmpint(gbinder_servicemanager_add_service_sync(test.client,
+        name, test.object), == ,GBINDER_STATUS_OK);
+    test_run(&test_opt, test.loop);
+
+    g_assert_cmpuint(test.service->watchers->len, == ,0);
+    gbinder_servicemanager_remove_handler(test.client, id);
+    test_context_deinit(&test);
+}
+
+static
+void
+test_notify_poll()
+{
+    test_run_in_context(&test_opt, test_notify_poll_run);
+}
+
 /*==========================================================================*
  * Common
  *==========================================================================*/
@@ -473,6 +772,8 @@ int main(int argc, char* argv[])
     g_test_init(&argc, &argv, NULL);
     g_test_add_func(TEST_("get"), test_get);
     g_test_add_func(TEST_("list"), test_list);
+    g_test_add_func(TEST_("notify"), test_notify);
+    g_test_add_func(TEST_("notify_poll"), test_notify_poll);
     test_init(&test_opt, argc, argv);
     return g_test_run();
 }
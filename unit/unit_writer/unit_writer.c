@@ -43,6 +43,7 @@
 #include "gbinder_writer_p.h"
 #include "gbinder_ipc.h"
 #include "gbinder_io.h"
+#include "gbinder_object_registry.h"
 
 #include <gutil_intarray.h>
 #include <gutil_macros.h>
@@ -179,6 +180,9 @@ test_null(
     gbinder_writer_add_cleanup(NULL, NULL, 0);
     gbinder_writer_add_cleanup(NULL, g_free, 0);
     gbinder_writer_overwrite_int32(NULL, 0, 0);
+    gbinder_writer_overwrite_int64(NULL, 0, 0);
+    gbinder_writer_overwrite_fd(NULL, 0, 0);
+    gbinder_writer_overwrite_remote_object(NULL, 0, NULL);
 
 #if GBINDER_FMQ_SUPPORTED
     gbinder_writer_append_fmq_descriptor(NULL, NULL);
@@ -527,6 +531,23 @@ static const guint8 string16_tests_data_surrogates[] = {
     0x00, 0x00, 0x00, 0x00
 };
 
+static const guint8 string16_tests_data_long[] = {
+    TEST_INT32_BYTES(18),
+    TEST_INT16_BYTES('0'), TEST_INT16_BYTES('1'), TEST_INT16_BYTES('2'),
+    TEST_INT16_BYTES('3'), TEST_INT16_BYTES('4'), TEST_INT16_BYTES('5'),
+    TEST_INT16_BYTES('6'), TEST_INT16_BYTES('7'), TEST_INT16_BYTES('8'),
+    TEST_INT16_BYTES('9'), TEST_INT16_BYTES('a'), TEST_INT16_BYTES('b'),
+    TEST_INT16_BYTES('c'), TEST_INT16_BYTES('d'), TEST_INT16_BYTES('e'),
+    TEST_INT16_BYTES('f'), TEST_INT16_BYTES('g'), TEST_INT16_BYTES('h'),
+    0x00, 0x00, 0x00, 0x00
+};
+
+static const guint8 string16_tests_data_mixed[] = {
+    TEST_INT32_BYTES(3),
+    TEST_INT16_BYTES('x'), TEST_INT16_BYTES(0xe9), TEST_INT16_BYTES('y'),
+    0x00, 0x00
+};
+
 static const TestString16Data test_string16_tests[] = {
     { "null", NULL, TEST_ARRAY_AND_SIZE(string16_tests_data_null) },
     { "empty", "", TEST_ARRAY_AND_SIZE(string16_tests_data_empty) },
@@ -534,7 +555,13 @@ static const TestString16Data test_string16_tests[] = {
     { "2", "xy", TEST_ARRAY_AND_SIZE(string16_tests_data_xy) },
     { "surrogates", "\xF0\x9F\x98\x80" "\xF0\x9F\x98\x81"
       "\xF0\x9F\x98\x82" "\xF0\x9F\x98\x83",
-      TEST_ARRAY_AND_SIZE(string16_tests_data_surrogates) }
+      TEST_ARRAY_AND_SIZE(string16_tests_data_surrogates) },
+    { "long", "0123456789abcdefgh",
+      TEST_ARRAY_AND_SIZE(string16_tests_data_long) },
+    { "mixed", "x\xC3\xA9y", TEST_ARRAY_AND_SIZE(string16_tests_data_mixed) },
+    { "invalid", "xy\xFFz", TEST_ARRAY_AND_SIZE(string16_tests_data_xy) },
+    { "truncated", "xy\xE2\x82", TEST_ARRAY_AND_SIZE(string16_tests_data_xy) },
+    { "overlong", "\xC0\x80x", TEST_ARRAY_AND_SIZE(string16_tests_data_empty) }
 };
 
 static
@@ -1390,6 +1417,85 @@ test_remote_object(
     test_context_deinit(&test);
 }
 
+/*==========================================================================*
+ * overwrite
+ *==========================================================================*/
+
+static
+void
+test_overwrite_obj_freed(
+    gpointer data,
+    GObject* obj)
+{
+    *((gboolean*)data) = TRUE;
+}
+
+static
+void
+test_overwrite(
+    void)
+{
+    GBinderIpc* ipc = gbinder_ipc_new(GBINDER_DEFAULT_BINDER, NULL);
+    const GBinderIo* io = gbinder_ipc_io(ipc);
+    const GBinderRpcProtocol* protocol = gbinder_ipc_protocol(ipc);
+    GBinderObjectRegistry* reg = gbinder_ipc_object_registry(ipc);
+    GBinderRemoteObject* obj1 = gbinder_object_registry_get_remote(reg, 1,
+        TRUE);
+    GBinderRemoteObject* obj2 = gbinder_object_registry_get_remote(reg, 2,
+        TRUE);
+    GBinderLocalRequest* req = gbinder_local_request_new(io, protocol, NULL);
+    const gint64 value = G_GINT64_CONSTANT(0x123456789a);
+    gsize int64_offset, fd_offset, obj_offset;
+    GBinderOutputData* data;
+    GBinderWriter writer;
+    gboolean freed = FALSE;
+    guint32 handle = 0;
+    const guint8* ptr;
+    int fd = -1;
+
+    gbinder_local_request_init_writer(req, &writer);
+    int64_offset = gbinder_writer_bytes_written(&writer);
+    gbinder_writer_append_int64(&writer, 0);
+    fd_offset = gbinder_writer_bytes_written(&writer);
+    gbinder_writer_append_fd(&writer, STDIN_FILENO);
+    obj_offset = gbinder_writer_bytes_written(&writer);
+    gbinder_writer_append_remote_object(&writer, obj1);
+
+    /* Patch the values in place */
+    gbinder_writer_overwrite_int64(&writer, int64_offset, value);
+    gbinder_writer_overwrite_fd(&writer, fd_offset, STDOUT_FILENO);
+    gbinder_writer_overwrite_remote_object(&writer, obj_offset, obj2);
+
+    /* Slots of the wrong type (and out of range) are left alone */
+    gbinder_writer_overwrite_fd(&writer, obj_offset, STDERR_FILENO);
+    gbinder_writer_overwrite_fd(&writer, int64_offset, STDERR_FILENO);
+    gbinder_writer_overwrite_remote_object(&writer, fd_offset, obj1);
+    gbinder_writer_overwrite_remote_object(&writer, obj_offset, NULL);
+    gbinder_writer_overwrite_remote_object(&writer, 1000, obj1);
+    gbinder_writer_overwrite_int64(&writer,
+        gbinder_writer_bytes_written(&writer) - 4, 0);
+
+    data = gbinder_local_request_data(req);
+    ptr = data->bytes->data;
+    g_assert(!memcmp(ptr + int64_offset, &value, sizeof(value)));
+    g_assert(io->decode_fd_object(ptr + fd_offset, data->bytes->len -
+        fd_offset, &fd));
+    g_assert_cmpint(fd, == ,STDOUT_FILENO);
+    g_assert(io->decode_binder_handle(ptr + obj_offset, &handle, protocol));
+    g_assert_cmpuint(handle, == ,2);
+
+    /* The request keeps the replacement object alive */
+    g_object_weak_ref(G_OBJECT(obj2), test_overwrite_obj_freed, &freed);
+    gbinder_remote_object_unref(obj2);
+    g_assert(!freed);
+    g_object_weak_unref(G_OBJECT(obj2), test_overwrite_obj_freed, &freed);
+
+    gbinder_local_request_unref(req);
+    gbinder_remote_object_unref(obj1);
+    gbinder_ipc_unref(ipc);
+    test_binder_exit_wait(&test_opt, NULL);
+}
+
 /*==========================================================================*
  * byte_array
  *==========================================================================*/
@@ -1598,6 +1704,7 @@ int main(int argc, char* argv[])
     }
 
     g_test_add_func(TEST_("remote_object"), test_remote_object);
+    g_test_add_func(TEST_("overwrite"), test_overwrite);
     g_test_add_func(TEST_("byte_array"), test_byte_array);
     g_test_add_func(TEST_("bytes_written"), test_bytes_written);
 